@@ -1,20 +1,10 @@
 // account.cpp
-// Implementations for Account class
+// Implementations for BasicAccount class template
 // Author: Juan Arias
 //
 // The Account class is a client banking account. It has the first & last name
-// of the client, the account ID number and contains assets held in up
-// to the following ten funds:
-//	 0: Money Market
-//	 1: Prime Money Market
-//	 2: Long-Term Bond
-//	 3: Short-Term Bond
-//	 4: 500 Index Fund
-//	 5: Capital Value Fund
-//	 6: Growth Equity Fund
-//	 7: Growth Index Fund
-//	 8: Value Fund
-//	 9: Value Stock Index
+// of the client, the account ID number and contains assets held in the
+// funds of a fund catalog (see fundcatalog.h).
 //
 // The operations of an Account include:
 //	 -construct a new client account with ID number
@@ -22,147 +12,441 @@
 //	 -withdraw assets from a fund
 //	 -transfer assets between funds
 //	 -transfer assets to another Account
+//	 -accrue interest or charge fees on all funds at once
 //	 -display the history of all transactions for a single fund
 //	 -display the history of all account transactions
+//	 -display a page of history: the latest transactions, a slice by
+//	  position or a range of sequence numbers
+//
+// History is stored as compact typed events, one 24 byte record per
+// transaction with no copy of its text. The text of each transaction is
+// rendered only when history is displayed. Sequence numbers of a fund's
+// events are kept beside them, so a page is found without scanning. Older
+// events may move to a HistorySegment, where displaying reads them back.
+//
+// Output goes to std::cout unless another stream is given, so Accounts
+// worked on by different threads can write to their own streams. Lines end
+// with '\n', never std::endl, so buffered streams are not flushed per line.
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <iomanip>
+#include <utility>
 #include "account.h"
+#include "historysegment.h"
+#include "transactionparser.h"
+
+// Constants, defined here as they may be bound to references
+template <class Catalog>
+const long long BasicAccount<Catalog>::MAX_ID;
+template <class Catalog>
+const long long BasicAccount<Catalog>::MIN_ID;
+template <class Catalog>
+const int BasicAccount<Catalog>::BASIS_POINTS;
 
 // Static function
-// Returns name of Fund indexed by parameter fund 
-std::string Account::FundName(int fund) {
+// Returns name of Fund indexed by parameter fund, the last fund's
+// if not valid
+template <class Catalog>
+std::string_view BasicAccount<Catalog>::FundName(int fund) {
 
-	switch (fund) {
+	return Catalog::NAMES[ValidFund(fund) ? fund : MAX_FUNDS - 1];
+}
 
-	case MONEY_MARKET:
+// Static function
+// Returns true if parameter fund is a valid fund index, false otherwise
+template <class Catalog>
+bool BasicAccount<Catalog>::ValidFund(int fund) {
 
-		return "Money Market";
+	return (NONE < fund) && (fund < MAX_FUNDS);
+}
 
-	case PRIME_MONEY_MARKET:
+// Static function
+// Returns true if parameter rate is a valid rate of an accrual,
+// false otherwise
+// A fee of at most the whole balance can never leave a fund negative
+template <class Catalog>
+bool BasicAccount<Catalog>::ValidRate(int rate) {
 
-		return "Prime Money Market";
+	return -BASIS_POINTS <= rate && rate <= BASIS_POINTS;
+}
 
-	case LONG_TERM_BOND:
+// Static function
+// Returns parameter balance after accruing parameter rate, in basis
+// points, rounded down & kept within the range of an int
+// Rounding down, toward negative infinity, holds for fees too
+template <class Catalog>
+int BasicAccount<Catalog>::Accrued(int balance, int rate) {
 
-		return "Long-Term Bond";
+	long long change(static_cast<long long>(balance) * rate);
 
-	case SHORT_TERM_BOND:
+	long long accrued(change / BASIS_POINTS);
 
-		return "Short-Term Bond";
+	if (change % BASIS_POINTS < 0) {
 
-	case INDEX_FUND_500:
+		--accrued;
+	}
 
-		return "500 Index Fund";
+	accrued += balance;
 
-	case CAPITAL_VALUE_FUND:
+	return static_cast<int>(std::max<long long>(INT_MIN,
+										std::min<long long>(INT_MAX, accrued)));
+}
 
-		return "Capital Value Fund";
+// Constructs Account with CLIENT as parameter name & ID as paremter num,
+// keeping its storage in parameter resource & moving older history to
+// parameter segment, or keeping it all in memory if nullptr
+template <class Catalog>
+BasicAccount<Catalog>::BasicAccount(const std::string& name, long long num,
+									std::pmr::memory_resource* resource,
+									HistorySegment* segment)
+									:CLIENT(name.begin(), name.end(), resource),
+									ID(num),
+									funds(makeFunds(resource,
+										std::make_index_sequence<MAX_FUNDS>())),
+									accruals(resource), sequence(0),
+									listener(nullptr), listenerSlot(0),
+									segment(segment) {}
 
-	case GROWTH_EQUITY_FUND:
+// Destroys Account
+template <class Catalog>
+BasicAccount<Catalog>::~BasicAccount() {}
 
-		return "Growth Equity Fund";
+// Records parameter transaction for parameter fund
+template <class Catalog>
+void BasicAccount<Catalog>::RecordTransaction(const Transaction& transaction,
+											  int fund) {
 
-	case GROWTH_INDEX_FUND:
+	std::lock_guard<std::mutex> guard(lock);
 
-		return "Growth Index Fund";
+	recordEvent(transaction, fund, 0);
+}
 
-	case VALUE_FUND:
+// Records parameter line of a transaction file for parameter fund
+template <class Catalog>
+void BasicAccount<Catalog>::RecordTransaction(const std::string& transaction,
+											  int fund) {
 
-		return "Value Fund";
+	Transaction decoded;
 
-	default:
+	if (TransactionParser::Parse(transaction, decoded)) {
 
-		return "Value Stock Index";
+		std::lock_guard<std::mutex> guard(lock);
 
+		recordEvent(decoded, fund, 0);
 	}
 }
 
-// Static function
-// Returns true if parameter fund is a valid fund index, false otherwise
-bool Account::ValidFund(int fund) {
+// Records parameter transaction for parameter fund if failed
+template <class Catalog>
+void BasicAccount<Catalog>::RecordFailedTransaction(
+									const Transaction& transaction, int fund) {
 
-	return (NONE < fund) && (fund < MAX_FUNDS);
+	std::lock_guard<std::mutex> guard(lock);
+
+	recordEvent(transaction, fund, FAILED);
 }
 
-// Constructs Account with CLIENT as parameter name & ID as paremter num
-Account::Account(const std::string& name, int num) :CLIENT(name), ID(num) {}
+// Records parameter line of a transaction file for parameter fund if failed
+template <class Catalog>
+void BasicAccount<Catalog>::RecordFailedTransaction(
+									const std::string& transaction, int fund) {
 
-// Destroys Account
-Account::~Account() {}
+	Transaction decoded;
 
-// Records parameter transaction for parameter fund
-void Account::RecordTransaction(const std::string& transaction, int fund) {
+	if (TransactionParser::Parse(transaction, decoded)) {
 
-	if (ValidFund(fund)) {
+		std::lock_guard<std::mutex> guard(lock);
 
-		funds[fund].transactions.push_back(transaction);
+		recordEvent(decoded, fund, FAILED);
 	}
 }
 
-// Records parameter transaction for parameter fund if failed
-void Account::RecordFailedTransaction(const std::string& transaction,
-															int fund) {
-
-	std::string failedTransaction(transaction + " (Failed)");
-	RecordTransaction(failedTransaction, fund);
-}
-
 // Displays history of all transactions for parameter fund or
 // history of all transactions in Account if no fund specified
-void Account::DisplayHistory(int fund) const {
+// to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::DisplayHistory(int fund, std::ostream& out) const {
 
-	std::cout << "Transaction history for " + CLIENT + " ";
+	std::lock_guard<std::mutex> guard(lock);
+
+	out << "Transaction history for " << CLIENT << ' ';
 
 	if (ValidFund(fund)) {
 
-		displayFundHistory(fund);
+		displayFundHistory(fund, out);
 
 	} else {
 
-		std::cout << "by fund." << std::endl;
+		out << "by fund." << '\n';
 
-		displayAll();
+		displayAll(out);
 	}
 }
 
-// Displays balances of all funds in Account
-void Account::DisplayBalances() const {
+// Displays the last parameter count transactions of parameter fund, or of
+// each fund if no fund specified, to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::DisplayLatest(int fund, std::size_t count,
+										  std::ostream& out) const {
 
-	std::cout << CLIENT << " Account ID: " << ID << std::endl;
+	displayPages(fund, [count](const Reader& reader) {
 
-	for (int fund(MONEY_MARKET); fund < MAX_FUNDS; ++fund) {
-	
-		std::cout << "    " << fundInfo(fund) << std::endl;
+		std::size_t size(reader.Size());
+
+		return std::make_pair(size - std::min(size, count), size);
+
+	}, out);
+}
+
+// Displays at most parameter limit transactions of parameter fund, or of
+// each fund if no fund specified, after skipping the first parameter
+// offset, to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::DisplayPage(int fund, std::size_t offset,
+										std::size_t limit,
+										std::ostream& out) const {
+
+	displayPages(fund, [offset, limit](const Reader& reader) {
+
+		std::size_t size(reader.Size()),
+					begin(std::min(size, offset));
+
+		return std::make_pair(begin, begin + std::min(size - begin, limit));
+
+	}, out);
+}
+
+// Displays transactions of parameter fund, or of each fund if no fund
+// specified, with sequence numbers from parameter first through parameter
+// last, to parameter out
+// Sequence numbers of a history ascend, so both ends are binary searched
+// by index, which reads only the events probed of any moved to segment
+template <class Catalog>
+void BasicAccount<Catalog>::DisplayRange(int fund, long long first,
+										 long long last,
+										 std::ostream& out) const {
+
+	displayPages(fund, [first, last](const Reader& reader) {
+
+		// Index of first event from parameter low up to parameter high
+		// whose sequence number parameter before is false for
+		auto search = [&reader](std::size_t low, std::size_t high,
+								auto before) {
+
+			while (low < high) {
+
+				std::size_t middle(low + (high - low) / 2);
+
+				if (before(reader.Sequence(middle))) {
+
+					low = middle + 1;
+
+				} else {
+
+					high = middle;
+				}
+			}
+
+			return low;
+		};
+
+		std::size_t begin(search(0, reader.Size(),
+								 [first](std::uint32_t sequence) {
+
+									 return sequence < first;
+								 }));
+
+		std::size_t end(search(begin, reader.Size(),
+							   [last](std::uint32_t sequence) {
+
+								   return sequence <= last;
+							   }));
+
+		return std::make_pair(begin, end);
+	}, out);
+}
+
+// Returns number of transactions in history of parameter fund,
+// 0 if not valid
+template <class Catalog>
+std::size_t BasicAccount<Catalog>::HistorySize(int fund) const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return ValidFund(fund) ? historySize(funds[fund].history) : 0;
+}
+
+// Returns sequence number of last transaction recorded, 0 if none
+template <class Catalog>
+long long BasicAccount<Catalog>::LastSequence() const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return sequence;
+}
+
+// Displays balances of all funds in Account to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::DisplayBalances(std::ostream& out) const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	out << CLIENT << " Account ID: " << ID << '\n';
+
+	for (int fund(0); fund < MAX_FUNDS; ++fund) {
 	
+		out << "    ";
+
+		displayFundInfo(fund, out);
+
+		out << '\n';
 	}
 
-	std::cout << std::endl;
+	out << '\n';
 }
 
 // Deposits parameter assets into parameter fund,
 // returns true if successful, false otherwise
-bool Account::Deposit(int fund, int amount) {
+template <class Catalog>
+bool BasicAccount<Catalog>::Deposit(int fund, int amount, std::ostream& out) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return deposit(fund, amount, out);
+}
+
+// Withdrawals parameter assets from parameter fund,
+// returns true if successful, false otherwise
+template <class Catalog>
+bool BasicAccount<Catalog>::Withdraw(int fund, int amount, std::ostream& out) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return withdraw(fund, amount, out);
+}
+
+// Transfers parameter amount from parameter fund to parameter otherFund
+// of Account of parameter otherPtr,
+// returns true if successful, false otherwise
+// Both Accounts are locked, lower ID first, for the whole transfer
+template <class Catalog>
+bool BasicAccount<Catalog>::Transfer(BasicAccount* otherPtr, int fund,
+									 int otherFund, int amount,
+									 std::ostream& out) {
+
+	BasicAccount* firstPtr  = (otherPtr->ID < ID) ? otherPtr : this;
+	BasicAccount* secondPtr = (firstPtr == this) ? otherPtr : this;
+
+	std::lock_guard<std::mutex> firstGuard(firstPtr->lock);
+
+	std::unique_lock<std::mutex> secondGuard(secondPtr->lock,
+															std::defer_lock);
+
+	if (secondPtr != firstPtr) {
+
+		secondGuard.lock();
+	}
+
+	bool canTransfer(withdraw(fund, amount, out));
+
+	if (canTransfer) {
+		
+		otherPtr->deposit(otherFund, amount, out);
+		return true;
+	}
+
+	return false;
+}
+
+// Accrues parameter rates, one per fund in basis points, on all funds,
+// returns true if a balance changed
+template <class Catalog>
+bool BasicAccount<Catalog>::Accrue(const int* rates) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	int balances[MAX_FUNDS];
+
+	for (int fund(0); fund < MAX_FUNDS; ++fund) {
+
+		balances[fund] = Accrued(funds[fund].balance, rates[fund]);
+	}
+
+	return accrueTo(balances);
+}
+
+// Sets balances of all funds to parameter balances, accrued elsewhere
+// by the same rules as Accrue, returns true if a balance changed
+template <class Catalog>
+bool BasicAccount<Catalog>::AccrueTo(const int* balances) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return accrueTo(balances);
+}
+
+// Returns balance of parameter fund, 0 if not valid
+template <class Catalog>
+int BasicAccount<Catalog>::GetBalance(int fund) const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return ValidFund(fund) ? funds[fund].balance : 0;
+}
+
+// Sets parameter listener to hear of balance changes as parameter slot,
+// nullptr for none
+template <class Catalog>
+void BasicAccount<Catalog>::SetListener(BalanceListener* listener, int slot) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	this->listener = listener;
+
+	listenerSlot = slot;
+}
+
+// Returns name of client
+template <class Catalog>
+std::string BasicAccount<Catalog>::GetName() const {
+
+	return std::string(CLIENT.begin(), CLIENT.end());
+}
+
+// Returns the ID number of client
+template <class Catalog>
+long long BasicAccount<Catalog>::GetID() const {
+
+	return ID;
+}
+
+// Deposit without locking, for callers already holding lock
+template <class Catalog>
+bool BasicAccount<Catalog>::deposit(int fund, int amount, std::ostream& out) {
 
 	if (!ValidFund(fund) || amount <= NONE) {
 
-		std::cout << "DEPOSIT ERROR" << std::endl;
+		out << "DEPOSIT ERROR" << '\n';
 
 		return false;
 	}
 
 	funds[fund].balance += amount;
 
+	notify(fund);
+
 	return true;
 }
 
-// Withdrawals parameter assets from parameter fund,
-// returns true if successful, false otherwise
-bool Account::Withdraw(int fund, int amount) {
+// Withdraw without locking, for callers already holding lock
+template <class Catalog>
+bool BasicAccount<Catalog>::withdraw(int fund, int amount, std::ostream& out) {
 
 	if (!ValidFund(fund) || amount <= NONE) {
 
-		std::cout << "WITHDRAW ERROR" << std::endl;
+		out << "WITHDRAW ERROR" << '\n';
 
 		return false;
 	}
@@ -175,91 +459,380 @@ bool Account::Withdraw(int fund, int amount) {
 		
 		funds[fund].balance -= amount;
 
+		notify(fund);
+
 		wentThrough =  true;
 		
-	} else if (fund == MONEY_MARKET || fund == PRIME_MONEY_MARKET) {
+	} else if (Catalog::LINKED[fund] != NONE) {
 
-		int otherFund = (fund == MONEY_MARKET) ? PRIME_MONEY_MARKET:
-													   MONEY_MARKET;
-	
-		wentThrough = cover(fund, otherFund, amount, overdraft);
-	
-	} else if (fund == LONG_TERM_BOND || fund == SHORT_TERM_BOND) {
+		wentThrough = cover(fund, Catalog::LINKED[fund], amount, overdraft,
+							out);
+	}
+
+	return wentThrough;
+}
+
+// AccrueTo without locking, for callers already holding lock
+// Records one summary event for all funds changed
+template <class Catalog>
+bool BasicAccount<Catalog>::accrueTo(const int* balances) {
+
+	long long change(0);
+
+	int changed(0);
 
-		int otherFund = (fund == LONG_TERM_BOND) ? SHORT_TERM_BOND:
-													LONG_TERM_BOND;
+	for (int fund(0); fund < MAX_FUNDS; ++fund) {
 
-		wentThrough = cover(fund, otherFund, amount, overdraft);
+		if (balances[fund] == funds[fund].balance) {
+
+			continue;
+		}
+
+		change += balances[fund] - static_cast<long long>(funds[fund].balance);
+
+		++changed;
+
+		funds[fund].balance = balances[fund];
+
+		notify(fund);
 	}
 
-	return wentThrough;
+	if (changed == 0) {
+
+		return false;
+	}
+
+	Event event = {};
+
+	event.type   = ACCRUAL;
+	event.fund1  = static_cast<std::int8_t>(changed);
+	event.amount = static_cast<std::int32_t>(
+					std::max<long long>(INT_MIN, std::min<long long>(INT_MAX,
+																	change)));
+
+	++sequence;
+
+	addEvent(accruals, event);
+
+	return true;
 }
 
-// 
-bool Account::Transfer(Account* otherPtr, int fund, int otherFund, int amount){
+// Static function
+// Returns array of empty funds kept in parameter resource, one per index
+// of parameter indices
+// Funds are built in place, as an array member takes no constructor
+// arguments otherwise
+template <class Catalog>
+template <std::size_t... Indices>
+std::array<typename BasicAccount<Catalog>::Fund,
+		   BasicAccount<Catalog>::MAX_FUNDS>
+BasicAccount<Catalog>::makeFunds(std::pmr::memory_resource* resource,
+								 std::index_sequence<Indices...>) {
+
+	return {{ (static_cast<void>(Indices), Fund(resource))... }};
+}
 
-	bool canTransfer(Withdraw(fund, amount));
+// Tells listener, if any, balance of Fund indexed by parameter fund
+template <class Catalog>
+void BasicAccount<Catalog>::notify(int fund) {
 
-	if (canTransfer) {
-		
-		otherPtr->Deposit(otherFund, amount);
-		return true;
+	if (listener != nullptr) {
+
+		listener->BalanceChanged(listenerSlot, fund, funds[fund].balance);
 	}
+}
 
-	return false;
+// Helper method to display transaction of Fund indexed by parameter fund
+template <class Catalog>
+void BasicAccount<Catalog>::displayFundHistory(int fund,
+											   std::ostream& out) const {
+
+	displayFundInfo(fund, out);
+
+	out << '\n';
+
+	displayEvents(Reader(funds[fund].history, segment), out);
 }
 
-// Returns name of client
-std::string Account::GetName() const {
+// Static function
+// Displays text of parameter event to parameter out
+// A transaction is shown as the line of a transaction file it came from
+template <class Catalog>
+void BasicAccount<Catalog>::displayEvent(const Event& event,
+										 std::ostream& out) {
+
+	if (event.type == ACCRUAL) {
+
+		out << "Accrued " << event.amount << " in "
+			<< static_cast<int>(event.fund1) << " funds" << '\n';
+
+		return;
+	}
+
+	if (event.type == COVER) {
+
+		out << "Transfered " << event.amount
+				  << ((event.flags & COVER_FROM) ? " from " : " to ")
+				  << FundName(event.fund2) << '\n';
+
+		return;
+	}
+
+	out << event.type << ' ' << event.id1;
+
+	if (event.fund1 != NONE) {
 
-	return CLIENT;
+		out << static_cast<int>(event.fund1);
+	}
+
+	if (event.amount != NONE || (event.flags & TWO_ACCOUNTS)) {
+
+		out << ' ' << event.amount;
+	}
+
+	if (event.flags & TWO_ACCOUNTS) {
+
+		out << ' ' << event.id2;
+
+		if (event.fund2 != NONE) {
+
+			out << static_cast<int>(event.fund2);
+		}
+	}
+
+	if (event.flags & FAILED) {
+
+		out << " (Failed)";
+	}
+
+	out << '\n';
 }
 
-// Returns the ID number of client
-int Account::GetID() const {
+// Records parameter transaction with parameter flags for
+// Fund indexed by parameter fund
+template <class Catalog>
+void BasicAccount<Catalog>::recordEvent(const Transaction& transaction,
+										int fund, int flags) {
 
-	return ID;
+	if (!ValidFund(fund)) {
+
+		return;
+	}
+
+	Event event;
+
+	event.type   = transaction.type;
+	event.fund1  = static_cast<std::int8_t>(transaction.fund1);
+	event.fund2  = static_cast<std::int8_t>(transaction.fund2);
+	event.flags  = static_cast<std::uint8_t>(flags |
+							(transaction.twoAccounts ? TWO_ACCOUNTS : 0));
+	event.id1    = transaction.id1;
+	event.amount = transaction.amount;
+	event.id2    = transaction.id2;
+
+	++sequence;
+
+	addEvent(funds[fund].history, event);
 }
 
-// Helper method to display transaction of Fund indexed by parameter fund
-void Account::displayFundHistory(int fund) const {
+// Displays, for parameter fund or for each fund if no fund specified, the
+// events parameter select picks from its history to parameter out
+// Parameter select returns the index of the first event picked & of the
+// one after the last
+template <class Catalog>
+template <class Select>
+void BasicAccount<Catalog>::displayPages(int fund, Select select,
+										 std::ostream& out) const {
 
-	std::cout << fundInfo(fund) << std::endl;
+	std::lock_guard<std::mutex> guard(lock);
 
-	for (std::string transaction : funds[fund].transactions) {
-		
-		std::cout << "  " << transaction << std::endl;
-	
+	out << "Transaction history for " << CLIENT << ' ';
+
+	bool allFunds(!ValidFund(fund));
+
+	int first(fund), last(fund);
+
+	if (allFunds) {
+
+		out << "by fund." << '\n';
+
+		first = 0;
+		last  = MAX_FUNDS - 1;
+	}
+
+	for (int shown(first); shown <= last; ++shown) {
+
+		Reader reader(funds[shown].history, segment);
+
+		std::pair<std::size_t, std::size_t> page(select(reader));
+
+		displayFundInfo(shown, out);
+
+		displayPage(reader, page.first, page.second, out);
+	}
+
+	if (allFunds && historySize(accruals) > 0) {
+
+		Reader reader(accruals, segment);
+
+		std::pair<std::size_t, std::size_t> page(select(reader));
+
+		out << "Accruals";
+
+		displayPage(reader, page.first, page.second, out);
+	}
+}
+
+// Static function
+// Displays how many events parameter reader has are shown, then those
+// from index parameter begin up to parameter end, numbered, to
+// parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::displayPage(const Reader& reader,
+										std::size_t begin, std::size_t end,
+										std::ostream& out) {
+
+	out << ", " << (end - begin) << " of " << reader.Size() << '\n';
+
+	Event event;
+
+	std::uint32_t sequence;
+
+	for (std::size_t index(begin); index < end; ++index) {
+
+		if (reader.Get(index, event, sequence)) {
+
+			out << "  [" << sequence << "] ";
+
+			displayEvent(event, out);
+		}
+	}
+}
+
+// Static function
+// Displays each event parameter reader has, indented, to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::displayEvents(const Reader& reader,
+										  std::ostream& out) {
+
+	Event event;
+
+	std::uint32_t sequence;
+
+	for (std::size_t index(0); index < reader.Size(); ++index) {
+
+		if (reader.Get(index, event, sequence)) {
+
+			out << "  ";
+
+			displayEvent(event, out);
+		}
+	}
+}
+
+// Static function
+// Returns number of events of parameter history, including those moved
+// to segment
+template <class Catalog>
+std::size_t BasicAccount<Catalog>::historySize(const History& history) {
+
+	return history.spilled + history.events.size();
+}
+
+// Adds parameter event to parameter history with sequence number of
+// transaction being recorded
+// Spilling waits for twice the hot events, so each extent moves as many
+// events as stay & erasing them from the front is paid for once per event
+template <class Catalog>
+void BasicAccount<Catalog>::addEvent(History& history, const Event& event) {
+
+	history.events.push_back(event);
+	history.sequences.push_back(sequence);
+
+	if (segment != nullptr &&
+		history.events.size() >= 2 * segment->HotEvents()) {
+
+		spill(history);
 	}
 }
 
-// Returns fund name with balance
-std::string Account::fundInfo(int fund) const {
+// Moves all but the newest hot events of parameter history to segment
+// as one extent, keeping them in memory if it cannot be written
+template <class Catalog>
+void BasicAccount<Catalog>::spill(History& history) {
+
+	std::size_t count(history.events.size() - segment->HotEvents());
+
+	Extent extent = { history.lastExtent, static_cast<std::uint32_t>(count),
+					  0 };
+
+	std::string bytes;
+
+	bytes.reserve(sizeof(extent) +
+				  count * (sizeof(Event) + sizeof(std::uint32_t)));
+
+	bytes.append(reinterpret_cast<const char*>(&extent), sizeof(extent));
+	bytes.append(reinterpret_cast<const char*>(history.events.data()),
+				 count * sizeof(Event));
+	bytes.append(reinterpret_cast<const char*>(history.sequences.data()),
+				 count * sizeof(std::uint32_t));
+
+	std::uint64_t offset(segment->Append(bytes));
+
+	if (offset == HistorySegment::NONE) {
 
-	return FundName(fund) + ": $" + std::to_string(funds[fund].balance);
+		return;
+	}
+
+	history.lastExtent = offset;
+	history.spilled   += count;
+
+	history.events.erase(history.events.begin(),
+						 history.events.begin() + count);
+	history.sequences.erase(history.sequences.begin(),
+							history.sequences.begin() + count);
+}
+
+// Displays fund name with balance to parameter out
+template <class Catalog>
+void BasicAccount<Catalog>::displayFundInfo(int fund, std::ostream& out) const {
 
+	out << Catalog::NAMES[fund] << ": $" << funds[fund].balance;
 }
 
 // Helper method to display transactions of all Funds in Account
-void Account::displayAll() const {
+template <class Catalog>
+void BasicAccount<Catalog>::displayAll(std::ostream& out) const {
 
-	for (int fund(MONEY_MARKET); fund < MAX_FUNDS; ++fund) {
+	for (int fund(0); fund < MAX_FUNDS; ++fund) {
 	
-		displayFundHistory(fund);
+		displayFundHistory(fund, out);
+	}
+
+	if (historySize(accruals) > 0) {
+
+		out << "Accruals" << '\n';
+
+		displayEvents(Reader(accruals, segment), out);
 	}
 }
 
-// Covers overdraft Withdraws for linked Accounts,
-// returns true if successful, false otherwise
-bool Account::cover(int fund, int otherFund, int amount, int overdraft) {
+// Covers overdraft Withdraws for linked Accounts, printing errors to
+// parameter out, returns true if successful, false otherwise
+// Called with lock held, so moves money with the helpers that do not lock
+template <class Catalog>
+bool BasicAccount<Catalog>::cover(int fund, int otherFund, int amount,
+								  int overdraft, std::ostream& out) {
 
 	if (funds[otherFund].balance + overdraft > NONE) {
 
 		overdraft *= -1;
 
-		Transfer(this, otherFund, fund, overdraft);
+		withdraw(otherFund, overdraft, out);
 
-		Withdraw(fund, amount);
+		deposit(fund, overdraft, out);
+
+		withdraw(fund, amount, out);
 
 		recordCover(fund, otherFund, overdraft);
 
@@ -270,13 +843,153 @@ bool Account::cover(int fund, int otherFund, int amount, int overdraft) {
 }
 
 // Records cover transaction for linked Accounts
-void Account::recordCover(int fund, int otherFund, int overdraft){
+template <class Catalog>
+void BasicAccount<Catalog>::recordCover(int fund, int otherFund, int overdraft){
+
+	Event event = {};
+
+	event.type   = COVER;
+	event.amount = overdraft;
+
+	++sequence;
+
+	event.fund2 = static_cast<std::int8_t>(otherFund);
+	event.flags = COVER_FROM;
+
+	addEvent(funds[fund].history, event);
+
+	event.fund2 = static_cast<std::int8_t>(fund);
+	event.flags = 0;
+
+	addEvent(funds[otherFund].history, event);
+}
+
+// Constructs empty fund kept in parameter resource
+template <class Catalog>
+BasicAccount<Catalog>::Fund::Fund(std::pmr::memory_resource* resource)
+									:balance(NONE + 1), history(resource) {}
+
+// Constructs empty history kept in parameter resource
+template <class Catalog>
+BasicAccount<Catalog>::History::History(std::pmr::memory_resource* resource)
+									:events(resource), sequences(resource),
+									spilled(0),
+									lastExtent(HistorySegment::NONE) {}
+
+// Constructs Reader over parameter history, reading moved events from
+// parameter segment
+template <class Catalog>
+BasicAccount<Catalog>::Reader::Reader(const History& history,
+									  HistorySegment* segment)
+									:history(history), segment(segment) {}
+
+// Returns number of events of history
+template <class Catalog>
+std::size_t BasicAccount<Catalog>::Reader::Size() const {
+
+	return history.spilled + history.events.size();
+}
+
+// Fills parameter event & parameter sequence with event at parameter
+// index, returns true if successful, false otherwise
+// A moved event is read from its extent, the rest from memory
+template <class Catalog>
+bool BasicAccount<Catalog>::Reader::Get(std::size_t index, Event& event,
+										std::uint32_t& sequence) const {
+
+	if (index >= history.spilled) {
+
+		event    = history.events[index - history.spilled];
+		sequence = history.sequences[index - history.spilled];
+
+		return true;
+	}
+
+	std::size_t extent(extentOf(index));
+
+	if (extent == offsets.size()) {
+
+		return false;
+	}
+
+	std::size_t count(extent + 1 < starts.size() ? starts[extent + 1]
+												 : history.spilled);
+
+	count -= starts[extent];
+
+	std::uint64_t events(offsets[extent] + sizeof(Extent)),
+				  sequences(events + count * sizeof(Event));
+
+	index -= starts[extent];
+
+	return segment->Read(events + index * sizeof(Event), &event,
+						 sizeof(Event)) &&
+		   segment->Read(sequences + index * sizeof(std::uint32_t), &sequence,
+						 sizeof(std::uint32_t));
+}
+
+// Returns sequence number of event at parameter index, 0 if it could not
+// be read
+template <class Catalog>
+std::uint32_t BasicAccount<Catalog>::Reader::Sequence(std::size_t index)
+																	const {
+
+	if (index >= history.spilled) {
+
+		return history.sequences[index - history.spilled];
+	}
+
+	Event event;
+
+	std::uint32_t sequence(0);
+
+	return Get(index, event, sequence) ? sequence : 0;
+}
+
+// Returns index in offsets of extent holding moved event at parameter
+// index, finding extents if not yet found, size of offsets if none does
+// Extents link back from the last, so they are found newest first then
+// put in order
+template <class Catalog>
+std::size_t BasicAccount<Catalog>::Reader::extentOf(std::size_t index)
+																	const {
+
+	if (offsets.empty()) {
+
+		std::vector<std::uint32_t> counts;
+
+		Extent extent;
+
+		for (std::uint64_t offset(history.lastExtent);
+			 offset != HistorySegment::NONE &&
+			 segment->Read(offset, &extent, sizeof(extent));
+			 offset = extent.previous) {
+
+			offsets.push_back(offset);
+			counts.push_back(extent.count);
+		}
+
+		std::reverse(offsets.begin(), offsets.end());
+		std::reverse(counts.begin(), counts.end());
+
+		std::size_t start(history.spilled);
+
+		starts.resize(counts.size());
+
+		for (std::size_t pos(counts.size()); pos > 0; --pos) {
+
+			start -= counts[pos - 1];
+
+			starts[pos - 1] = start;
+		}
+	}
 
-	std::string transaction("Transfered " + std::to_string(overdraft));
+	std::size_t after(std::upper_bound(starts.begin(), starts.end(), index) -
+					  starts.begin());
 
-	RecordTransaction(transaction + " from " + FundName(otherFund), fund);
-	RecordTransaction(transaction + " to "   + FundName(fund), otherFund);
+	return (after > 0) ? after - 1 : offsets.size();
 }
 
-// Constructs empty fund
-Account::Fund::Fund() :balance(NONE + 1) {}
+// Builds BasicAccount for each catalog of fundcatalog.h
+template class BasicAccount<StandardFunds>;
+template class BasicAccount<CashFunds>;
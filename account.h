@@ -1,20 +1,13 @@
 // account.h
-// Specifications for Account class
+// Specifications for BasicAccount class template & Account type
 // Author: Juan Arias
 //
 // The Account class is a client banking account. It has the first & last name
-// of the client, the account ID number and contains assets held in up
-// to the following ten funds:
-//	 0: Money Market
-//	 1: Prime Money Market
-//	 2: Long-Term Bond
-//	 3: Short-Term Bond
-//	 4: 500 Index Fund
-//	 5: Capital Value Fund
-//	 6: Growth Equity Fund
-//	 7: Growth Index Fund
-//	 8: Value Fund
-//	 9: Value Stock Index
+// of the client, the account ID number and contains assets held in the
+// funds of a fund catalog (see fundcatalog.h). Account is BasicAccount over
+// StandardFunds, the ten funds of the bank. BasicAccount over another
+// catalog holds only that catalog's funds & covers overdrafts only between
+// the funds it links, both fixed at compile time.
 //
 // The operations of an Account include:
 //	 -construct a new client account with ID number
@@ -22,125 +15,444 @@
 //	 -withdraw assets from a fund
 //	 -transfer assets between funds
 //	 -transfer assets to another Account
+//	 -accrue interest or charge fees on all funds at once
 //	 -display the history of all transactions for a single fund
 //	 -display the history of all account transactions
+//	 -display a page of history: the latest transactions, a slice by
+//	  position or a range of sequence numbers
+//
+// An accrual changes each fund by its balance times a rate in basis points,
+// rounded down, so rounding never depends on the order of Accounts. It adds
+// one summary event to the history of the Account, not one per fund.
+//
+// History is stored as compact typed events, one 24 byte record per
+// transaction with no copy of its text. The text of each transaction is
+// rendered only when history is displayed. The name of the client, the
+// funds & their histories are kept in the memory resource given at
+// construction, such as an Arena (see arena.h), the heap by default.
+//
+// Each transaction recorded gets the next sequence number of its Account,
+// starting at 1, so a range of sequence numbers picks the same stretch of
+// time in every fund. Each fund keeps the sequence numbers of its events in
+// order beside them as an index, so a page of history costs time in its
+// size, plus a binary search for a range, however long the history is.
+//
+// Every operation locks the Account's own mutex, so threads may share
+// Accounts. Transfer between two Accounts locks the one with the lower ID
+// first, so two threads transferring in opposite directions cannot
+// deadlock. Covering a Withdraw from a linked fund happens under the same
+// lock as the Withdraw, so no thread sees it half done.
+//
+// An Account constructed with a HistorySegment (see historysegment.h)
+// keeps only the newest events of each history in memory.
+// Once a history holds twice the segment's hot events, the older half moves
+// to the segment as one extent, which points back to the extent before it.
+// A history in memory is then its newest events, the number moved & the
+// offset of the last extent, so its size stays bounded however long it
+// grows. Displaying history reads moved events back from the segment, its
+// output is the same either way.
+//
+// A BalanceListener can be set on an Account to hear of every change to
+// the balance of one of its funds, so balances can be mirrored elsewhere,
+// such as in a BalanceStore (see balancestore.h).
+//
+// Output goes to std::cout unless another stream is given, so Accounts
+// worked on by different threads can write to their own streams. Lines end
+// with '\n', never std::endl, so buffered streams are not flushed per line.
 
 #ifndef ACCOUNT_H
 #define ACCOUNT_H
 
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "fundcatalog.h"
+
+struct Transaction;
+class HistorySegment;
 
-class Account {
+class BalanceListener {
 
 public:
 
-	// MAX number of funds
-	static const int MAX_FUNDS = 10;
-
-	// MAX & MIN ID numbers
-	static const int MAX_ID = 9999;
-	static const int MIN_ID = 1000;
-
-	// Constants to represent fund numbers
-	enum FUNDNUM {
-
-		NONE              = -1,
-		MONEY_MARKET       = 0,
-		PRIME_MONEY_MARKET = 1,
-		LONG_TERM_BOND     = 2,
-		SHORT_TERM_BOND    = 3,
-		INDEX_FUND_500     = 4,
-		CAPITAL_VALUE_FUND = 5,
-		GROWTH_EQUITY_FUND = 6,
-		GROWTH_INDEX_FUND  = 7,
-		VALUE_FUND         = 8,
-		VALUE_STOCK_INDEX  = 9
-	};
+	// Destroys BalanceListener
+	virtual ~BalanceListener() {}
+
+	// Called with lock of Account held when balance of fund parameter fund
+	// of Account given parameter slot changes to parameter balance
+	virtual void BalanceChanged(int slot, int fund, int balance) = 0;
+
+};
 
-	// Returns name of Fund indexed by parameter fund 
-	static std::string FundName(int fund);
+// Fund numbers, MAX_FUNDS & NONE come from parameter Catalog
+template <class Catalog>
+class BasicAccount : public Catalog {
+
+public:
+
+	using Catalog::MAX_FUNDS;
+	using Catalog::NONE;
+
+	// MAX & MIN ID numbers, MAX_ID times ten plus a fund digit still fits
+	// in 64 bits
+	static const long long MAX_ID = 99999999999999999LL;
+	static const long long MIN_ID = 1000;
+
+	// Basis points in a whole, also the largest rate of an accrual
+	static const int BASIS_POINTS = 10000;
+
+	// Returns name of Fund indexed by parameter fund, the last fund's
+	// if not valid
+	static std::string_view FundName(int fund);
 
 	// Returns true if parameter fund is a valid fund index, false otherwise
 	static bool ValidFund(int fund);
 
-	// Constructs Account with CLIENT as parameter name & ID as paremter num
-	Account(const std::string& name, int num);
+	// Returns true if parameter rate is a valid rate of an accrual,
+	// false otherwise
+	static bool ValidRate(int rate);
+
+	// Returns parameter balance after accruing parameter rate, in basis
+	// points, rounded down & kept within the range of an int
+	static int Accrued(int balance, int rate);
+
+	// Constructs Account with CLIENT as parameter name & ID as paremter num,
+	// keeping its storage in parameter resource & moving older history to
+	// parameter segment, or keeping it all in memory if nullptr
+	BasicAccount(const std::string& name, long long num,
+				 std::pmr::memory_resource* resource =
+											std::pmr::get_default_resource(),
+				 HistorySegment* segment = nullptr);
 
 	// Destroys Account
-	virtual ~Account();
+	virtual ~BasicAccount();
 
 	// Records parameter transaction for Fund indexed by parameter fund
+	void RecordTransaction(const Transaction& transaction, int fund);
+
+	// Records parameter line of a transaction file for Fund indexed by
+	// parameter fund
 	void RecordTransaction(const std::string& transaction, int fund);
 
 	// Records failed parameter transaction for Fund indexed by parameter fund
+	void RecordFailedTransaction(const Transaction& transaction, int fund);
+
+	// Records failed parameter line of a transaction file for Fund indexed
+	// by parameter fund
 	void RecordFailedTransaction(const std::string& transaction, int fund);
 
 	// Displays history of all transactions for Fund indexed by parameter fund
 	// or history of all transactions in Account if no fund specified
-	void DisplayHistory(int fund = NONE) const;
+	// to parameter out
+	void DisplayHistory(int fund = NONE, std::ostream& out = std::cout) const;
+
+	// Displays the last parameter count transactions of Fund indexed by
+	// parameter fund, or of each fund if no fund specified, to parameter out
+	void DisplayLatest(int fund, std::size_t count,
+					   std::ostream& out = std::cout) const;
+
+	// Displays at most parameter limit transactions of Fund indexed by
+	// parameter fund, or of each fund if no fund specified, after skipping
+	// the first parameter offset, to parameter out
+	void DisplayPage(int fund, std::size_t offset, std::size_t limit,
+					 std::ostream& out = std::cout) const;
 
-	// Displays balances of all funds in Account
-	void DisplayBalances() const;
+	// Displays transactions of Fund indexed by parameter fund, or of each
+	// fund if no fund specified, with sequence numbers from parameter first
+	// through parameter last, to parameter out
+	void DisplayRange(int fund, long long first, long long last,
+					  std::ostream& out = std::cout) const;
+
+	// Returns number of transactions in history of Fund indexed by
+	// parameter fund, 0 if not valid
+	std::size_t HistorySize(int fund) const;
+
+	// Returns sequence number of last transaction recorded, 0 if none
+	long long LastSequence() const;
+
+	// Displays balances of all funds in Account to parameter out
+	void DisplayBalances(std::ostream& out = std::cout) const;
 
 	// Deposits parameter amount into Fund indexed by parameter fund,
 	// returns true if successful, false otherwise
-	bool Deposit(int fund, int amount);
+	// Errors are displayed to parameter out
+	bool Deposit(int fund, int amount, std::ostream& out = std::cout);
 
 	// Withdrawals parameter amount from Fund indexed by parameter fund,
 	// returns true if successful, false otherwise
-	bool Withdraw(int fund, int amount);
+	// Errors are displayed to parameter out
+	bool Withdraw(int fund, int amount, std::ostream& out = std::cout);
 
 	// Transfers parameter amount from Fund indexed by parameter fund
 	// to Fund indexed by parameter otherFund in the Account of parameter
 	// otherPtr, returns true if successful, false otherwise
-	bool Transfer(Account* otherPtr, int fund, int otherfund, int amount);
+	// Errors are displayed to parameter out
+	bool Transfer(BasicAccount* otherPtr, int fund, int otherfund, int amount,
+				  std::ostream& out = std::cout);
+
+	// Accrues parameter rates, one per fund in basis points, on all funds,
+	// returns true if a balance changed
+	bool Accrue(const int* rates);
+
+	// Sets balances of all funds to parameter balances, accrued elsewhere
+	// by the same rules as Accrue, returns true if a balance changed
+	bool AccrueTo(const int* balances);
+
+	// Returns balance of Fund indexed by parameter fund, 0 if not valid
+	int GetBalance(int fund) const;
+
+	// Sets parameter listener to hear of balance changes as parameter slot,
+	// nullptr for none
+	void SetListener(BalanceListener* listener, int slot);
 
 	// Returns name of client
 	std::string GetName() const;
 
 	// Returns the ID number of client
-	int GetID() const;
+	long long GetID() const;
 
 private:
 
+	// Constant for type of event recording a cover between linked funds
+	static const char COVER = 'C';
+
+	// Constant for type of event summarizing an accrual
+	static const char ACCRUAL = 'A';
+
+	// Flags of an event
+	enum EVENTFLAG {
+
+		FAILED       = 1,
+		TWO_ACCOUNTS = 2,
+		COVER_FROM   = 4
+	};
+
+	// Event in history of a fund, holds the fields of a transaction,
+	// for a COVER the amount & the linked fund, or for an ACCRUAL the
+	// net change & the number of funds changed
+	struct Event {
+
+		// Type of transaction or COVER
+		char type;
+
+		// Funds of first & second Account, or linked fund for a COVER
+		std::int8_t fund1;
+		std::int8_t fund2;
+
+		// Flags from EVENTFLAG
+		std::uint8_t flags;
+
+		// Amount of transaction
+		std::int32_t amount;
+
+		// ID numbers of first & second Account
+		std::int64_t id1;
+		std::int64_t id2;
+
+	};
+
+	// Events of a fund, or of accruals, with the sequence number of each
+	struct History {
+
+		// Constructs empty history kept in parameter resource
+		explicit History(std::pmr::memory_resource* resource);
+
+		// Events in order recorded
+		std::pmr::vector<Event> events;
+
+		// Sequence number of each event, ascending
+		std::pmr::vector<std::uint32_t> sequences;
+
+		// Number of oldest events moved to segment, before those in memory
+		std::size_t spilled;
+
+		// Offset of last extent moved to segment, HistorySegment::NONE
+		// if none
+		std::uint64_t lastExtent;
+
+	};
+
+	// Header of an extent of history in segment, followed by its events
+	// then their sequence numbers
+	struct Extent {
+
+		// Offset of extent moved before it, HistorySegment::NONE if first
+		std::uint64_t previous;
+
+		// Number of events
+		std::uint32_t count;
+
+		// Unused, zero
+		std::uint32_t reserved;
+
+	};
+
+	// Reads events of a history by index, whether in memory or moved to
+	// segment
+	class Reader {
+
+	public:
+
+		// Constructs Reader over parameter history, reading moved events
+		// from parameter segment
+		Reader(const History& history, HistorySegment* segment);
+
+		// Returns number of events of history
+		std::size_t Size() const;
+
+		// Fills parameter event & parameter sequence with event at
+		// parameter index, returns true if successful, false otherwise
+		bool Get(std::size_t index, Event& event,
+				 std::uint32_t& sequence) const;
+
+		// Returns sequence number of event at parameter index, 0 if it
+		// could not be read
+		std::uint32_t Sequence(std::size_t index) const;
+
+	private:
+
+		// History read
+		const History& history;
+
+		// Segment moved events are read from
+		HistorySegment* segment;
+
+		// Offset of each extent of history, oldest first, found on first
+		// read of a moved event
+		mutable std::vector<std::uint64_t> offsets;
+
+		// Index of first event of each extent
+		mutable std::vector<std::size_t> starts;
+
+		// Returns index in offsets of extent holding moved event at
+		// parameter index, finding extents if not yet found, size of
+		// offsets if none does
+		std::size_t extentOf(std::size_t index) const;
+
+	};
+
 	// Funds of Account
 	struct Fund {
 
-		// Constructs empty fund
-		Fund();
+		// Constructs empty fund kept in parameter resource
+		explicit Fund(std::pmr::memory_resource* resource);
 
 		// Balance of fund
 		int balance;
 
 		// History of transactions
-		std::vector<std::string> transactions;
+		History history;
 
 	};
 
 	// Name of client
-	const std::string CLIENT;
+	const std::pmr::string CLIENT;
 
 	// Account ID number
-	const int ID;
+	const long long ID;
+
+	// Array for balances of all funds of Account
+	std::array<Fund, MAX_FUNDS> funds;
+
+	// Summary events of accruals on Account
+	History accruals;
+
+	// Sequence number of last transaction recorded
+	std::uint32_t sequence;
+
+	// Guards funds, held by every public operation
+	mutable std::mutex lock;
+
+	// Listener to balance changes, nullptr if none
+	BalanceListener* listener;
+
+	// Slot given to listener
+	int listenerSlot;
+
+	// Segment older history moves to, nullptr if kept in memory
+	HistorySegment* segment;
+
+	// Returns array of empty funds kept in parameter resource, one per
+	// index of parameter indices
+	template <std::size_t... Indices>
+	static std::array<Fund, MAX_FUNDS> makeFunds(
+								std::pmr::memory_resource* resource,
+								std::index_sequence<Indices...> indices);
+
+	// Tells listener, if any, balance of Fund indexed by parameter fund
+	void notify(int fund);
+
+	// Deposit without locking, for callers already holding lock
+	bool deposit(int fund, int amount, std::ostream& out);
+
+	// Withdraw without locking, for callers already holding lock
+	bool withdraw(int fund, int amount, std::ostream& out);
 
-	// Array for balances all ten funds of Account
-	Fund funds[MAX_FUNDS];
+	// AccrueTo without locking, for callers already holding lock
+	bool accrueTo(const int* balances);
 
 	// Helper method to display transaction of Fund indexed by parameter fund
-	void displayFundHistory(int fund) const;
+	void displayFundHistory(int fund, std::ostream& out) const;
 
-	// Returns fund name with balance
-	std::string fundInfo(int fund) const;
+	// Displays text of parameter event to parameter out
+	static void displayEvent(const Event& event, std::ostream& out);
+
+	// Displays, for Fund indexed by parameter fund or for each fund if
+	// no fund specified, the events parameter select picks from its
+	// history to parameter out
+	template <class Select>
+	void displayPages(int fund, Select select, std::ostream& out) const;
+
+	// Displays how many events parameter reader has are shown, then
+	// those from index parameter begin up to parameter end, numbered,
+	// to parameter out
+	static void displayPage(const Reader& reader, std::size_t begin,
+							std::size_t end, std::ostream& out);
+
+	// Displays each event parameter reader has, indented, to parameter out
+	static void displayEvents(const Reader& reader, std::ostream& out);
+
+	// Returns number of events of parameter history, including those moved
+	// to segment
+	static std::size_t historySize(const History& history);
+
+	// Adds parameter event to parameter history with sequence number of
+	// transaction being recorded
+	void addEvent(History& history, const Event& event);
+
+	// Moves all but the newest hot events of parameter history to segment
+	// as one extent, keeping them in memory if it cannot be written
+	void spill(History& history);
+
+	// Records parameter transaction with parameter flags for
+	// Fund indexed by parameter fund
+	void recordEvent(const Transaction& transaction, int fund, int flags);
+
+	// Displays fund name with balance to parameter out
+	void displayFundInfo(int fund, std::ostream& out) const;
 
 	// Helper method to display transactions of all Funds in Account
-	void displayAll() const;
+	void displayAll(std::ostream& out) const;
 
-	// Covers overdraft Withdraws for linked Accounts,
-	// returns true if successful, false otherwise
-	bool cover(int fund, int otherFund, int amount, int overdraft);
+	// Covers overdraft Withdraws for linked Accounts, printing errors to
+	// parameter out, returns true if successful, false otherwise
+	bool cover(int fund, int otherFund, int amount, int overdraft,
+			   std::ostream& out);
 
 	// Records cover transaction for linked Accounts
 	void recordCover(int fund, int otherFund, int overdraft);
 };
+
+// Account of the bank, with the ten standard funds
+typedef BasicAccount<StandardFunds> Account;
+
+// Members are defined in account.cpp & built there for each catalog
+extern template class BasicAccount<StandardFunds>;
+extern template class BasicAccount<CashFunds>;
 #endif
@@ -0,0 +1,135 @@
+// accounttable.cpp
+// Implementations for AccountTable class
+// Author: Juan Arias
+//
+// The AccountTable class is a direct-indexed table for objects of the Account
+// class. Every four digit ID number (Account::MIN_ID to Account::MIN_ID +
+// CAPACITY - 1) owns one slot of a contiguous array, so lookups take
+// constant time no matter the order Accounts were opened in. It has the same
+// interface as BSTree and can:
+//	-insert an Account
+//	-retrieve an Account
+//	-display info of all stored Accounts (in ID order)
+//	-clear all stored Accounts
+//	-release all stored Accounts to another owner
+//	-check if it is empty
+
+#include "accounttable.h"
+
+// Constructs empty AccountTable of Accounts living in parameter arena,
+// or on the heap if nullptr
+// Allocates one empty slot for every valid ID number
+AccountTable::AccountTable(Arena* arena) :slots(CAPACITY, nullptr), count(0),
+										  arena(arena), segment(nullptr) {}
+
+// Destroys AccountTable
+// Calls Empty to deallocate dynamic memory
+AccountTable::~AccountTable() {
+
+	Empty();
+}
+
+// Inserts Account object referenced by parameter acctPtr,
+// returns true if successful, false if ID is in use or out of range
+bool AccountTable::Insert(Account* acctPtr) {
+
+	long long ID(acctPtr->GetID());
+
+	if (!inRange(ID) || slots[ID - Account::MIN_ID] != nullptr) {
+
+		return false;
+	}
+
+	slots[ID - Account::MIN_ID] = acctPtr;
+
+	++count;
+
+	return true;
+}
+
+// Points parameter acctPtr to Account object with ID given as a parameter
+// returns true if found, otherwise will point to nullptr then return false
+bool AccountTable::Retrieve(const long long& ID, Account*& acctPtr) const {
+
+	acctPtr = inRange(ID) ? slots[ID - Account::MIN_ID] : nullptr;
+
+	return acctPtr != nullptr;
+}
+
+// Displays info of all stored Accounts to parameter out
+// Slots are visited in ID order, same as an inorder traversal of BSTree
+void AccountTable::Display(std::ostream& out) const {
+
+	for (Account* acctPtr : slots) {
+
+		if (acctPtr != nullptr) {
+
+			acctPtr->DisplayBalances(out);
+		}
+	}
+}
+
+// Clears all stored Accounts
+// Accounts in an Arena are freed with it, so are only forgotten
+void AccountTable::Empty() {
+
+	if (arena != nullptr) {
+
+		Release();
+
+		return;
+	}
+
+	for (Account*& acctPtr : slots) {
+
+		delete acctPtr;
+
+		acctPtr = nullptr;
+	}
+
+	count = 0;
+}
+
+// Forgets all stored Accounts without deleting them,
+// for when another owner has taken them
+void AccountTable::Release() {
+
+	for (Account*& acctPtr : slots) {
+
+		acctPtr = nullptr;
+	}
+
+	count = 0;
+}
+
+// Returns true if AccountTable is empty, false otherwise
+bool AccountTable::isEmpty() const {
+
+	return count == 0;
+}
+
+// Returns Arena Accounts live in, nullptr if heap
+Arena* AccountTable::GetArena() const {
+
+	return arena;
+}
+
+// Sets parameter segment as where Accounts opened in AccountTable from now
+// on move older history, nullptr to keep it all in memory
+// Accounts already opened keep the segment they were given
+void AccountTable::SetHistorySegment(HistorySegment* segment) {
+
+	this->segment = segment;
+}
+
+// Returns segment older history of new Accounts moves to, nullptr if none
+HistorySegment* AccountTable::GetHistorySegment() const {
+
+	return segment;
+}
+
+// Returns true if parameter ID has a slot in table, false otherwise
+bool AccountTable::inRange(long long ID) {
+
+	return Account::MIN_ID <= ID && ID < Account::MIN_ID + CAPACITY;
+}
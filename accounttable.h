@@ -0,0 +1,120 @@
+// accounttable.h
+// Specifications for AccountTable class
+// Author: Juan Arias
+//
+// The AccountTable class is a direct-indexed table for objects of the Account
+// class. Every four digit ID number (Account::MIN_ID to Account::MIN_ID +
+// CAPACITY - 1) owns one slot of a contiguous array, so lookups take
+// constant time no matter the order Accounts were opened in. Longer ID
+// numbers can not be inserted. It has the same interface as BSTree and can:
+//	-insert an Account
+//	-retrieve an Account
+//	-display info of all stored Accounts (in ID order)
+//	-visit the Accounts with ID numbers in a range, in ID order
+//	-clear all stored Accounts
+//	-release all stored Accounts to another owner
+//	-check if it is empty
+//
+// An AccountTable given an Arena (see arena.h) expects its Accounts to live
+// there & never deletes them: Empty only forgets them, leaving the owner of
+// the Arena to reset it.
+// A HistorySegment set on it (see historysegment.h) is given to Accounts
+// opened in it, as its Arena is.
+
+#ifndef ACCOUNTTABLE_H
+#define ACCOUNTTABLE_H
+
+#include <algorithm>
+#include <vector>
+#include "account.h"
+#include "arena.h"
+
+class AccountTable {
+
+public:
+
+	// Number of slots, one for every four digit ID number
+	static const int CAPACITY = 9000;
+
+	// Constructs empty AccountTable of Accounts living in parameter arena,
+	// or on the heap if nullptr
+	explicit AccountTable(Arena* arena = nullptr);
+
+	// Destroys AccountTable
+	virtual ~AccountTable();
+
+	// Inserts Account object referenced by parameter acctPtr,
+	// returns true if successful, false if ID is in use or out of range
+	bool Insert(Account* acctPtr);
+
+	// Points parameter acctPtr to Account object with ID given as a parameter
+	// returns true if found, otherwise will point to nullptr then return false
+	bool Retrieve(const long long& ID, Account*& acctPtr) const;
+
+	// Calls parameter visit with each stored Account with ID number from
+	// parameter first through parameter last, in ID order
+	template <class Visit>
+	void Scan(long long first, long long last, Visit visit) const;
+
+	// Displays info of all stored Accounts to parameter out
+	void Display(std::ostream& out = std::cout) const;
+
+	// Clears all stored Accounts
+	void Empty();
+
+	// Forgets all stored Accounts without deleting them,
+	// for when another owner has taken them
+	void Release();
+
+	// Returns true if AccountTable is empty, false otherwise
+	bool isEmpty() const;
+
+	// Returns Arena Accounts live in, nullptr if heap
+	Arena* GetArena() const;
+
+	// Sets parameter segment as where Accounts opened in AccountTable from now
+	// on move older history, nullptr to keep it all in memory
+	void SetHistorySegment(HistorySegment* segment);
+
+	// Returns segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* GetHistorySegment() const;
+
+private:
+
+	// Slots of table, slot i holds Account with ID MIN_ID + i or nullptr
+	std::vector<Account*> slots;
+
+	// Number of stored Accounts
+	int count;
+
+	// Arena Accounts live in, nullptr if heap
+	Arena* arena;
+
+	// Segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* segment;
+
+	// Returns true if parameter ID has a slot in table, false otherwise
+	static bool inRange(long long ID);
+
+};
+
+// Calls parameter visit with each stored Account with ID number from
+// parameter first through parameter last, in ID order
+// Only slots of IDs in the range are visited
+template <class Visit>
+void AccountTable::Scan(long long first, long long last, Visit visit) const {
+
+	first = std::max<long long>(first, Account::MIN_ID);
+	last  = std::min<long long>(last, Account::MIN_ID + CAPACITY - 1);
+
+	for (long long ID(first); ID <= last; ++ID) {
+
+		Account* acctPtr(slots[ID - Account::MIN_ID]);
+
+		if (acctPtr != nullptr) {
+
+			visit(acctPtr);
+		}
+	}
+}
+#endif
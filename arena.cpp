@@ -0,0 +1,109 @@
+// arena.cpp
+// Implementations for Arena class
+// Author: Juan Arias
+//
+// The Arena class hands out memory from large chunks by bumping a pointer
+// & gives it all back at once with Reset, keeping the chunks for reuse.
+
+#include <algorithm>
+#include <cstdint>
+#include "arena.h"
+
+// Constructs Arena holding no chunks
+Arena::Arena() :current(0), next(nullptr), end(nullptr), used(0) {}
+
+// Destroys Arena, freeing all chunks
+Arena::~Arena() {}
+
+// Gives back all memory handed out, keeping chunks for reuse
+// Only the position in the chunks is rewound, so it takes constant time
+void Arena::Reset() {
+
+	current = 0;
+	used    = 0;
+
+	next = chunks.empty() ? nullptr : chunks[0].memory.get();
+	end  = chunks.empty() ? nullptr : next + chunks[0].size;
+}
+
+// Returns bytes handed out since last Reset
+std::size_t Arena::Used() const {
+
+	return used;
+}
+
+// Returns bytes held in chunks
+std::size_t Arena::Reserved() const {
+
+	std::size_t reserved(0);
+
+	for (const Chunk& chunk : chunks) {
+
+		reserved += chunk.size;
+	}
+
+	return reserved;
+}
+
+// Returns parameter bytes aligned to parameter alignment
+// Alignment is a power of two, so rounding up is a mask
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+
+	std::uintptr_t start((reinterpret_cast<std::uintptr_t>(next) +
+						  alignment - 1) & ~(alignment - 1));
+
+	if (next == nullptr ||
+		start + bytes > reinterpret_cast<std::uintptr_t>(end)) {
+
+		nextChunk(bytes, alignment);
+
+		start = (reinterpret_cast<std::uintptr_t>(next) + alignment - 1) &
+				~(alignment - 1);
+	}
+
+	char* ptr(reinterpret_cast<char*>(start));
+
+	used += (ptr + bytes) - next;
+
+	next = ptr + bytes;
+
+	return ptr;
+}
+
+// Does nothing, memory comes back at Reset
+void Arena::do_deallocate(void*, std::size_t, std::size_t) {}
+
+// Returns true if parameter other is this Arena
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const
+																noexcept {
+
+	return this == &other;
+}
+
+// Moves on to first chunk after current one with room for parameter bytes
+// aligned to parameter alignment, making one if none has
+// A chunk skipped for being too small stays unused until Reset
+void Arena::nextChunk(std::size_t bytes, std::size_t alignment) {
+
+	std::size_t needed(bytes + alignment);
+
+	current = (next == nullptr) ? 0 : current + 1;
+
+	while (current < chunks.size() && chunks[current].size < needed) {
+
+		++current;
+	}
+
+	if (current == chunks.size()) {
+
+		std::size_t size(chunks.empty() ? CHUNK_SIZE
+										: chunks.back().size * 2);
+
+		size = std::max(size, needed);
+
+		chunks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+	}
+
+	next = chunks[current].memory.get();
+	end  = next + chunks[current].size;
+}
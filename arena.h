@@ -0,0 +1,109 @@
+// arena.h
+// Specifications for Arena class
+// Author: Juan Arias
+//
+// The Arena class hands out memory from large chunks by bumping a pointer,
+// so allocating costs a few instructions & never calls malloc once the
+// chunks are there. Nothing is freed on its own: Reset gives back everything
+// at once in constant time, however many objects were made, by starting
+// over at the first chunk. Chunks are kept, so a run after Reset reuses the
+// memory of the run before it & the heap does not fragment:
+//	-chunks start at CHUNK_SIZE bytes & each new one is twice the last
+//	-a request bigger than the chunk after the current one gets a chunk of
+//	 its own size
+//	-deallocating does nothing, memory comes back at Reset
+//
+// It is a std::pmr::memory_resource, so std::pmr containers, such as the
+// history of an Account, can keep their storage in it. Objects made in an
+// Arena are never destroyed one by one, so they must not own memory from
+// anywhere else. An Arena is used by one thread at a time.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+class Arena : public std::pmr::memory_resource {
+
+public:
+
+	// Bytes of first chunk
+	static const std::size_t CHUNK_SIZE = 1 << 16;
+
+	// Constructs Arena holding no chunks
+	Arena();
+
+	// Destroys Arena, freeing all chunks
+	virtual ~Arena();
+
+	// Constructs a T from parameter args in memory of Arena,
+	// returns pointer to it
+	template <class T, class... Args>
+	T* New(Args&&... args);
+
+	// Gives back all memory handed out, keeping chunks for reuse
+	void Reset();
+
+	// Returns bytes handed out since last Reset
+	std::size_t Used() const;
+
+	// Returns bytes held in chunks
+	std::size_t Reserved() const;
+
+private:
+
+	// Block of memory handed out piece by piece
+	struct Chunk {
+
+		std::unique_ptr<char[]> memory;
+		std::size_t size;
+
+	};
+
+	// Chunks in order made
+	std::vector<Chunk> chunks;
+
+	// Index of chunk being handed out, chunks.size() if none
+	std::size_t current;
+
+	// Next free byte & end of current chunk
+	char* next;
+	char* end;
+
+	// Bytes handed out since last Reset
+	std::size_t used;
+
+	// Returns parameter bytes aligned to parameter alignment
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+	// Does nothing, memory comes back at Reset
+	void do_deallocate(void* ptr, std::size_t bytes,
+					   std::size_t alignment) override;
+
+	// Returns true if parameter other is this Arena
+	bool do_is_equal(const std::pmr::memory_resource& other) const
+															noexcept override;
+
+	// Moves on to first chunk after current one with room for parameter
+	// bytes aligned to parameter alignment, making one if none has
+	void nextChunk(std::size_t bytes, std::size_t alignment);
+
+	// Disallow copying, objects made in an Arena point into it
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+};
+
+// Constructs a T from parameter args in memory of Arena,
+// returns pointer to it
+template <class T, class... Args>
+T* Arena::New(Args&&... args) {
+
+	return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+#endif
@@ -0,0 +1,215 @@
+// balanceranking.cpp
+// Implementations for BalanceRanking class
+// Author: Juan Arias
+//
+// The BalanceRanking class keeps the highest & lowest balances of one fund,
+// refilled from every slot only when a change may have reached them.
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include "balanceranking.h"
+
+// Constants, defined here as they may be bound to references
+const int BalanceRanking::DEPTH;
+const int BalanceRanking::GATHERED;
+
+// Constructs empty, stale BalanceRanking listing up to parameter depth
+// highest & lowest balances
+BalanceRanking::BalanceRanking(int depth) :depth(std::max(depth, 1)),
+											floor(INT64_MIN),
+											ceiling(INT64_MAX), stale(true) {}
+
+// Destroys BalanceRanking
+BalanceRanking::~BalanceRanking() {}
+
+// Hears that a slot moved from parameter before to parameter after,
+// marking ranking stale if either may be at the top or bottom
+// A slot at the floor or ceiling may be kept or not, as slots share
+// balances, so it marks the ranking stale too. Once stale, the flag is only
+// read, so changes on many threads do not write the same line.
+void BalanceRanking::Change(std::int64_t before, std::int64_t after) {
+
+	if (stale.load(std::memory_order_relaxed)) {
+
+		return;
+	}
+
+	if (std::max(before, after) >= floor || std::min(before, after) <= ceiling) {
+
+		stale = true;
+	}
+}
+
+// Marks ranking stale, as when slots are added or all change at once
+void BalanceRanking::Invalidate() {
+
+	stale = true;
+}
+
+// Returns true if ranking must be refilled before it is read
+bool BalanceRanking::Stale() const {
+
+	return stale;
+}
+
+// Starts a refill, forgetting the balances ranked
+// Floor & ceiling are opened wide before the ranking is marked fresh, so
+// any change heard from then until End marks it stale again
+void BalanceRanking::Begin() {
+
+	floor   = INT64_MIN;
+	ceiling = INT64_MAX;
+	stale   = false;
+
+	highest.clear();
+	lowest.clear();
+	above.clear();
+	below.clear();
+
+	highCut = Entry(INT64_MIN, INT_MIN);
+	lowCut  = Entry(INT64_MAX, INT_MAX);
+}
+
+// Ranks parameter count balances at parameter data, of slots from
+// parameter first on
+// Slots between the cuts are passed over with two comparisons
+void BalanceRanking::Gather(const std::int64_t* data, std::size_t count,
+							int first) {
+
+	std::size_t gathered(static_cast<std::size_t>(GATHERED) * depth);
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		Entry entry(data[index], first + static_cast<int>(index));
+
+		if (highCut < entry) {
+
+			above.push_back(entry);
+
+			if (above.size() >= gathered) {
+
+				pruneAbove();
+			}
+		}
+
+		if (entry < lowCut) {
+
+			below.push_back(entry);
+
+			if (below.size() >= gathered) {
+
+				pruneBelow();
+			}
+		}
+	}
+}
+
+// Finishes a refill, leaving ranking fresh unless a change was heard since
+// it began
+// A floor & ceiling are only kept once depth slots are ranked, as until
+// then every slot is at both ends
+void BalanceRanking::End() {
+
+	pruneAbove();
+	pruneBelow();
+
+	highest.assign(above.begin(), above.end());
+	lowest.assign(below.begin(), below.end());
+
+	std::sort(highest.begin(), highest.end(), std::greater<Entry>());
+	std::sort(lowest.begin(), lowest.end());
+
+	if (highest.size() == static_cast<std::size_t>(depth)) {
+
+		floor   = highest.back().first;
+		ceiling = lowest.back().first;
+	}
+}
+
+// Fills parameter entries with the parameter count highest balances,
+// at most depth, highest first
+void BalanceRanking::Top(std::size_t count,
+						 std::vector<Entry>& entries) const {
+
+	count = std::min(count, highest.size());
+
+	entries.assign(highest.begin(), highest.begin() + count);
+}
+
+// Fills parameter entries with the parameter count lowest balances,
+// at most depth, lowest first
+void BalanceRanking::Bottom(std::size_t count,
+							std::vector<Entry>& entries) const {
+
+	count = std::min(count, lowest.size());
+
+	entries.assign(lowest.begin(), lowest.begin() + count);
+}
+
+// Returns highest balance & its slot, at least one slot ranked
+BalanceRanking::Entry BalanceRanking::Highest() const {
+
+	return highest.front();
+}
+
+// Returns lowest balance & its slot, at least one slot ranked
+BalanceRanking::Entry BalanceRanking::Lowest() const {
+
+	return lowest.front();
+}
+
+// Returns number of highest & of lowest balances that can be listed
+int BalanceRanking::Depth() const {
+
+	return depth;
+}
+
+// Removes all slots, leaving ranking stale
+void BalanceRanking::Clear() {
+
+	highest.clear();
+	lowest.clear();
+
+	floor   = INT64_MIN;
+	ceiling = INT64_MAX;
+	stale   = true;
+}
+
+// Drops all but the highest depth slots above, moving highCut to the
+// lowest kept
+// Every slot not gathered is below highCut, so it is below all kept
+void BalanceRanking::pruneAbove() {
+
+	if (above.size() <= static_cast<std::size_t>(depth)) {
+
+		return;
+	}
+
+	auto kept(above.end() - depth);
+
+	std::nth_element(above.begin(), kept, above.end());
+
+	highCut = *kept;
+
+	above.erase(above.begin(), kept);
+}
+
+// Drops all but the lowest depth slots below, moving lowCut to the
+// highest kept
+// Every slot not gathered is above lowCut, so it is above all kept
+void BalanceRanking::pruneBelow() {
+
+	if (below.size() <= static_cast<std::size_t>(depth)) {
+
+		return;
+	}
+
+	auto last(below.begin() + (depth - 1));
+
+	std::nth_element(below.begin(), last, below.end());
+
+	lowCut = *last;
+
+	below.erase(last + 1, below.end());
+}
@@ -0,0 +1,141 @@
+// balanceranking.h
+// Specifications for BalanceRanking class
+// Author: Juan Arias
+//
+// The BalanceRanking class keeps the highest & lowest balances of one fund
+// across many slots, so the top & bottom of the bank can be read without
+// visiting every slot. It can:
+//	-refill itself from every slot's balance, page by page
+//	-hear that a slot moved between two balances, & tell if it must be
+//	 refilled before it is read again
+//	-list the highest balances, highest first, or the lowest, lowest first,
+//	 with their slots
+//
+// Only DEPTH slots at each end are kept, in two sorted vectors, so a fund
+// costs the same memory however many slots it has. Slots are ordered by
+// balance & slot, so no two are equal: among equal balances the lower slot
+// is lower. A refill keeps a floor, the lowest balance kept at the top, &
+// a ceiling, the highest kept at the bottom. A change between balances
+// both strictly between them can not reach either end, so it costs two
+// comparisons; any other only marks the ranking stale, for the next reader
+// to refill. Changes never refill, so one never costs more than O(1), & an
+// accrual, which changes every slot, only marks the ranking stale.
+//
+// A refill gathers slots beyond each cut in a vector & each time one fills,
+// keeps only the DEPTH best by partial sorting, moving the cut to the last
+// kept. It takes O(slots) time on average in any order of balances, even
+// rising ones.
+//
+// Changes may be heard on many threads at once & while a refill runs: the
+// stale flag, floor & ceiling are atomic, & a refill opens both wide before
+// it reads a slot, so a change to a slot already read marks it stale again.
+// Refills & reads must not overlap with each other.
+
+#ifndef BALANCERANKING_H
+#define BALANCERANKING_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class BalanceRanking {
+
+public:
+
+	// Balance & slot of a ranked slot
+	typedef std::pair<std::int64_t, int> Entry;
+
+	// Default number of highest & of lowest balances that can be listed
+	static const int DEPTH = 100;
+
+	// Constructs empty, stale BalanceRanking listing up to parameter depth
+	// highest & lowest balances
+	explicit BalanceRanking(int depth = DEPTH);
+
+	// Destroys BalanceRanking
+	virtual ~BalanceRanking();
+
+	// Hears that a slot moved from parameter before to parameter after,
+	// marking ranking stale if either may be at the top or bottom
+	void Change(std::int64_t before, std::int64_t after);
+
+	// Marks ranking stale, as when slots are added or all change at once
+	void Invalidate();
+
+	// Returns true if ranking must be refilled before it is read
+	bool Stale() const;
+
+	// Starts a refill, forgetting the balances ranked
+	void Begin();
+
+	// Ranks parameter count balances at parameter data, of slots from
+	// parameter first on
+	void Gather(const std::int64_t* data, std::size_t count, int first);
+
+	// Finishes a refill, leaving ranking fresh unless a change was heard
+	// since it began
+	void End();
+
+	// Fills parameter entries with the parameter count highest balances,
+	// at most depth, highest first
+	void Top(std::size_t count, std::vector<Entry>& entries) const;
+
+	// Fills parameter entries with the parameter count lowest balances,
+	// at most depth, lowest first
+	void Bottom(std::size_t count, std::vector<Entry>& entries) const;
+
+	// Returns highest balance & its slot, at least one slot ranked
+	Entry Highest() const;
+
+	// Returns lowest balance & its slot, at least one slot ranked
+	Entry Lowest() const;
+
+	// Returns number of highest & of lowest balances that can be listed
+	int Depth() const;
+
+	// Removes all slots, leaving ranking stale
+	void Clear();
+
+private:
+
+	// Times depth slots a refill gathers at either end before pruning them
+	static const int GATHERED = 8;
+
+	// Number of highest & of lowest balances that can be listed
+	const int depth;
+
+	// Highest slots, highest first, & lowest slots, lowest first
+	std::vector<Entry> highest;
+	std::vector<Entry> lowest;
+
+	// Slots gathered by a refill above its high cut & below its low cut,
+	// kept for the next
+	std::vector<Entry> above;
+	std::vector<Entry> below;
+
+	// Keys no slot gathered is below & above, while a refill runs
+	Entry highCut;
+	Entry lowCut;
+
+	// Balances a change must stay above & below to leave ranking fresh
+	std::atomic<std::int64_t> floor;
+	std::atomic<std::int64_t> ceiling;
+
+	// True if ranking must be refilled before it is read
+	std::atomic<bool> stale;
+
+	// Drops all but the highest depth slots above, moving highCut to the
+	// lowest kept
+	void pruneAbove();
+
+	// Drops all but the lowest depth slots below, moving lowCut to the
+	// highest kept
+	void pruneBelow();
+
+	// Disallow copying, rankings are kept per fund
+	BalanceRanking(const BalanceRanking&) = delete;
+	BalanceRanking& operator=(const BalanceRanking&) = delete;
+
+};
+#endif
@@ -0,0 +1,661 @@
+// balancestore.cpp
+// Implementations for BalanceStore class
+// Author: Juan Arias
+//
+// The BalanceStore class keeps the balances of many Accounts as one
+// contiguous array per fund & keeps each fund's totals & counts as they
+// change, ranking its highest & lowest balances when a report asks. Arrays
+// are paged, each page with a lock, & copied on write, so snapshots of them
+// are cheap to take & never change.
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <utility>
+#include "balancestore.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define BALANCESTORE_AVX2 1
+#endif
+
+// Constants, defined here as they may be bound to references
+const int BalanceStore::PAGE_SLOTS;
+
+// Constructs empty BalanceStore
+BalanceStore::BalanceStore() :count(0), accounts(0) {
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		totals[fund]  = 0;
+		holders[fund] = 0;
+	}
+}
+
+// Destroys BalanceStore
+BalanceStore::~BalanceStore() {}
+
+// Attaches Account referenced by parameter acctPtr, copying its
+// balances to a new slot, returns slot
+int BalanceStore::Attach(Account* acctPtr) {
+
+	int slot(Add());
+
+	owners[slot] = acctPtr;
+
+	Client& client((*clients.back())[slot % PAGE_SLOTS]);
+
+	client.id   = acctPtr->GetID();
+	client.name = acctPtr->GetName();
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		change(slot, fund, acctPtr->GetBalance(fund));
+	}
+
+	acctPtr->SetListener(this, slot);
+
+	++accounts;
+
+	return slot;
+}
+
+// Adds a slot with all balances 0, returns slot
+// Pages start zeroed & slots past the last are never written, so a new
+// slot in a page already made is 0 without writing it. A new 0 may be
+// among the lowest balances, so rankings are marked stale.
+int BalanceStore::Add() {
+
+	if (count % PAGE_SLOTS == 0) {
+
+		for (std::vector<std::shared_ptr<Page>>& fundPages : pages) {
+
+			fundPages.push_back(std::make_shared<Page>());
+		}
+
+		clients.push_back(std::make_shared<ClientPage>());
+
+		pageLocks.emplace_back();
+	}
+
+	for (BalanceRanking& ranking : rankings) {
+
+		ranking.Invalidate();
+	}
+
+	(*clients.back())[count % PAGE_SLOTS].id = Account::NONE;
+
+	owners.push_back(nullptr);
+
+	return count++;
+}
+
+// Sets balance of fund parameter fund in parameter slot to parameter
+// balance
+void BalanceStore::BalanceChanged(int slot, int fund, int balance) {
+
+	change(slot, fund, balance);
+}
+
+// Returns balance of fund parameter fund in parameter slot
+std::int64_t BalanceStore::Balance(int slot, int fund) const {
+
+	std::lock_guard<std::mutex> guard(pageLocks[slot / PAGE_SLOTS]);
+
+	return (*pages[fund][slot / PAGE_SLOTS])[slot % PAGE_SLOTS];
+}
+
+// Returns number of slots
+int BalanceStore::Size() const {
+
+	return count;
+}
+
+// Removes all slots, Accounts attached must be gone
+// Snapshots keep the pages they hold
+void BalanceStore::Clear() {
+
+	for (std::vector<std::shared_ptr<Page>>& fundPages : pages) {
+
+		fundPages.clear();
+	}
+
+	clients.clear();
+	owners.clear();
+	pageLocks.clear();
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		rankings[fund].Clear();
+
+		totals[fund]  = 0;
+		holders[fund] = 0;
+	}
+
+	count    = 0;
+	accounts = 0;
+}
+
+// Returns total of balances of fund parameter fund
+std::int64_t BalanceStore::Total(int fund) const {
+
+	return totals[fund];
+}
+
+// Returns number of Accounts attached
+int BalanceStore::Accounts() const {
+
+	return accounts;
+}
+
+// Returns number of slots with a balance above 0 of fund parameter fund
+long long BalanceStore::Holders(int fund) const {
+
+	return holders[fund];
+}
+
+// Returns Account attached to parameter slot, nullptr if none
+Account* BalanceStore::Owner(int slot) const {
+
+	return owners[slot];
+}
+
+// Returns number of balances of fund parameter fund below
+// parameter threshold
+long long BalanceStore::CountBelow(int fund, std::int64_t threshold) const {
+
+	long long below(0);
+
+	for (std::size_t page(0); page < pages[fund].size(); ++page) {
+
+		std::lock_guard<std::mutex> guard(pageLocks[page]);
+
+		const std::int64_t* data(pages[fund][page]->data());
+
+		below += useAvx2() ? countBelowAvx2(data, pageSlots(page), threshold)
+						   : countBelow(data, pageSlots(page), threshold);
+	}
+
+	return below;
+}
+
+// Returns smallest, largest & mean balance of fund parameter fund,
+// all 0 if there are no slots
+BalanceStore::Summary BalanceStore::Summarize(int fund) const {
+
+	Summary summary = {};
+
+	if (count == 0) {
+
+		return summary;
+	}
+
+	std::lock_guard<std::mutex> guard(reports);
+
+	refill(fund);
+
+	summary.min  = rankings[fund].Lowest().first;
+	summary.max  = rankings[fund].Highest().first;
+	summary.mean = static_cast<double>(totals[fund]) / count;
+
+	return summary;
+}
+
+// Fills parameter entries with the parameter count highest balances of
+// fund parameter fund & their slots, highest first
+void BalanceStore::Top(int fund, std::size_t count,
+					   std::vector<BalanceRanking::Entry>& entries) const {
+
+	std::lock_guard<std::mutex> guard(reports);
+
+	refill(fund);
+
+	rankings[fund].Top(count, entries);
+}
+
+// Fills parameter entries with the parameter count lowest balances of
+// fund parameter fund & their slots, lowest first
+void BalanceStore::Bottom(int fund, std::size_t count,
+						  std::vector<BalanceRanking::Entry>& entries) const {
+
+	std::lock_guard<std::mutex> guard(reports);
+
+	refill(fund);
+
+	rankings[fund].Bottom(count, entries);
+}
+
+// Accrues parameter rates, one per fund in basis points, on every slot
+// & sets attached Accounts to their new balances,
+// returns number of Accounts changed
+// Each page is totaled & counted before & after it is accrued, under its
+// lock, so the fund's aggregates move by the page's difference even while
+// other slots change. Accounts are set without holding a page's lock, as
+// they report their new balances back, which the store already holds.
+long long BalanceStore::Accrue(const int* rates) {
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		if (rates[fund] == 0) {
+
+			continue;
+		}
+
+		for (std::size_t page(0); page < pages[fund].size(); ++page) {
+
+			std::lock_guard<std::mutex> guard(pageLocks[page]);
+
+			std::int64_t* data(writable(fund, page));
+
+			std::size_t slots(pageSlots(page));
+
+			bool avx2(useAvx2());
+
+			std::int64_t before(avx2 ? totalAvx2(data, slots)
+									 : total(data, slots));
+
+			long long empty(avx2 ? countBelowAvx2(data, slots, 1)
+								 : countBelow(data, slots, 1));
+
+			if (avx2) {
+
+				accrueAvx2(data, slots, rates[fund]);
+
+			} else {
+
+				accrue(data, slots, rates[fund]);
+			}
+
+			std::int64_t after(avx2 ? totalAvx2(data, slots)
+									: total(data, slots));
+
+			long long emptied(avx2 ? countBelowAvx2(data, slots, 1)
+								   : countBelow(data, slots, 1));
+
+			totals[fund].fetch_add(after - before, std::memory_order_relaxed);
+			holders[fund].fetch_add(empty - emptied,
+									std::memory_order_relaxed);
+		}
+
+		rankings[fund].Invalidate();
+	}
+
+	long long changed(0);
+
+	int accrued[Account::MAX_FUNDS];
+
+	for (std::size_t slot(0); slot < owners.size(); ++slot) {
+
+		if (owners[slot] == nullptr) {
+
+			continue;
+		}
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			accrued[fund] = static_cast<int>(Balance(slot, fund));
+		}
+
+		changed += owners[slot]->AccrueTo(accrued) ? 1 : 0;
+	}
+
+	return changed;
+}
+
+// Returns snapshot of every slot as it is now, labeled with parameter
+// sequence
+// Each balance change is seen whole, but a transaction changing several
+// Accounts may be half done unless taken between transactions
+std::shared_ptr<const BalanceSnapshot> BalanceStore::Snapshot(
+												long long sequence) const {
+
+	return std::shared_ptr<const BalanceSnapshot>(
+								new BalanceSnapshot(*this, sequence));
+}
+
+// Sets balance of fund parameter fund in parameter slot to parameter
+// balance, updating the fund's aggregates
+// Only the page's lock is held, while the balance is written; the totals &
+// counts are atomic & the ranking only hears the change
+void BalanceStore::change(int slot, int fund, std::int64_t balance) {
+
+	std::int64_t before;
+
+	{
+		std::lock_guard<std::mutex> guard(pageLocks[slot / PAGE_SLOTS]);
+
+		std::int64_t& stored(
+						writable(fund, slot / PAGE_SLOTS)[slot % PAGE_SLOTS]);
+
+		before = stored;
+
+		if (balance == before) {
+
+			return;
+		}
+
+		stored = balance;
+	}
+
+	totals[fund].fetch_add(balance - before, std::memory_order_relaxed);
+	holders[fund].fetch_add((balance > 0) - (before > 0),
+							std::memory_order_relaxed);
+
+	rankings[fund].Change(before, balance);
+}
+
+// Refills ranking of fund parameter fund if stale
+// Each page is read under its lock, so changes may go on while it runs
+// Callers hold reports
+void BalanceStore::refill(int fund) const {
+
+	BalanceRanking& ranking(rankings[fund]);
+
+	if (!ranking.Stale()) {
+
+		return;
+	}
+
+	ranking.Begin();
+
+	for (std::size_t page(0); page < pages[fund].size(); ++page) {
+
+		std::lock_guard<std::mutex> guard(pageLocks[page]);
+
+		ranking.Gather(pages[fund][page]->data(), pageSlots(page),
+					   static_cast<int>(page * PAGE_SLOTS));
+	}
+
+	ranking.End();
+}
+
+// Returns balances of page parameter page of fund parameter fund for
+// writing, copying the page first if a snapshot holds it
+// Holders of a page are only added under its lock, which callers hold, so
+// a page held by one pointer stays unshared. The fence orders a snapshot's
+// last reads of the page, before it let go, ahead of the writes that follow.
+std::int64_t* BalanceStore::writable(int fund, std::size_t page) {
+
+	std::shared_ptr<Page>& pagePtr(pages[fund][page]);
+
+	if (pagePtr.use_count() > 1) {
+
+		pagePtr = std::make_shared<Page>(*pagePtr);
+
+	} else {
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+
+	return pagePtr->data();
+}
+
+// Returns number of slots used in page parameter page
+std::size_t BalanceStore::pageSlots(std::size_t page) const {
+
+	return std::min<std::size_t>(PAGE_SLOTS, count - page * PAGE_SLOTS);
+}
+
+// Static function
+// Returns true if reports may use AVX2, false otherwise
+// The processor is asked once
+bool BalanceStore::useAvx2() {
+
+#ifdef BALANCESTORE_AVX2
+	static const bool supported(__builtin_cpu_supports("avx2"));
+
+	return supported;
+#else
+	return false;
+#endif
+}
+
+// Static function
+// Returns total of parameter count balances at parameter data
+std::int64_t BalanceStore::total(const std::int64_t* data,
+								 std::size_t count) {
+
+	std::int64_t sum(0);
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		sum += data[index];
+	}
+
+	return sum;
+}
+
+// Static function
+// Returns number of parameter count balances at parameter data below
+// parameter threshold
+long long BalanceStore::countBelow(const std::int64_t* data,
+								   std::size_t count,
+								   std::int64_t threshold) {
+
+	long long below(0);
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		below += (data[index] < threshold) ? 1 : 0;
+	}
+
+	return below;
+}
+
+// Static function
+// Accrues parameter rate on parameter count balances at parameter data
+void BalanceStore::accrue(std::int64_t* data, std::size_t count, int rate) {
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		data[index] = Account::Accrued(static_cast<int>(data[index]), rate);
+	}
+}
+
+#ifdef BALANCESTORE_AVX2
+
+// Static function
+// AVX2 version of total, four balances at a time
+__attribute__((target("avx2")))
+std::int64_t BalanceStore::totalAvx2(const std::int64_t* data,
+									 std::size_t count) {
+
+	__m256i sums(_mm256_setzero_si256());
+
+	std::size_t index(0);
+
+	for (; index + 4 <= count; index += 4) {
+
+		sums = _mm256_add_epi64(sums, _mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(data + index)));
+	}
+
+	alignas(32) std::int64_t lanes[4];
+
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+		   total(data + index, count - index);
+}
+
+// Static function
+// AVX2 version of countBelow, four balances at a time
+// A lane that compares true is all ones, -1, so subtracting it counts it
+__attribute__((target("avx2")))
+long long BalanceStore::countBelowAvx2(const std::int64_t* data,
+									   std::size_t count,
+									   std::int64_t threshold) {
+
+	__m256i limit(_mm256_set1_epi64x(threshold)),
+			counts(_mm256_setzero_si256());
+
+	std::size_t index(0);
+
+	for (; index + 4 <= count; index += 4) {
+
+		__m256i values(_mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(data + index)));
+
+		counts = _mm256_sub_epi64(counts, _mm256_cmpgt_epi64(limit, values));
+	}
+
+	alignas(32) std::int64_t lanes[4];
+
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+		   countBelow(data + index, count - index, threshold);
+}
+
+// Static function
+// AVX2 version of accrue, four balances at a time
+// Balances fit an int, so each product with a rate is below 2 to the 53 &
+// exact as a double. Dividing by BASIS_POINTS then rounds to the nearest
+// double, which can not cross a whole number, so rounding down matches
+// Account::Accrued exactly.
+__attribute__((target("avx2")))
+void BalanceStore::accrueAvx2(std::int64_t* data, std::size_t count,
+							  int rate) {
+
+	const __m256i lows(_mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+
+	const __m256d scale(_mm256_set1_pd(rate)),
+				  whole(_mm256_set1_pd(Account::BASIS_POINTS)),
+				  largest(_mm256_set1_pd(INT_MAX)),
+				  smallest(_mm256_set1_pd(INT_MIN));
+
+	std::size_t index(0);
+
+	for (; index + 4 <= count; index += 4) {
+
+		__m256i values(_mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(data + index)));
+
+		__m256d balances(_mm256_cvtepi32_pd(_mm256_castsi256_si128(
+							_mm256_permutevar8x32_epi32(values, lows))));
+
+		__m256d accrued(_mm256_add_pd(balances, _mm256_floor_pd(
+						_mm256_div_pd(_mm256_mul_pd(balances, scale), whole))));
+
+		accrued = _mm256_max_pd(_mm256_min_pd(accrued, largest), smallest);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + index),
+							_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(accrued)));
+	}
+
+	accrue(data + index, count - index, rate);
+}
+
+#else
+
+// Static function
+// Without AVX2, same as total
+std::int64_t BalanceStore::totalAvx2(const std::int64_t* data,
+									 std::size_t count) {
+
+	return total(data, count);
+}
+
+// Static function
+// Without AVX2, same as countBelow
+long long BalanceStore::countBelowAvx2(const std::int64_t* data,
+									   std::size_t count,
+									   std::int64_t threshold) {
+
+	return countBelow(data, count, threshold);
+}
+
+// Static function
+// Without AVX2, same as accrue
+void BalanceStore::accrueAvx2(std::int64_t* data, std::size_t count,
+							  int rate) {
+
+	accrue(data, count, rate);
+}
+
+#endif
+
+// Constructs BalanceSnapshot of every slot of parameter store, labeled
+// with parameter sequence
+// Copies pointers to pages, not balances, so it takes time in the number
+// of pages. Each page's pointers are copied under its lock.
+BalanceSnapshot::BalanceSnapshot(const BalanceStore& store,
+								 long long sequence)
+								:clients(store.clients.begin(),
+										 store.clients.end()),
+								count(store.count), sequence(sequence) {
+
+	for (std::size_t page(0); page < store.clients.size(); ++page) {
+
+		std::lock_guard<std::mutex> guard(store.pageLocks[page]);
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			pages[fund].push_back(store.pages[fund][page]);
+		}
+	}
+}
+
+// Destroys BalanceSnapshot, letting go of its pages
+BalanceSnapshot::~BalanceSnapshot() {}
+
+// Returns sequence number snapshot was labeled with when taken
+long long BalanceSnapshot::Sequence() const {
+
+	return sequence;
+}
+
+// Returns number of slots
+int BalanceSnapshot::Size() const {
+
+	return count;
+}
+
+// Returns balance of fund parameter fund in parameter slot
+std::int64_t BalanceSnapshot::Balance(int slot, int fund) const {
+
+	return (*pages[fund][slot / BalanceStore::PAGE_SLOTS])
+										[slot % BalanceStore::PAGE_SLOTS];
+}
+
+// Displays balances of every attached Account in ID order to
+// parameter out
+// Lines are those of Account::DisplayBalances, so a report from a snapshot
+// reads the same as one from the Accounts
+void BalanceSnapshot::Display(std::ostream& out) const {
+
+	std::vector<std::pair<long long, int>> order;
+
+	for (int slot(0); slot < count; ++slot) {
+
+		long long id((*clients[slot / BalanceStore::PAGE_SLOTS])
+										[slot % BalanceStore::PAGE_SLOTS].id);
+
+		if (id != Account::NONE) {
+
+			order.emplace_back(id, slot);
+		}
+	}
+
+	std::sort(order.begin(), order.end());
+
+	for (const std::pair<long long, int>& entry : order) {
+
+		const BalanceStore::Client& client(
+							(*clients[entry.second / BalanceStore::PAGE_SLOTS])
+										[entry.second % BalanceStore::PAGE_SLOTS]);
+
+		out << client.name << " Account ID: " << client.id << '\n';
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			out << "    " << Account::FundName(fund) << ": $"
+				<< Balance(entry.second, fund) << '\n';
+		}
+
+		out << '\n';
+	}
+}
@@ -0,0 +1,297 @@
+// balancestore.h
+// Specifications for BalanceStore class
+// Author: Juan Arias
+//
+// The BalanceStore class keeps the balances of many Accounts as a structure
+// of arrays: one contiguous array of 64 bit balances per fund, indexed by
+// the slot each Account is given when it is attached. A bank-wide report on
+// one fund then reads only that fund's array, instead of visiting every
+// Account & its history. It can:
+//	-attach an Account, mirroring its balances from then on
+//	-add a slot not tied to any Account
+//	-total the balances of a fund
+//	-count attached Accounts & slots holding a fund
+//	-count balances of a fund below a threshold
+//	-find the smallest, largest & mean balance of a fund
+//	-list the highest & lowest balances of a fund with their slots
+//	-accrue interest or charge fees on every slot, one rate per fund
+//
+// Totals & counts of each fund are kept as each balance changes, so they
+// are read in O(1) without visiting the slots. A BalanceRanking per fund
+// keeps its highest & lowest balances, & a change that may reach either
+// end only marks it stale: the next report to read it refills it in one
+// pass over the fund's array, after which the smallest or largest balance
+// costs O(1) & a list of the highest or lowest O(count), up to DEPTH.
+// Counting below a threshold & refilling read the fund's array, with AVX2
+// when the processor has it, checked when the program runs, and a plain
+// loop otherwise. Both give the same results.
+//
+// An accrual runs over each fund's array in one pass, then sets each
+// attached Account to its new balances, adding one summary event to its
+// history. Balances always fit an int, as they come from Accounts, so the
+// AVX2 pass can multiply in doubles exactly. Each page's total & count are
+// taken before & after it is accrued, while it is still in cache, & the
+// fund's ranking is only marked stale, so nothing is ranked on the way.
+//
+// Attached Accounts report changes to their balances on the thread
+// changing them, under their own lock, so Accounts changed on several
+// threads report at once. No lock of the whole store is taken for a
+// change: each page of slots has a lock of its own, over that page of
+// every fund, held only while a balance in it is written or read, & the
+// totals & counts are atomic. Reports refilling or reading rankings hold
+// one more lock among themselves, which changes never take. An Account's
+// lock is always taken before a page's. Attaching & adding slots must not
+// overlap with anything else. A report read while balances change sees
+// each page as it was when read.
+//
+// Each fund's array is cut into pages of PAGE_SLOTS balances, held by
+// shared pointers, so Snapshot can copy the pointers rather than the
+// balances. A page still held by a snapshot is copied the first time a
+// balance in it changes after the snapshot (copy-on-write), so a snapshot
+// never changes & taking one holds each page's lock only to copy its
+// pointers. Reports run over each page in turn.
+//
+// A BalanceSnapshot is a read-only view of every slot as it was when the
+// snapshot was taken, with the ID number & name of each attached Account,
+// so it can be read on any thread while balances keep changing & outlives
+// the Accounts themselves. It can:
+//	-read the balance of a fund in a slot
+//	-display every attached Account's balances in ID order, the same as
+//	 Account::DisplayBalances
+
+#ifndef BALANCESTORE_H
+#define BALANCESTORE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "account.h"
+#include "balanceranking.h"
+
+class BalanceSnapshot;
+
+class BalanceStore : public BalanceListener {
+
+public:
+
+	// Slots of a page of balances
+	static const int PAGE_SLOTS = 1024;
+
+	// Smallest, largest & mean balance of a fund
+	struct Summary {
+
+		std::int64_t min;
+		std::int64_t max;
+		double       mean;
+
+	};
+
+	// Constructs empty BalanceStore
+	BalanceStore();
+
+	// Destroys BalanceStore
+	virtual ~BalanceStore();
+
+	// Attaches Account referenced by parameter acctPtr, copying its
+	// balances to a new slot, returns slot
+	int Attach(Account* acctPtr);
+
+	// Adds a slot with all balances 0, returns slot
+	int Add();
+
+	// Sets balance of fund parameter fund in parameter slot to parameter
+	// balance
+	void BalanceChanged(int slot, int fund, int balance) override;
+
+	// Returns balance of fund parameter fund in parameter slot
+	std::int64_t Balance(int slot, int fund) const;
+
+	// Returns number of slots
+	int Size() const;
+
+	// Removes all slots, Accounts attached must be gone
+	void Clear();
+
+	// Returns total of balances of fund parameter fund
+	std::int64_t Total(int fund) const;
+
+	// Returns number of Accounts attached
+	int Accounts() const;
+
+	// Returns number of slots with a balance above 0 of fund parameter fund
+	long long Holders(int fund) const;
+
+	// Returns Account attached to parameter slot, nullptr if none
+	Account* Owner(int slot) const;
+
+	// Returns number of balances of fund parameter fund below
+	// parameter threshold
+	long long CountBelow(int fund, std::int64_t threshold) const;
+
+	// Returns smallest, largest & mean balance of fund parameter fund,
+	// all 0 if there are no slots
+	Summary Summarize(int fund) const;
+
+	// Fills parameter entries with the parameter count highest balances of
+	// fund parameter fund & their slots, at most DEPTH, highest first
+	void Top(int fund, std::size_t count,
+			 std::vector<BalanceRanking::Entry>& entries) const;
+
+	// Fills parameter entries with the parameter count lowest balances of
+	// fund parameter fund & their slots, at most DEPTH, lowest first
+	void Bottom(int fund, std::size_t count,
+				std::vector<BalanceRanking::Entry>& entries) const;
+
+	// Accrues parameter rates, one per fund in basis points, on every slot
+	// & sets attached Accounts to their new balances,
+	// returns number of Accounts changed
+	long long Accrue(const int* rates);
+
+	// Returns snapshot of every slot as it is now, labeled with parameter
+	// sequence
+	std::shared_ptr<const BalanceSnapshot> Snapshot(long long sequence) const;
+
+private:
+
+	// Balances of PAGE_SLOTS slots of one fund
+	typedef std::array<std::int64_t, PAGE_SLOTS> Page;
+
+	// ID number & name of client of a slot, ID NONE if not attached
+	struct Client {
+
+		long long id;
+		std::string name;
+
+	};
+
+	// Clients of PAGE_SLOTS slots, set once when a slot is added
+	typedef std::array<Client, PAGE_SLOTS> ClientPage;
+
+	// Pages of balances of each fund, in slot order
+	std::vector<std::shared_ptr<Page>> pages[Account::MAX_FUNDS];
+
+	// Pages of clients, in slot order
+	std::vector<std::shared_ptr<ClientPage>> clients;
+
+	// Account attached to each slot, nullptr if none
+	std::vector<Account*> owners;
+
+	// Number of slots
+	int count;
+
+	// Number of Accounts attached
+	int accounts;
+
+	// Total of balances of each fund
+	std::atomic<std::int64_t> totals[Account::MAX_FUNDS];
+
+	// Number of slots with a balance above 0 of each fund
+	std::atomic<long long> holders[Account::MAX_FUNDS];
+
+	// Highest & lowest balances of each fund, refilled by reports
+	mutable BalanceRanking rankings[Account::MAX_FUNDS];
+
+	// Lock of each page, over that page of every fund
+	mutable std::deque<std::mutex> pageLocks;
+
+	// Held by reports refilling or reading rankings
+	mutable std::mutex reports;
+
+	// Sets balance of fund parameter fund in parameter slot to parameter
+	// balance, updating the fund's aggregates
+	void change(int slot, int fund, std::int64_t balance);
+
+	// Refills ranking of fund parameter fund if stale
+	void refill(int fund) const;
+
+	// Returns balances of page parameter page of fund parameter fund for
+	// writing, copying the page first if a snapshot holds it
+	std::int64_t* writable(int fund, std::size_t page);
+
+	// Returns number of slots used in page parameter page
+	std::size_t pageSlots(std::size_t page) const;
+
+	// Returns true if reports may use AVX2, false otherwise
+	static bool useAvx2();
+
+	// Returns total of parameter count balances at parameter data
+	static std::int64_t total(const std::int64_t* data, std::size_t count);
+
+	// Returns number of parameter count balances at parameter data below
+	// parameter threshold
+	static long long countBelow(const std::int64_t* data, std::size_t count,
+								std::int64_t threshold);
+
+	// Accrues parameter rate on parameter count balances at parameter data
+	static void accrue(std::int64_t* data, std::size_t count, int rate);
+
+	// AVX2 versions of total, countBelow & accrue
+	static std::int64_t totalAvx2(const std::int64_t* data,
+								  std::size_t count);
+	static long long countBelowAvx2(const std::int64_t* data,
+									std::size_t count,
+									std::int64_t threshold);
+	static void accrueAvx2(std::int64_t* data, std::size_t count, int rate);
+
+	friend class BalanceSnapshot;
+
+	// Disallow copying, attached Accounts point to this BalanceStore
+	BalanceStore(const BalanceStore&) = delete;
+	BalanceStore& operator=(const BalanceStore&) = delete;
+
+};
+
+class BalanceSnapshot {
+
+public:
+
+	// Destroys BalanceSnapshot, letting go of its pages
+	virtual ~BalanceSnapshot();
+
+	// Returns sequence number snapshot was labeled with when taken
+	long long Sequence() const;
+
+	// Returns number of slots
+	int Size() const;
+
+	// Returns balance of fund parameter fund in parameter slot
+	std::int64_t Balance(int slot, int fund) const;
+
+	// Displays balances of every attached Account in ID order to
+	// parameter out
+	void Display(std::ostream& out) const;
+
+private:
+
+	// Pages of balances of each fund, shared with BalanceStore until
+	// it writes them
+	std::vector<std::shared_ptr<const BalanceStore::Page>>
+												pages[Account::MAX_FUNDS];
+
+	// Pages of clients
+	std::vector<std::shared_ptr<const BalanceStore::ClientPage>> clients;
+
+	// Number of slots
+	int count;
+
+	// Sequence number snapshot was labeled with
+	long long sequence;
+
+	// Constructs BalanceSnapshot of every slot of parameter store, labeled
+	// with parameter sequence
+	BalanceSnapshot(const BalanceStore& store, long long sequence);
+
+	friend class BalanceStore;
+
+	// Disallow copying, snapshots are shared by pointer
+	BalanceSnapshot(const BalanceSnapshot&) = delete;
+	BalanceSnapshot& operator=(const BalanceSnapshot&) = delete;
+
+};
+#endif
@@ -5,30 +5,172 @@
 // The BankSimulation class simulates transactions in a bank. It takes
 // predetermined transactions from a textfile and then proccesses them.
 
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <thread>
+#include "bankstats.h"
 #include "banksimulation.h"
+#include "batchexecutor.h"
+#include "journal.h"
+#include "mappedfile.h"
+#include "outputsink.h"
+#include "shardedengine.h"
+
+// Constructs BankSimulation printing to parameter output, using one
+// thread per hardware core in modes that run on several threads
+BankSimulation::BankSimulation(std::ostream& output) :registry(&arena),
+							out(output),
+							threads(std::thread::hardware_concurrency()),
+							sequence(0), recovered(0), pipelineCounters(),
+							snapshotWanted(false), running(false),
+							snapshots(0) {
+
+	threads = (threads > 0) ? threads : 1;
+}
 
 // Destroys BankSimulation
 BankSimulation::~BankSimulation() {}
 
-// Starts simulation with parameter fileName
-void BankSimulation::Start(const std::string& fileName) {
+// Sets number of threads used by modes that run on several threads
+void BankSimulation::SetThreads(int count) {
+
+	threads = (count > 0) ? count : 1;
+}
+
+// Logs transactions that change Accounts to write-ahead log with
+// parameter fileName, committing parameter groupSize of them together
+// or after parameter groupMilliseconds, returns true if log was opened
+bool BankSimulation::SetLog(const std::string& fileName, int groupSize,
+							int groupMilliseconds) {
+
+	log.SetGroup(groupSize, groupMilliseconds);
+
+	return log.Open(fileName);
+}
+
+// Moves history of Accounts older than the newest parameter hotEvents
+// events of each fund to a segment file with parameter fileName,
+// returns true if it was created
+bool BankSimulation::SetHistorySpill(const std::string& fileName,
+									 std::size_t hotEvents) {
+
+	historySegment.reset(new HistorySegment(hotEvents));
+
+	if (!historySegment->Open(fileName)) {
+
+		historySegment.reset();
+
+		return false;
+	}
 
-	if (!tree.isEmpty()) {
+	return true;
+}
+
+// Starts simulation with parameter fileName, reading it as
+// indicated by parameter mode
+void BankSimulation::Start(const std::string& fileName, MODE mode) {
+
+	setRunning(true);
+
+	if (!registry.isEmpty()) {
 	
-		tree.Empty();
+		registry.Empty();
+	}
+
+	balances.Clear();
+
+	arena.Reset();
+
+	for (std::unique_ptr<Arena>& shardArena : shardArenas) {
+
+		shardArena->Reset();
+	}
+
+	dedup.Clear();
+
+	if (historySegment != nullptr) {
+
+		historySegment->Clear();
+	}
+
+	// Accounts of every mode are opened in registry, or in a shard given
+	// the same segment
+	registry.SetHistorySegment(historySegment.get());
+
+	sequence  = 0;
+	recovered = 0;
+
+	Stats::Reset();
+
+	if (log.IsOpen()) {
+
+		recover();
+
+		// Shards apply transactions out of file order, which a log
+		// recovered by sequence number cannot follow
+		mode = (mode == SHARDED) ? MAPPED : mode;
+	}
+
+	if (Journal::IsJournal(fileName)) {
+
+		replay(fileName);
+
+		return;
+	}
+
+	if (mode == MAPPED) {
+
+		mapped(fileName);
+
+		return;
+	}
+
+	if (mode == SHARDED) {
+
+		sharded(fileName);
+
+		return;
+	}
+
+	if (mode == BATCHED) {
+
+		batched(fileName);
+
+		return;
+	}
+
+	if (mode == PIPELINED) {
+
+		pipelined(fileName);
+
+		return;
+	}
+
+	if (mode == PARALLEL) {
+
+		parallel(fileName);
+
+		return;
 	}
 
 	std::ifstream inFile(fileName);
 
-	phase1(inFile);
+	if (mode == STREAMING) {
+
+		stream(inFile);
+
+	} else {
+
+		phase1(inFile);
+	}
 }
 
 // Runs phase1 of simulation,
 // parameter inFile indicating file with predetermined transactions
 void BankSimulation::phase1(std::ifstream& inFile) {
 
+	Stats::Timer timer;
+
 	std::queue<std::string> transactionQ;
 
 	std::string line;
@@ -40,6 +182,8 @@ void BankSimulation::phase1(std::ifstream& inFile) {
 
 	inFile.close();
 
+	Stats::RecordPhase(Stats::READ, timer.Lap());
+
 	phase2(transactionQ);
 }
 
@@ -47,134 +191,643 @@ void BankSimulation::phase1(std::ifstream& inFile) {
 // parameter q filled with transactions
 void BankSimulation::phase2(std::queue<std::string>& transactionQ) {
 
+	Stats::Timer timer;
+
 	while (!transactionQ.empty()) {
 
 		const std::string transaction(transactionQ.front());
 		
 		transactionQ.pop();
 
-		std::stringstream stream(transaction);
+		executeTransaction(transaction);
+	}
 
-		char type;
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
 
-		stream >> type;
+	phase3();
+}
 
-		analyzeTransaction(transaction, stream, type);
+// Runs phase3 of simulation
+// Measurements, if any, are printed to std::cerr so output is unchanged
+void BankSimulation::phase3() {
+
+	setRunning(false);
+
+	Stats::Timer timer;
+
+	out << "\nProcessing Done. Final Balances\n";
+
+	registry.Display(out);
+
+	log.Commit();
+
+	out.flush();
+
+	Stats::RecordPhase(Stats::DISPLAY, timer.Lap());
+
+	Stats::Report(std::cerr);
+}
+
+// Runs phase1 & phase2 of simulation together, processing each
+// transaction of parameter inFile as soon as it is read
+void BankSimulation::stream(std::ifstream& inFile) {
+
+	Stats::Timer timer;
+
+	std::string transaction;
+
+	while (getline(inFile, transaction)) {
+
+		executeTransaction(transaction);
 	}
 
+	inFile.close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
 	phase3();
 }
 
-// Runs phase3 of simulation
-void BankSimulation::phase3() {
+// Runs phase1 & phase2 of simulation together over file with
+// parameter fileName, decoding it in place from memory
+void BankSimulation::mapped(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	MappedFile inFile;
+
+	inFile.Open(fileName);
+
+	TransactionParser parser(inFile.Data());
+
+	Transaction transaction;
+
+	while (parser.Next(transaction)) {
+
+		apply(transaction);
+	}
+
+	inFile.Close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Runs phase1 & phase2 of simulation together over journal with
+// parameter fileName, decoding its records in place from memory
+void BankSimulation::replay(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	MappedFile inFile;
+
+	inFile.Open(fileName);
+
+	JournalReader reader(inFile.Data());
+
+	Transaction transaction;
+
+	while (reader.Valid() && reader.Next(transaction)) {
+
+		apply(transaction);
+	}
+
+	inFile.Close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Runs phase1 & phase2 of simulation together over file with
+// parameter fileName, executing it on a ShardedEngine
+void BankSimulation::sharded(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	MappedFile inFile;
+
+	inFile.Open(fileName);
+
+	TransactionParser parser(inFile.Data());
+
+	ShardedEngine engine(threads, &shardArenas, historySegment.get());
+
+	engine.Run(parser, out, dedup);
+
+	engine.MoveAccounts(registry);
+
+	registry.Scan(Account::MIN_ID, Account::MAX_ID, [this](Account* acctPtr) {
+
+		balances.Attach(acctPtr);
+	});
+
+	inFile.Close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Rebuilds Accounts from log
+// Output of recovered transactions was printed by the run that logged them
+void BankSimulation::recover() {
+
+	DiscardSink discard;
+
+	recovered = log.Recover([this, &discard](const Transaction& transaction) {
+
+		if (!duplicate(transaction) && execute(transaction, discard)) {
+
+			track(transaction);
+		}
+	});
+}
+
+// Runs phase1 & phase2 of simulation together over file with
+// parameter fileName, processing it in batches
+void BankSimulation::batched(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	MappedFile inFile;
+
+	inFile.Open(fileName);
+
+	TransactionParser parser(inFile.Data());
+
+	std::vector<Transaction> batch(BATCH_SIZE);
+
+	std::size_t count(0);
+
+	while (parser.Next(batch[count])) {
+
+		if (++count == BATCH_SIZE) {
+
+			ProcessBatch(batch.data(), count);
+
+			count = 0;
+		}
+	}
+
+	ProcessBatch(batch.data(), count);
+
+	inFile.Close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Runs phase1 & phase2 of simulation together over file with
+// parameter fileName, on a Pipeline
+void BankSimulation::pipelined(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	Pipeline pipeline(*this);
+
+	pipeline.Run(fileName);
+
+	pipelineCounters = pipeline.GetCounters();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Runs phase1 & phase2 of simulation together over file with
+// parameter fileName, decoding it on a ParallelParser
+// The thread running the simulation applies transactions, so one less
+// thread is left to decode
+void BankSimulation::parallel(const std::string& fileName) {
+
+	Stats::Timer timer;
+
+	MappedFile inFile;
+
+	inFile.Open(fileName);
+
+	ParallelParser parser(*this, std::max(threads - 1, 1));
+
+	parser.Run(inFile.Data());
+
+	inFile.Close();
+
+	Stats::RecordPhase(Stats::EXECUTE, timer.Lap());
+
+	phase3();
+}
+
+// Processes parameter count transactions starting at parameter
+// transactions with the same effects & output as one at a time in order
+// Transactions already recovered from log or applied already are
+// skipped, as in apply
+// Accruals change every Account, so the batch is split at each of them,
+// as well as at each transaction skipped
+void BankSimulation::ProcessBatch(const Transaction* transactions,
+								  std::size_t count) {
+
+	std::size_t begin(0);
+
+	if (recovered > sequence) {
+
+		begin = std::min<long long>(count, recovered - sequence);
+	}
+
+	for (std::size_t index(0); index < begin; ++index) {
+
+		remember(transactions[index]);
+	}
+
+	sequence += begin;
+
+	if (!batcher) {
+
+		batcher.reset(new BatchExecutor());
+	}
+
+	while (begin < count) {
 
-	std::cout << std::endl << "Processing Done. Final Balances" << std::endl;
+		std::size_t end(begin);
 
-	tree.Display();
+		while (end < count && transactions[end].type != Transaction::ACCRUAL &&
+			   !duplicate(transactions[end])) {
+
+			++end;
+		}
+
+		if (end > begin) {
+
+			batcher->Run(transactions + begin, end - begin, registry, out,
+						 batchChanged);
+
+			for (std::size_t index(0); index < batchChanged.size(); ++index) {
+
+				settle(transactions[begin + index], batchChanged[index]);
+			}
+
+			checkpoint();
+		}
+
+		if (end == count) {
+
+			break;
+		}
+
+		// Run stopped at an accrual, not checked yet, or at a duplicate
+		const Transaction& stop(transactions[end]);
+
+		settle(stop, stop.type == Transaction::ACCRUAL && !duplicate(stop) &&
+					 accrue(stop, out));
+
+		checkpoint();
+
+		begin = end + 1;
+	}
+}
+
+// Decodes parameter transaction then applies it
+void BankSimulation::executeTransaction(const std::string& transaction) {
+
+	Transaction decoded;
+
+	if (TransactionParser::Parse(transaction, decoded)) {
+
+		apply(decoded);
+	}
 }
 
-// Analyzes parameter transaction, classified by parameter type,
-// to get necessary data from parameter stream
-void BankSimulation::analyzeTransaction(const std::string& transaction,
-										      std::stringstream& stream,
-	                                                          char type) {
-	if (type == OPEN) {
+// Analyzes parameter transaction unless it was recovered from log or its
+// ID was applied already, logging it if it changed an Account
+void BankSimulation::apply(const Transaction& transaction) {
 
-		openAccount(stream);
+	if (sequence < recovered) {
+
+		++sequence;
+
+		remember(transaction);
 
 		return;
 	}
 
-	Account* acct1Ptr = nullptr, * acct2Ptr = nullptr;
+	settle(transaction, !duplicate(transaction) &&
+						execute(transaction, out));
 
-	int id1, amount(NONE), fund1(NONE), id2(NONE), fund2(NONE);
+	checkpoint();
+}
 
-	bool validAccounts(fillData(acct1Ptr, acct2Ptr, stream, amount,
-								id1, fund1, id2, fund2));
+// Returns true if parameter transaction has an ID applied already,
+// remembering its ID otherwise
+bool BankSimulation::duplicate(const Transaction& transaction) {
 
-	if (validAccounts) {
+	return transaction.txid != Transaction::NONE &&
+		   !dedup.Insert(transaction.txid);
+}
 
-		processTransaction(acct1Ptr, acct2Ptr, transaction, type, amount,
-						   fund1, fund2);
+// Remembers ID of parameter transaction, if any, without counting it as
+// a duplicate if it is remembered already
+// Transactions skipped after recovery may have had their ID remembered
+// when recovered
+void BankSimulation::remember(const Transaction& transaction) {
 
-	} else if (acct1Ptr == nullptr) {
-	
-		printAccountNotFound(id1);
+	if (transaction.txid != Transaction::NONE &&
+		!dedup.Contains(transaction.txid)) {
+
+		dedup.Insert(transaction.txid);
+	}
+}
+
+// Counts parameter transaction as read, tracking & logging it if
+// parameter changed
+void BankSimulation::settle(const Transaction& transaction, bool changed) {
+
+	++sequence;
+
+	if (!changed) {
+
+		return;
+	}
+
+	track(transaction);
+
+	if (log.IsOpen()) {
+
+		log.Append(sequence, transaction);
+	}
+}
+
+// Takes snapshot of balances if one is wanted, called between
+// transactions
+// Only a relaxed load is paid per transaction while no one waits
+void BankSimulation::checkpoint() {
+
+	if (!snapshotWanted.load(std::memory_order_relaxed)) {
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(snapshotLock);
+
+		snapshot = balances.Snapshot(sequence);
+
+		++snapshots;
+
+		snapshotWanted = false;
+	}
+
+	snapshotTaken.notify_all();
+}
+
+// Sets whether a run may change balances to parameter value
+// A caller of Snapshot waiting when a run stops takes its snapshot itself
+void BankSimulation::setRunning(bool value) {
+
+	{
+		std::lock_guard<std::mutex> guard(snapshotLock);
+
+		running = value;
+	}
+
+	snapshotTaken.notify_all();
+}
+
+// Executes parameter transaction, printing to parameter out,
+// returns true if an Account was changed
+bool BankSimulation::execute(const Transaction& transaction,
+							 std::ostream& out) {
+
+	if (transaction.type == Transaction::ACCRUAL) {
+
+		return accrue(transaction, out);
+	}
+
+	return analyzeTransaction(transaction, registry, out);
+}
+
+// Accrues rates of parameter transaction on all Accounts through
+// balances, printing to parameter out, returns true if an Account
+// was changed
+bool BankSimulation::accrue(const Transaction& transaction,
+							std::ostream& out) {
+
+	Stats::Timer timer;
+
+	int rates[Account::MAX_FUNDS];
+
+	bool changed(false);
+
+	if (accrualRates(transaction, rates)) {
+
+		changed = balances.Accrue(rates) > 0;
 
 	} else {
-	
-		printAccountNotFound(id2);
+
+		printAccrualError(out);
 	}
+
+	long long execution(timer.Lap());
+
+	Stats::RecordPart(Stats::EXECUTION, execution);
+	Stats::RecordTransaction(transaction.type, execution);
+
+	return changed;
 }
 
-// Fills all parameters with corresponding data from parameter stream
-bool BankSimulation::fillData(Account *& acct1Ptr, Account *& acct2Ptr,
-							  std::stringstream& stream, int& amount, int& id1,
-							  int& fund1, int& id2, int& fund2) const {
+// Attaches Account opened by parameter transaction, if any, to balances
+void BankSimulation::track(const Transaction& transaction) {
 
-	stream >> id1;
+	Account* acctPtr;
 
-	if (id1 > Account::MAX_ID) {
+	if (transaction.type == Transaction::OPEN &&
+		registry.Retrieve(transaction.id1, acctPtr)) {
 
-		fillIdFund(id1, fund1);
+		balances.Attach(acctPtr);
 	}
+}
 
-	bool validAccounts(tree.Retrieve(id1, acct1Ptr));
+// Returns balances of all Accounts, one array per fund
+const BalanceStore& BankSimulation::Balances() const {
 
-	if (!stream.eof()) {
+	return balances;
+}
 
-		stream >> amount;
+// Returns snapshot of balances of all Accounts between two transactions,
+// may be called on any thread
+// During a run the thread applying transactions takes it at its next
+// checkpoint, otherwise nothing changes balances & it is taken here
+std::shared_ptr<const BalanceSnapshot> BankSimulation::Snapshot() {
 
-		if (!stream.eof()) {
+	std::unique_lock<std::mutex> guard(snapshotLock);
 
-			stream >> id2;
+	long long before(snapshots);
 
-			fillIdFund(id2, fund2);
+	snapshotWanted = true;
 
-			validAccounts &= tree.Retrieve(id2, acct2Ptr);
-		}
+	snapshotTaken.wait(guard, [this, before]() {
+
+		return snapshots != before || !running;
+	});
+
+	if (snapshots != before) {
+
+		return snapshot;
 	}
 
-	return validAccounts;
+	snapshotWanted = false;
+
+	return balances.Snapshot(sequence);
+}
+
+// Remembers the last parameter window transaction IDs applied, to skip
+// transactions sent again
+void BankSimulation::SetDedupWindow(std::size_t window) {
+
+	dedup = DedupIndex(window);
+}
+
+// Returns number of transactions skipped in last run as their ID was
+// applied already
+long long BankSimulation::Duplicates() const {
+
+	return dedup.Duplicates();
+}
+
+// Returns measurements of stages of last PIPELINED run
+const Pipeline::Counters& BankSimulation::PipelineCounters() const {
+
+	return pipelineCounters;
+}
+
+// Static function
+// Analyzes parameter transaction, classified by its type, against
+// Accounts in parameter accounts, printing to parameter out,
+// returns true if an Account was changed
+bool BankSimulation::analyzeTransaction(const Transaction& transaction,
+										AccountRegistry& accounts,
+										std::ostream& out) {
+
+	Stats::Timer timer;
+
+	if (transaction.type == Transaction::OPEN) {
+
+		bool opened(openAccount(transaction, accounts, out));
+
+		long long execution(timer.Lap());
+
+		Stats::RecordPart(Stats::EXECUTION, execution);
+		Stats::RecordTransaction(transaction.type, execution);
+
+		return opened;
+	}
+
+	Account* acct1Ptr = nullptr, * acct2Ptr = nullptr;
+
+	bool validAccounts(fillData(acct1Ptr, acct2Ptr, transaction, accounts));
+
+	long long lookup(timer.Lap());
+
+	Stats::RecordPart(Stats::LOOKUP, lookup);
+
+	if (validAccounts) {
+
+		processTransaction(acct1Ptr, acct2Ptr, transaction, out);
+
+		long long execution(timer.Lap());
+
+		bool changed(changesAccounts(transaction));
+
+		Stats::RecordPart(changed ? Stats::EXECUTION : Stats::OUTPUT,
+																execution);
+		Stats::RecordTransaction(transaction.type, lookup + execution);
+
+		return changed;
+	}
+
+	if (acct1Ptr == nullptr) {
+	
+		printAccountNotFound(transaction.id1, out);
+
+	} else {
+	
+		printAccountNotFound(transaction.id2, out);
+	}
+
+	long long output(timer.Lap());
+
+	Stats::RecordPart(Stats::OUTPUT, output);
+	Stats::RecordTransaction(transaction.type, lookup + output);
+
+	return false;
 }
 
-// Fills id and fund with correct numbers to proceed with transaction
-void BankSimulation::fillIdFund(int& id, int& fund) const {
+// Static function
+// Points parameters acct1Ptr & acct2Ptr to Accounts named by
+// parameter transaction in parameter accounts,
+// returns true if all were found
+// A Transfer always needs a second Account, even if the line left it out
+bool BankSimulation::fillData(Account *& acct1Ptr, Account *& acct2Ptr,
+							  const Transaction& transaction,
+							  const AccountRegistry& accounts) {
+
+	bool validAccounts(accounts.Retrieve(transaction.id1, acct1Ptr));
+
+	if (transaction.twoAccounts ||
+		transaction.type == Transaction::TRANSFER) {
+
+		validAccounts &= accounts.Retrieve(transaction.id2, acct2Ptr);
+	}
+
+	return validAccounts;
+}
 
-	fund = id % Account::MAX_FUNDS;
-	id   = id / Account::MAX_FUNDS;
+// Static function
+// Returns true if processing parameter transaction on Accounts it names
+// changes them, false if it only prints
+// Every transaction records its attempt, even a failed Withdraw, but a
+// history of a whole Account, which has no fund to record it in
+bool BankSimulation::changesAccounts(const Transaction& transaction) {
 
+	return transaction.type != Transaction::HISTORY ||
+		   Account::ValidFund(transaction.fund1);
 }
 
-// Processes transaction with given data parameters
+// Static function
+// Processes parameter transaction on Accounts it names,
+// printing to parameter out
 void BankSimulation::processTransaction(Account* acct1Ptr, Account* acct2Ptr,
-										const std::string& transaction,
-										char type, int amount, int fund1,
-															   int fund2) {
+										const Transaction& transaction,
+										std::ostream& out) {
+
+	int amount(transaction.amount),
+		fund1(transaction.fund1),
+		fund2(transaction.fund2);
+
 	bool wentThrough(true);
 
-	switch (type) {
+	switch (transaction.type) {
 
-	case HISTORY:
+	case Transaction::HISTORY:
 
-		acct1Ptr->DisplayHistory(fund1);
+		displayHistory(acct1Ptr, transaction, out);
 		break;
 
-	case DEPOSIT:
+	case Transaction::DEPOSIT:
 
-		acct1Ptr->Deposit(fund1, amount);
+		acct1Ptr->Deposit(fund1, amount, out);
 		break;
 
-	case WITHDRAW:
+	case Transaction::WITHDRAW:
 
-		wentThrough = acct1Ptr->Withdraw(fund1, amount);
+		wentThrough = acct1Ptr->Withdraw(fund1, amount, out);
 		break;
 
-	case TRANSFER:
-
-		wentThrough = acct1Ptr->Transfer(acct2Ptr, fund1, fund2, amount);
+	case Transaction::TRANSFER:
 
-		acct2Ptr = (acct2Ptr == nullptr) ? acct1Ptr : acct2Ptr;
+		wentThrough = acct1Ptr->Transfer(acct2Ptr, fund1, fund2, amount,
+																	out);
 
 		if (wentThrough) {
 
@@ -194,72 +847,206 @@ void BankSimulation::processTransaction(Account* acct1Ptr, Account* acct2Ptr,
 
 	} else {
 		
-		printInsufficientFunds(acct1Ptr->GetName(), amount, fund1);
+		printInsufficientFunds(acct1Ptr->GetName(), amount, fund1, out);
 
 		acct1Ptr->RecordFailedTransaction(transaction, fund1);
 	}
 }
 
-// Processes opening an Account with parameter stream
-// containing transaction data
-void BankSimulation::openAccount(std::stringstream& stream) {
+// Static function
+// Displays history, or the page of it named by parameter transaction, of
+// Account pointed to by parameter acctPtr to parameter out
+// Negative numbers of a page show nothing
+void BankSimulation::displayHistory(Account* acctPtr,
+									const Transaction& transaction,
+									std::ostream& out) {
+
+	std::size_t first(std::max(transaction.amount, 0)),
+				second(std::max(transaction.id2, 0LL));
+
+	int fund(transaction.fund1);
+
+	switch (transaction.page) {
+
+	case Transaction::LATEST:
+
+		acctPtr->DisplayLatest(fund, first, out);
+		break;
+
+	case Transaction::SLICE:
+
+		acctPtr->DisplayPage(fund, first, second, out);
+		break;
+
+	case Transaction::RANGE:
+
+		acctPtr->DisplayRange(fund, transaction.amount, transaction.id2, out);
+		break;
+
+	default:
+
+		acctPtr->DisplayHistory(fund, out);
+	}
+}
 
-	std::string name, lastName;
-	int id;
+// Static function
+// Processes opening an Account with parameter transaction in
+// parameter accounts, printing to parameter out,
+// returns true if Account was opened
+// An ID number the registry has no room for is invalid, not in use
+bool BankSimulation::openAccount(const Transaction& transaction,
+								 AccountRegistry& accounts, std::ostream& out) {
 
-	stream >> lastName >> name >> id;
+	long long id(transaction.id1);
 
 	if (Account::MIN_ID <= id && id <= Account::MAX_ID) {
-	
+
+		std::string name(transaction.firstName);
+
 		name += " ";
-		name += lastName;
+		name += transaction.lastName;
 
-		Account* newAcct = new Account(name, id);
+		Arena* arena(accounts.GetArena());
 
-		if (!tree.Insert(newAcct)) {
-			
-			printIdInUse(id);
+		HistorySegment* segment(accounts.GetHistorySegment());
+
+		Account* newAcct = (arena != nullptr) ?
+								arena->New<Account>(name, id, arena, segment) :
+								new Account(name, id,
+									std::pmr::get_default_resource(), segment);
+
+		if (accounts.Insert(newAcct)) {
+
+			return true;
+		}
+
+		Account* openPtr;
+
+		if (accounts.Retrieve(id, openPtr)) {
+
+			printIdInUse(id, out);
+
+		} else {
+
+			printInvalidId(id, out);
+		}
+
+		// An Account in an Arena holds only Arena memory, freed with it
+		if (arena == nullptr) {
 
 			delete newAcct;
 		}
 
 	} else {
 		
-		printInvalidId(id);
+		printInvalidId(id, out);
 	}
+
+	return false;
 }
 
+// Static function
+// Accrues rates of parameter transaction on each Account in parameter
+// accounts, printing to parameter out, returns true if an Account
+// was changed
+// For Accounts with no BalanceStore, one Account at a time
+bool BankSimulation::accrueAccounts(const Transaction& transaction,
+									AccountRegistry& accounts,
+									std::ostream& out) {
+
+	int rates[Account::MAX_FUNDS];
+
+	if (!accrualRates(transaction, rates)) {
+
+		printAccrualError(out);
+
+		return false;
+	}
+
+	bool changed(false);
+
+	accounts.Scan(Account::MIN_ID, Account::MAX_ID,
+				  [&changed, &rates](Account* acctPtr) {
+
+		changed |= acctPtr->Accrue(rates);
+	});
+
+	return changed;
+}
+
+// Static function
+// Fills parameter rates with a rate of parameter transaction for each
+// fund, returns true if all are valid
+// Funds past the rates given get 0
+bool BankSimulation::accrualRates(const Transaction& transaction,
+								  int* rates) {
+
+	bool valid(true);
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		rates[fund] = (fund < transaction.amount) ? transaction.rates[fund]
+												  : 0;
+
+		valid &= Account::ValidRate(rates[fund]);
+	}
+
+	return valid;
+}
+
+// Static function
 // Prints error message for transaction with
-// an id not in any active Account
-void BankSimulation::printAccountNotFound(int id) const {
+// an id not in any active Account to parameter out
+void BankSimulation::printAccountNotFound(long long id, std::ostream& out) {
 	
-	std::cout << "ERROR: Account " << id
-			  << " not found. Transaction refused." << std::endl;
+	Stats::RecordFailure(Stats::NOT_FOUND);
+
+	out << "ERROR: Account " << id
+	    << " not found. Transaction refused." << '\n';
 
 }
 
+// Static function
+// Prints error message for accrual with a rate out of range
+// to parameter out
+void BankSimulation::printAccrualError(std::ostream& out) {
+
+	out << "ACCRUAL ERROR" << '\n';
+}
+
+// Static function
 // Prints error message for opening an Account with
-// an id that is already in use
-void BankSimulation::printIdInUse(int id) const {
+// an id that is already in use to parameter out
+void BankSimulation::printIdInUse(long long id, std::ostream& out) {
 
-	std::cout << "ERROR: Account " << id
-			  << " is already open. Transaction refused." << std::endl;
+	Stats::RecordFailure(Stats::ID_IN_USE);
+
+	out << "ERROR: Account " << id
+	    << " is already open. Transaction refused." << '\n';
 }
 
+// Static function
 // Prints error message for opening an Account with
-// an id that is not of valid syntax
-void BankSimulation::printInvalidId(int id) const {
+// an id that is not of valid syntax to parameter out
+void BankSimulation::printInvalidId(long long id, std::ostream& out) {
+
+	Stats::RecordFailure(Stats::INVALID_ID);
 
-	std::cout << "ERROR: Invalid ID number " << id
-			  << "Transaction refused." << std::endl;
+	out << "ERROR: Invalid ID number " << id
+	    << "Transaction refused." << '\n';
 }
 
+// Static function
 // Prints error message for Withdraw or Transfer with
 // an amount that would leave a fund in negative balance
+// to parameter out
 void BankSimulation::printInsufficientFunds(const std::string& client,
-										    int amount, int fund) const {
+										    int amount, int fund,
+										    std::ostream& out) {
+
+	Stats::RecordFailure(Stats::INSUFFICIENT_FUNDS);
 
-	std::cout << "ERROR: Not enough funds to withdraw " << amount << " from "
-		      << client << " " << Account::FundName(fund) << std::endl;
+	out << "ERROR: Not enough funds to withdraw " << amount << " from "
+	    << client << " " << Account::FundName(fund) << '\n';
 
 }
@@ -4,41 +4,247 @@
 //
 // The BankSimulation class simulates transactions in a bank. It takes
 // predetermined transactions from a textfile and then proccesses them.
+//
+// By default the whole file is read before any transaction is processed.
+// In STREAMING mode each transaction is processed as soon as it is read,
+// so memory use does not grow with the size of the file. In MAPPED mode the
+// file is memory-mapped and decoded in place by a TransactionParser. All
+// modes give the same output. A binary journal (see journal.h) is detected
+// from its header and replayed whatever the mode.
+//
+// In SHARDED mode the mapped file is executed by a ShardedEngine, with
+// Accounts split between worker threads. Output is the same as a serial run.
+//
+// In BATCHED mode the mapped file is decoded in batches, each passed to
+// ProcessBatch, which works on each Account once per batch rather than once
+// per transaction (see batchexecutor.h). ProcessBatch can also be called
+// directly with transactions parsed elsewhere.
+//
+// In PIPELINED mode reading, parsing & executing the file each run on their
+// own thread, handing blocks of transactions along in input order (see
+// pipeline.h). PipelineCounters tells which stage held the others back.
+//
+// In PARALLEL mode the mapped file is cut into chunks at line breaks, which
+// are decoded on a pool of threads & applied in input order (see
+// parallelparser.h), so decoding is not held to the speed of one core.
+//
+// With a log set by SetLog, every transaction that changes an Account is
+// appended to a WriteAheadLog (see writeaheadlog.h). Start first rebuilds
+// Accounts from the log, then skips the transactions of the file already
+// in it, so a run cut short by a crash carries on where its log ends. A log
+// belongs to one input file. SHARDED mode runs as MAPPED while logging.
+//
+// When built with BANK_STATS defined, each run measures the time spent in
+// its phases & in each type of transaction (see bankstats.h) and prints a
+// JSON summary of it to std::cerr after the final balances.
+//
+// A transaction with an ID (see transactionparser.h) is skipped, printing
+// nothing, if a transaction with the same ID was applied already in the
+// same run. IDs are kept in a DedupIndex (see dedupindex.h) holding the
+// last window of them, a million by default.
+//
+// Balances of all open Accounts are mirrored in a BalanceStore (see
+// balancestore.h), for bank-wide reports that need not visit each Account.
+// Snapshot may be called on any other thread during a run: the thread
+// applying transactions takes a BalanceSnapshot between two of them, which
+// costs it a copy of the store's page pointers, & the caller waits only for
+// the transaction under way. A snapshot reflects every transaction up to
+// its sequence number & none after, so it is consistent across Accounts.
+// SHARDED mode mirrors balances once its shards finish, so a snapshot
+// asked for during its run waits for the end. Between runs a snapshot is
+// taken at once, so it must not overlap with ProcessBatch called directly.
+// An 'A' transaction accrues its rates on every Account in one pass over
+// the BalanceStore. It prints nothing unless a rate is out of range, when
+// it prints "ACCRUAL ERROR" & changes nothing.
+//
+// All output goes to the stream given at construction, std::cout by default.
+// Pass a FileSink (see outputsink.h) to batch output in large writes.
+//
+// Accounts are stored in an AccountRegistry chosen at compile time: the
+// BPlusTree by default, for any 64 bit ID number, the direct-indexed
+// AccountTable when TABLE_REGISTRY is defined, the BSTree when
+// BSTREE_REGISTRY is defined, or the thread-safe ConcurrentTable when
+// CONCURRENT_REGISTRY is defined. All share the same interface. The tables
+// only hold four digit ID numbers & refuse longer ones as invalid.
+//
+// Accounts, their histories & the nodes of the registry live in Arenas (see
+// arena.h) owned by the simulation, one per shard in SHARDED mode. Start
+// frees the Accounts of the last run in constant time by resetting them, &
+// the next run reuses their memory rather than asking the heap again.
+//
+// With a segment set by SetHistorySpill, Accounts keep only the newest
+// events of each history in memory & move older ones to a HistorySegment
+// file (see historysegment.h), so memory stays bounded however much history
+// a run makes. Output is the same. Start clears the segment with the
+// Accounts of the last run.
 
 #ifndef BANKSIMULATION_H
 #define BANKSIMULATION_H
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <vector>
+#include "arena.h"
+#include "balancestore.h"
+#include "dedupindex.h"
+#include "historysegment.h"
+#include "parallelparser.h"
+#include "pipeline.h"
+#include "transactionparser.h"
+#include "writeaheadlog.h"
+
+#ifdef BSTREE_REGISTRY
 #include "bstree.h"
+typedef BSTree AccountRegistry;
+#elif defined(CONCURRENT_REGISTRY)
+#include "concurrenttable.h"
+typedef ConcurrentTable AccountRegistry;
+#elif defined(TABLE_REGISTRY)
+#include "accounttable.h"
+typedef AccountTable AccountRegistry;
+#else
+#include "bplustree.h"
+typedef BPlusTree AccountRegistry;
+#endif
+
+class BatchExecutor;
 
 class BankSimulation {
 
 public:
 
+	// Constants for the ways a simulation can read its file
+	enum MODE {
+
+		BUFFERED,
+		STREAMING,
+		MAPPED,
+		SHARDED,
+		BATCHED,
+		PIPELINED,
+		PARALLEL
+	};
+
+	// Constructs BankSimulation printing to parameter output, using one
+	// thread per hardware core in modes that run on several threads
+	explicit BankSimulation(std::ostream& output = std::cout);
+
 	// Destroys BankSimulation
 	virtual ~BankSimulation();
 
-	// Starts simulation with parameter fileName
-	void Start(const std::string& fileName);
+	// Sets number of threads used by modes that run on several threads
+	void SetThreads(int count);
+
+	// Logs transactions that change Accounts to write-ahead log with
+	// parameter fileName, committing parameter groupSize of them together
+	// or after parameter groupMilliseconds, returns true if log was opened
+	bool SetLog(const std::string& fileName,
+				int groupSize = WriteAheadLog::GROUP_SIZE,
+				int groupMilliseconds = WriteAheadLog::GROUP_MILLISECONDS);
+
+	// Moves history of Accounts older than the newest parameter hotEvents
+	// events of each fund to a segment file with parameter fileName,
+	// returns true if it was created
+	bool SetHistorySpill(const std::string& fileName,
+						 std::size_t hotEvents = HistorySegment::HOT_EVENTS);
+
+	// Starts simulation with parameter fileName, reading it as
+	// indicated by parameter mode
+	void Start(const std::string& fileName, MODE mode = BUFFERED);
+
+	// Processes parameter count transactions starting at parameter
+	// transactions with the same effects & output as one at a time in order
+	void ProcessBatch(const Transaction* transactions, std::size_t count);
+
+	// Returns balances of all Accounts, one array per fund
+	const BalanceStore& Balances() const;
+
+	// Returns snapshot of balances of all Accounts between two transactions,
+	// may be called on any thread
+	std::shared_ptr<const BalanceSnapshot> Snapshot();
+
+	// Remembers the last parameter window transaction IDs applied, to skip
+	// transactions sent again
+	void SetDedupWindow(std::size_t window);
+
+	// Returns number of transactions skipped in last run as their ID was
+	// applied already
+	long long Duplicates() const;
+
+	// Returns measurements of stages of last PIPELINED run
+	const Pipeline::Counters& PipelineCounters() const;
 
 private:
 
-	// Constant for no number
-	static const int NONE = -1;
+	// Transactions decoded at a time in BATCHED mode
+	static const std::size_t BATCH_SIZE = 16384;
 
-	// Constants for transaction types
-	enum TRANSACTIONTYPE {
+	// Memory of Accounts & registry, declared first so it outlives them
+	Arena arena;
 
-		OPEN      = 'O',
-		HISTORY   = 'H',
-		DEPOSIT   = 'D',
-		WITHDRAW  = 'W',
-		TRANSFER  = 'T'
-	};
+	// Memory of Accounts opened by each shard in SHARDED mode
+	std::vector<std::unique_ptr<Arena>> shardArenas;
+
+	// Segment older history of Accounts moves to, nullptr if kept in memory
+	std::unique_ptr<HistorySegment> historySegment;
+
+	// AccountRegistry that stores Accounts
+	AccountRegistry registry;
+
+	// Balances of Accounts in registry
+	BalanceStore balances;
+
+	// Stream all output is printed to
+	std::ostream& out;
+
+	// Number of threads used by modes that run on several threads
+	int threads;
 
-	// BSTree that stores Accounts
-	BSTree tree;
+	// Log of transactions that changed Accounts, closed if not logging
+	WriteAheadLog log;
+
+	// Sequence number of last transaction read from file
+	long long sequence;
+
+	// Sequence number of last transaction recovered from log
+	long long recovered;
+
+	// Runs batches for ProcessBatch, made on first use
+	std::unique_ptr<BatchExecutor> batcher;
+
+	// Whether each transaction of last batch changed an Account
+	std::vector<char> batchChanged;
+
+	// Measurements of stages of last PIPELINED run
+	Pipeline::Counters pipelineCounters;
+
+	// IDs of transactions applied
+	DedupIndex dedup;
+
+	// Guards running, snapshots & snapshot
+	std::mutex snapshotLock;
+
+	// Signaled when a snapshot is taken or a run stops changing balances
+	std::condition_variable snapshotTaken;
+
+	// True while a caller of Snapshot waits for one
+	std::atomic<bool> snapshotWanted;
+
+	// True while a run may change balances
+	bool running;
+
+	// Number of snapshots taken between transactions
+	long long snapshots;
+
+	// Last snapshot taken between transactions
+	std::shared_ptr<const BalanceSnapshot> snapshot;
+
+	// Rebuilds Accounts from log
+	void recover();
 
 	// Runs phase1 of simulation,
 	// parameter inFile indicating file with predetermined transactions
@@ -51,44 +257,146 @@ private:
 	// Runs phase3 of simulation
 	void phase3();
 
-	// Analyzes parameter transaction, classified by parameter type,
-	// to get necessary data from parameter stream
-	void analyzeTransaction(const std::string& transaction,
-								  std::stringstream& stream, char type);
+	// Runs phase1 & phase2 of simulation together, processing each
+	// transaction of parameter inFile as soon as it is read
+	void stream(std::ifstream& inFile);
+
+	// Runs phase1 & phase2 of simulation together over file with
+	// parameter fileName, decoding it in place from memory
+	void mapped(const std::string& fileName);
+
+	// Runs phase1 & phase2 of simulation together over journal with
+	// parameter fileName, decoding its records in place from memory
+	void replay(const std::string& fileName);
+
+	// Runs phase1 & phase2 of simulation together over file with
+	// parameter fileName, executing it on a ShardedEngine
+	void sharded(const std::string& fileName);
+
+	// Runs phase1 & phase2 of simulation together over file with
+	// parameter fileName, processing it in batches
+	void batched(const std::string& fileName);
+
+	// Runs phase1 & phase2 of simulation together over file with
+	// parameter fileName, on a Pipeline
+	void pipelined(const std::string& fileName);
 
-	// Fills all parameters with corresponding data from parameter stream
-	bool fillData(Account *& acct1Ptr, Account *& acct2Ptr,
-		          std::stringstream& stream, int& amount, int& id1, int& fund1,
-				  int& id2, int& fund2) const;
+	// Runs phase1 & phase2 of simulation together over file with
+	// parameter fileName, decoding it on a ParallelParser
+	void parallel(const std::string& fileName);
 
-	// Fills id and fund with correct numbers to proceed with transaction
-	void fillIdFund(int& id, int& fund) const;
+	// Decodes parameter transaction then applies it
+	void executeTransaction(const std::string& transaction);
 
-	// Processes transaction with given data parameters
-	void processTransaction(Account* acct1Ptr, Account* acct2Ptr,
-							const std::string& transaction, char type,
-						    int amount, int fund1, int fund2);
+	// Analyzes parameter transaction unless it was recovered from log or its
+	// ID was applied already, logging it if it changed an Account
+	void apply(const Transaction& transaction);
 
-	// Processes opening an Account with parameter stream
-	// containing transaction data
-	void openAccount(std::stringstream& stream);
+	// Returns true if parameter transaction has an ID applied already,
+	// remembering its ID otherwise
+	bool duplicate(const Transaction& transaction);
+
+	// Remembers ID of parameter transaction, if any, without counting it as
+	// a duplicate if it is remembered already
+	void remember(const Transaction& transaction);
+
+	// Counts parameter transaction as read, tracking & logging it if
+	// parameter changed
+	void settle(const Transaction& transaction, bool changed);
+
+	// Takes snapshot of balances if one is wanted, called between
+	// transactions
+	void checkpoint();
+
+	// Sets whether a run may change balances to parameter value
+	void setRunning(bool value);
+
+	// Executes parameter transaction, printing to parameter out,
+	// returns true if an Account was changed
+	bool execute(const Transaction& transaction, std::ostream& out);
+
+	// Accrues rates of parameter transaction on all Accounts through
+	// balances, printing to parameter out, returns true if an Account
+	// was changed
+	bool accrue(const Transaction& transaction, std::ostream& out);
+
+	// Attaches Account opened by parameter transaction, if any, to balances
+	void track(const Transaction& transaction);
+
+	// Analyzes parameter transaction, classified by its type, against
+	// Accounts in parameter accounts, printing to parameter out,
+	// returns true if an Account was changed
+	static bool analyzeTransaction(const Transaction& transaction,
+								   AccountRegistry& accounts,
+								   std::ostream& out);
+
+	// Points parameters acct1Ptr & acct2Ptr to Accounts named by
+	// parameter transaction in parameter accounts,
+	// returns true if all were found
+	static bool fillData(Account *& acct1Ptr, Account *& acct2Ptr,
+						 const Transaction& transaction,
+						 const AccountRegistry& accounts);
+
+	// Returns true if processing parameter transaction on Accounts it names
+	// changes them, false if it only prints
+	static bool changesAccounts(const Transaction& transaction);
+
+	// Processes parameter transaction on Accounts it names,
+	// printing to parameter out
+	static void processTransaction(Account* acct1Ptr, Account* acct2Ptr,
+								   const Transaction& transaction,
+								   std::ostream& out);
+
+	// Displays history, or the page of it named by parameter transaction,
+	// of Account pointed to by parameter acctPtr to parameter out
+	static void displayHistory(Account* acctPtr,
+							   const Transaction& transaction,
+							   std::ostream& out);
+
+	// Processes opening an Account with parameter transaction in
+	// parameter accounts, printing to parameter out,
+	// returns true if Account was opened
+	static bool openAccount(const Transaction& transaction,
+							AccountRegistry& accounts, std::ostream& out);
+
+	// Accrues rates of parameter transaction on each Account in parameter
+	// accounts, printing to parameter out, returns true if an Account
+	// was changed
+	static bool accrueAccounts(const Transaction& transaction,
+							   AccountRegistry& accounts, std::ostream& out);
+
+	// Fills parameter rates with a rate of parameter transaction for each
+	// fund, returns true if all are valid
+	static bool accrualRates(const Transaction& transaction, int* rates);
 
 	// Prints error message for transaction with
-	// an id not in any active Account
-	void printAccountNotFound(int id) const;
+	// an id not in any active Account to parameter out
+	static void printAccountNotFound(long long id, std::ostream& out);
+
+	// Prints error message for accrual with a rate out of range
+	// to parameter out
+	static void printAccrualError(std::ostream& out);
 
 	// Prints error message for opening an Account with
-	// an id that is already in use
-	void printIdInUse(int id) const;
+	// an id that is already in use to parameter out
+	static void printIdInUse(long long id, std::ostream& out);
 
 	// Prints error message for opening an Account with
-	// an id that is not of valid syntax
-	void printInvalidId(int id) const;
+	// an id that is not of valid syntax to parameter out
+	static void printInvalidId(long long id, std::ostream& out);
 
 	// Prints error message for Withdraw or Transfer with
 	// an amount that would leave a fund in negative balance
-	void printInsufficientFunds(const std::string& client, int amount,
-														   int fund) const;
+	// to parameter out
+	static void printInsufficientFunds(const std::string& client, int amount,
+									   int fund, std::ostream& out);
+
+	// ShardedEngine, BatchExecutor, Pipeline & ParallelParser run
+	// transactions with the same rules as a serial run
+	friend class ShardedEngine;
+	friend class BatchExecutor;
+	friend class Pipeline;
+	friend class ParallelParser;
 
 };
 #endif
@@ -0,0 +1,264 @@
+// bankstats.cpp
+// Implementations for BankStats class
+// Author: Juan Arias
+//
+// The BankStats class measures where a simulation spends its time: time in
+// each phase of a run & each part of a transaction, latency histograms of
+// each transaction type & number of transactions refused for each reason.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "bankstats.h"
+
+// Transaction types as they appear in transaction files
+const char BankStats::TYPE_NAMES[TYPES] = { 'O', 'D', 'W', 'T', 'H', 'A' };
+
+// Counts of threads that ended
+BankStats::Counts BankStats::totals = {};
+
+// Guards totals
+std::mutex BankStats::totalsLock;
+
+// Constructs Timer starting now
+BankStats::Timer::Timer() :start(std::chrono::steady_clock::now()) {}
+
+// Returns nanoseconds since construction or last lap,
+// then starts a new lap
+long long BankStats::Timer::Lap() {
+
+	std::chrono::steady_clock::time_point now(
+										std::chrono::steady_clock::now());
+
+	long long elapsed(std::chrono::duration_cast<std::chrono::nanoseconds>(
+													now - start).count());
+
+	start = now;
+
+	return elapsed;
+}
+
+// Static function
+// Adds parameter nanoseconds to time spent in parameter phase
+void BankStats::RecordPhase(PHASE phase, long long nanoseconds) {
+
+	local().phases[phase] += nanoseconds;
+}
+
+// Static function
+// Adds parameter nanoseconds to time spent in parameter part
+void BankStats::RecordPart(PART part, long long nanoseconds) {
+
+	local().parts[part] += nanoseconds;
+}
+
+// Static function
+// Counts a transaction of parameter type that took parameter nanoseconds
+// Transactions of an unknown type are not counted
+void BankStats::RecordTransaction(char type, long long nanoseconds) {
+
+	int index(typeIndex(type));
+
+	if (index < 0) {
+
+		return;
+	}
+
+	Counts& counts(local());
+
+	++counts.transactions[index];
+
+	counts.totals[index] += nanoseconds;
+
+	if (nanoseconds > counts.maximums[index]) {
+
+		counts.maximums[index] = nanoseconds;
+	}
+
+	++counts.histograms[index][bucket(nanoseconds)];
+}
+
+// Static function
+// Counts a transaction refused for parameter reason
+void BankStats::RecordFailure(FAILURE reason) {
+
+	++local().failures[reason];
+}
+
+// Static function
+// Discards everything measured so far
+// Counts of other threads still running are kept
+void BankStats::Reset() {
+
+	std::lock_guard<std::mutex> guard(totalsLock);
+
+	totals = Counts();
+
+	local() = Counts();
+}
+
+// Static function
+// Prints everything measured so far to parameter out as JSON
+// Counts of other threads still running are left out
+void BankStats::Report(std::ostream& out) {
+
+	Counts counts;
+
+	{
+		std::lock_guard<std::mutex> guard(totalsLock);
+
+		counts = totals;
+	}
+
+	counts.Add(local());
+
+	out << "{\"phases_ns\":{\"read\":" << counts.phases[READ]
+		<< ",\"execute\":" << counts.phases[EXECUTE]
+		<< ",\"display\":" << counts.phases[DISPLAY]
+		<< "},\"parts_ns\":{\"lookup\":" << counts.parts[LOOKUP]
+		<< ",\"execution\":" << counts.parts[EXECUTION]
+		<< ",\"output\":" << counts.parts[OUTPUT]
+		<< "},\"failures\":{\"not_found\":" << counts.failures[NOT_FOUND]
+		<< ",\"id_in_use\":" << counts.failures[ID_IN_USE]
+		<< ",\"invalid_id\":" << counts.failures[INVALID_ID]
+		<< ",\"insufficient_funds\":" << counts.failures[INSUFFICIENT_FUNDS]
+		<< "},\"transactions\":{";
+
+	for (int index(0); index < TYPES; ++index) {
+
+		long long count(counts.transactions[index]);
+
+		out << (index > 0 ? "," : "") << '"' << TYPE_NAMES[index]
+			<< "\":{\"count\":" << count
+			<< ",\"mean_ns\":" << (count > 0 ? counts.totals[index] / count
+											 : 0)
+			<< ",\"p50_ns\":"
+			<< percentile(counts.histograms[index], count, 0.5,
+						  counts.maximums[index])
+			<< ",\"p99_ns\":"
+			<< percentile(counts.histograms[index], count, 0.99,
+						  counts.maximums[index])
+			<< ",\"p999_ns\":"
+			<< percentile(counts.histograms[index], count, 0.999,
+						  counts.maximums[index])
+			<< ",\"max_ns\":" << counts.maximums[index] << '}';
+	}
+
+	out << "}}\n";
+}
+
+// Adds parameter other to Counts
+void BankStats::Counts::Add(const Counts& other) {
+
+	for (int index(0); index < PHASES; ++index) {
+
+		phases[index] += other.phases[index];
+	}
+
+	for (int index(0); index < PARTS; ++index) {
+
+		parts[index] += other.parts[index];
+	}
+
+	for (int index(0); index < FAILURES; ++index) {
+
+		failures[index] += other.failures[index];
+	}
+
+	for (int index(0); index < TYPES; ++index) {
+
+		transactions[index] += other.transactions[index];
+		totals[index]       += other.totals[index];
+
+		if (other.maximums[index] > maximums[index]) {
+
+			maximums[index] = other.maximums[index];
+		}
+
+		for (int slot(0); slot < BUCKETS; ++slot) {
+
+			histograms[index][slot] += other.histograms[index][slot];
+		}
+	}
+}
+
+// Destroys Local, adding its counts to totals
+BankStats::Local::~Local() {
+
+	std::lock_guard<std::mutex> guard(totalsLock);
+
+	totals.Add(counts);
+}
+
+// Static function
+// Returns counts of calling thread
+BankStats::Counts& BankStats::local() {
+
+	thread_local Local holder;
+
+	return holder.counts;
+}
+
+// Static function
+// Returns index of parameter type in TYPE_NAMES, -1 if none
+int BankStats::typeIndex(char type) {
+
+	for (int index(0); index < TYPES; ++index) {
+
+		if (TYPE_NAMES[index] == type) {
+
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+// Static function
+// Returns histogram bucket of parameter nanoseconds
+// Bucket b holds times from 2^b up to 2^(b+1) - 1, bucket 0 also holds 0
+int BankStats::bucket(long long nanoseconds) {
+
+	if (nanoseconds <= 1) {
+
+		return 0;
+	}
+
+	return 63 - __builtin_clzll(static_cast<unsigned long long>(nanoseconds));
+}
+
+// Static function
+// Returns upper end in nanoseconds of bucket holding parameter
+// fraction of the count parameter count in parameter histogram,
+// at most parameter maximum
+// Returns 0 if histogram is empty. The bucket's upper end may be above
+// every time measured, which no percentile can be.
+long long BankStats::percentile(const long long* histogram, long long count,
+								double fraction, long long maximum) {
+
+	if (count == 0) {
+
+		return 0;
+	}
+
+	// Nearest rank, the smallest time at least this fraction are within
+	long long rank(static_cast<long long>(std::ceil(fraction * count)));
+
+	rank = (rank > 0) ? rank : 1;
+
+	long long seen(0);
+
+	int slot(0);
+
+	for (; slot < BUCKETS - 1; ++slot) {
+
+		seen += histogram[slot];
+
+		if (seen >= rank) {
+
+			break;
+		}
+	}
+
+	return std::min((slot >= 62) ? LLONG_MAX : (2LL << slot) - 1, maximum);
+}
@@ -0,0 +1,205 @@
+// bankstats.h
+// Specifications for BankStats & NoStats classes
+// Author: Juan Arias
+//
+// The BankStats class measures where a simulation spends its time. It
+// keeps:
+//	-time spent in each phase of a run: reading, executing & displaying
+//	-time spent in each part of a transaction: finding its Accounts,
+//	 executing it & printing its output
+//	-number of transactions of each type with a latency histogram, from
+//	 which p50, p99 & p999 latencies are estimated
+//	-number of transactions refused for each reason
+// and prints them as one JSON object at the end of a run.
+//
+// Histograms have one bucket per power of two nanoseconds, so a percentile
+// is known only to within a factor of two, reported as the upper end of its
+// bucket, or the largest time measured if that is lower. Counts are kept per thread without locking & added together when
+// a thread ends or a report is printed.
+//
+// Measuring costs a few clock reads per transaction, so BankSimulation uses
+// the Stats type, which is BankStats only when BANK_STATS is defined.
+// Otherwise it is NoStats, whose functions do nothing & compile away.
+
+#ifndef BANKSTATS_H
+#define BANKSTATS_H
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+
+class BankStats {
+
+public:
+
+	// Constants for phases of a run
+	// Modes that read & execute together count both as EXECUTE
+	enum PHASE {
+
+		READ,
+		EXECUTE,
+		DISPLAY,
+		PHASES
+	};
+
+	// Constants for parts of a transaction
+	enum PART {
+
+		LOOKUP,
+		EXECUTION,
+		OUTPUT,
+		PARTS
+	};
+
+	// Constants for reasons a transaction is refused
+	enum FAILURE {
+
+		NOT_FOUND,
+		ID_IN_USE,
+		INVALID_ID,
+		INSUFFICIENT_FUNDS,
+		FAILURES
+	};
+
+	// Number of histogram buckets, one per power of two nanoseconds
+	static const int BUCKETS = 64;
+
+	// Measures time between laps
+	class Timer {
+
+	public:
+
+		// Constructs Timer starting now
+		Timer();
+
+		// Returns nanoseconds since construction or last lap,
+		// then starts a new lap
+		long long Lap();
+
+	private:
+
+		// Start of current lap
+		std::chrono::steady_clock::time_point start;
+
+	};
+
+	// Adds parameter nanoseconds to time spent in parameter phase
+	static void RecordPhase(PHASE phase, long long nanoseconds);
+
+	// Adds parameter nanoseconds to time spent in parameter part
+	static void RecordPart(PART part, long long nanoseconds);
+
+	// Counts a transaction of parameter type that took parameter nanoseconds
+	static void RecordTransaction(char type, long long nanoseconds);
+
+	// Counts a transaction refused for parameter reason
+	static void RecordFailure(FAILURE reason);
+
+	// Discards everything measured so far
+	static void Reset();
+
+	// Prints everything measured so far to parameter out as JSON
+	static void Report(std::ostream& out);
+
+private:
+
+	// Constants for transaction types, in order of TYPE_NAMES
+	static const int TYPES = 6;
+
+	// Transaction types as they appear in transaction files
+	static const char TYPE_NAMES[TYPES];
+
+	// Everything measured by one thread
+	struct Counts {
+
+		long long phases[PHASES];
+		long long parts[PARTS];
+		long long failures[FAILURES];
+		long long transactions[TYPES];
+		long long totals[TYPES];
+		long long maximums[TYPES];
+		long long histograms[TYPES][BUCKETS];
+
+		// Adds parameter other to Counts
+		void Add(const Counts& other);
+
+	};
+
+	// Counts of calling thread, added to totals when thread ends
+	struct Local {
+
+		Counts counts = {};
+
+		// Destroys Local, adding its counts to totals
+		~Local();
+
+	};
+
+	// Counts of threads that ended
+	static Counts totals;
+
+	// Guards totals
+	static std::mutex totalsLock;
+
+	// Returns counts of calling thread
+	static Counts& local();
+
+	// Returns index of parameter type in TYPE_NAMES, -1 if none
+	static int typeIndex(char type);
+
+	// Returns histogram bucket of parameter nanoseconds
+	static int bucket(long long nanoseconds);
+
+	// Returns upper end in nanoseconds of bucket holding parameter
+	// fraction of the count parameter count in parameter histogram,
+	// at most parameter maximum
+	static long long percentile(const long long* histogram, long long count,
+								double fraction, long long maximum);
+
+};
+
+class NoStats {
+
+public:
+
+	// Constants matching BankStats, so callers compile with either
+	enum PHASE { READ, EXECUTE, DISPLAY };
+	enum PART { LOOKUP, EXECUTION, OUTPUT };
+	enum FAILURE { NOT_FOUND, ID_IN_USE, INVALID_ID, INSUFFICIENT_FUNDS };
+
+	// Timer that reads no clock
+	class Timer {
+
+	public:
+
+		// Returns 0
+		long long Lap() { return 0; }
+
+	};
+
+	// Does nothing
+	static void RecordPhase(PHASE, long long) {}
+
+	// Does nothing
+	static void RecordPart(PART, long long) {}
+
+	// Does nothing
+	static void RecordTransaction(char, long long) {}
+
+	// Does nothing
+	static void RecordFailure(FAILURE) {}
+
+	// Does nothing
+	static void Reset() {}
+
+	// Does nothing
+	static void Report(std::ostream&) {}
+
+};
+
+#ifdef BANK_STATS
+typedef BankStats Stats;
+#else
+typedef NoStats Stats;
+#endif
+#endif
@@ -0,0 +1,292 @@
+// batchexecutor.cpp
+// Implementations for BatchExecutor class
+// Author: Juan Arias
+//
+// The BatchExecutor class runs a batch of parsed transactions grouped by
+// Account instead of one at a time in input order, with the same result &
+// output as a serial run.
+
+#include <cstdint>
+#include "bankstats.h"
+#include "batchexecutor.h"
+
+// Constructs BatchExecutor
+BatchExecutor::BatchExecutor() :output(&captured) {}
+
+// Destroys BatchExecutor
+BatchExecutor::~BatchExecutor() {}
+
+// Runs parameter count transactions starting at parameter transactions
+// against parameter accounts, printing to parameter out, & sets each
+// element of parameter changed to whether that transaction changed
+// an Account
+void BatchExecutor::Run(const Transaction* transactions, std::size_t count,
+						AccountRegistry& accounts, std::ostream& out,
+						std::vector<char>& changed) {
+
+	changed.assign(count, 0);
+
+	std::size_t begin(0);
+
+	while (begin < count) {
+
+		if (alone(transactions[begin])) {
+
+			changed[begin] = BankSimulation::analyzeTransaction(
+									transactions[begin], accounts, out);
+
+			++begin;
+
+			continue;
+		}
+
+		std::size_t end(begin + 1);
+
+		while (end < count && !alone(transactions[end])) {
+
+			++end;
+		}
+
+		runGrouped(transactions + begin, end - begin, accounts, out,
+				   changed.data() + begin);
+
+		begin = end;
+	}
+}
+
+// Runs parameter count transactions starting at parameter transactions,
+// none of them 'O', grouped by Account
+// Each transaction but a 'T' changes only its first Account, a second one
+// is only checked to exist, so it is chained to its first Account alone
+void BatchExecutor::runGrouped(const Transaction* transactions,
+							   std::size_t count, AccountRegistry& accounts,
+							   std::ostream& out, char* changed) {
+
+	Stats::Timer timer;
+
+	if (groups.size() < 4 * count) {
+
+		std::size_t size(2);
+
+		while (size < 4 * count) {
+
+			size *= 2;
+		}
+
+		groups.assign(size, { nullptr, -1, -1 });
+	}
+
+	firsts.assign(count, nullptr);
+	seconds.assign(count, nullptr);
+	next.assign(2 * count, -1);
+	reached.assign(count, 0);
+	starts.assign(count, 0);
+	ends.assign(count, 0);
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		if (!BankSimulation::fillData(firsts[index], seconds[index],
+									  transactions[index], accounts)) {
+
+			continue;
+		}
+
+		int link(2 * static_cast<int>(index));
+
+		chain(firsts[index], link);
+
+		if (paired(transactions, link / 2)) {
+
+			chain(seconds[index], link + 1);
+		}
+	}
+
+	Stats::RecordPart(Stats::LOOKUP, timer.Lap());
+
+	ready.assign(used.rbegin(), used.rend());
+
+	while (!ready.empty()) {
+
+		Group& group(groups[ready.back()]);
+
+		ready.pop_back();
+
+		while (group.head >= 0) {
+
+			int link(group.head), index(link / 2);
+
+			if (paired(transactions, index)) {
+
+				// First chain to reach a 'T' waits for the other, which
+				// runs it & sets both going again
+				if (!reached[index]) {
+
+					reached[index] = 1;
+
+					break;
+				}
+
+				std::size_t other(findGroup((link % 2 == 0) ? seconds[index]
+															: firsts[index]));
+
+				groups[other].head = next[link ^ 1];
+
+				ready.push_back(other);
+			}
+
+			const Transaction& transaction(transactions[index]);
+
+			starts[index] = captured.Text().size();
+
+			BankSimulation::processTransaction(firsts[index], seconds[index],
+											   transaction, output);
+
+			ends[index] = captured.Text().size();
+
+			changed[index] = BankSimulation::changesAccounts(transaction);
+
+			long long execution(timer.Lap());
+
+			Stats::RecordPart(changed[index] ? Stats::EXECUTION
+											 : Stats::OUTPUT, execution);
+			Stats::RecordTransaction(transaction.type, execution);
+
+			group.head = next[link];
+		}
+	}
+
+	for (std::size_t slot : used) {
+
+		groups[slot].acctPtr = nullptr;
+	}
+
+	used.clear();
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		if (firsts[index] != nullptr &&
+			(seconds[index] != nullptr ||
+			 (!transactions[index].twoAccounts &&
+			  transactions[index].type != Transaction::TRANSFER))) {
+
+			continue;
+		}
+
+		starts[index] = captured.Text().size();
+
+		BankSimulation::printAccountNotFound(firsts[index] == nullptr ?
+											 transactions[index].id1 :
+											 transactions[index].id2, output);
+
+		ends[index] = captured.Text().size();
+
+		Stats::RecordTransaction(transactions[index].type, timer.Lap());
+	}
+
+	const std::string& text(captured.Text());
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		if (ends[index] > starts[index]) {
+
+			out.write(text.data() + starts[index],
+					  ends[index] - starts[index]);
+		}
+	}
+
+	captured.Clear();
+
+	Stats::RecordPart(Stats::OUTPUT, timer.Lap());
+}
+
+// Returns everything captured
+const std::string& BatchExecutor::Capture::Text() const {
+
+	return text;
+}
+
+// Discards everything captured
+void BatchExecutor::Capture::Clear() {
+
+	text.clear();
+}
+
+// Appends parameter c
+int BatchExecutor::Capture::overflow(int c) {
+
+	if (c != traits_type::eof()) {
+
+		text += traits_type::to_char_type(c);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+// Appends parameter count characters from parameter text
+std::streamsize BatchExecutor::Capture::xsputn(const char* text,
+											   std::streamsize count) {
+
+	this->text.append(text, count);
+
+	return count;
+}
+
+// Returns slot of groups holding chain of parameter acctPtr, or empty
+// slot ending its probe run
+// The table is never more than half full, so an empty slot is always found
+std::size_t BatchExecutor::findGroup(Account* acctPtr) const {
+
+	std::uint64_t hash(reinterpret_cast<std::uintptr_t>(acctPtr));
+
+	hash *= 0x9e3779b97f4a7c15ULL;
+
+	std::size_t mask(groups.size() - 1),
+				slot((hash ^ (hash >> 32)) & mask);
+
+	while (groups[slot].acctPtr != acctPtr &&
+		   groups[slot].acctPtr != nullptr) {
+
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+// Adds parameter link to chain of parameter acctPtr
+void BatchExecutor::chain(Account* acctPtr, int link) {
+
+	std::size_t slot(findGroup(acctPtr));
+
+	Group& group(groups[slot]);
+
+	if (group.acctPtr == nullptr) {
+
+		group.acctPtr = acctPtr;
+		group.head    = link;
+
+		used.push_back(slot);
+
+	} else {
+
+		next[group.tail] = link;
+	}
+
+	group.tail = link;
+}
+
+// Returns true if transaction parameter index of parameter transactions
+// is a 'T' between two Accounts, false otherwise
+// A 'T' between funds of one Account is chained once, like any other
+bool BatchExecutor::paired(const Transaction* transactions, int index) const {
+
+	return transactions[index].type == Transaction::TRANSFER &&
+		   seconds[index] != firsts[index];
+}
+
+// Static function
+// Returns true if parameter transaction must run alone, false otherwise
+// Opening changes which Accounts exist
+bool BatchExecutor::alone(const Transaction& transaction) {
+
+	return transaction.type == Transaction::OPEN;
+}
@@ -0,0 +1,150 @@
+// batchexecutor.h
+// Specifications for BatchExecutor class
+// Author: Juan Arias
+//
+// The BatchExecutor class runs a batch of parsed transactions grouped by
+// Account instead of one at a time in input order. The batch is split at
+// every 'O' transaction, which changes the registry & runs alone in input
+// order. Within each run of transactions between them:
+//	-every Account is looked up in one pass over the run
+//	-transactions are chained by Account, so each Account's funds and
+//	 history are worked on together, once per run
+//	-a 'T' between two Accounts is chained to both & runs once both chains
+//	 reach it, the first chain to get there waiting for the other
+//	-chains are found in a hash table keyed by Account, sized to the run,
+//	 so grouping costs the same whatever the ID numbers
+//	-output of each transaction is kept with its position & written in
+//	 input order at the end of the run
+// Transactions on one Account keep their input order & transactions on
+// different Accounts do not affect each other, so Accounts end in the same
+// state & output is the same as a serial run. Chains never wait on each
+// other in a cycle: the earliest transaction not yet run is first in the
+// chains of all its Accounts, so it can always run.
+
+#ifndef BATCHEXECUTOR_H
+#define BATCHEXECUTOR_H
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "banksimulation.h"
+
+class BatchExecutor {
+
+public:
+
+	// Constructs BatchExecutor
+	BatchExecutor();
+
+	// Destroys BatchExecutor
+	virtual ~BatchExecutor();
+
+	// Runs parameter count transactions starting at parameter transactions
+	// against parameter accounts, printing to parameter out, & sets each
+	// element of parameter changed to whether that transaction changed
+	// an Account
+	void Run(const Transaction* transactions, std::size_t count,
+			 AccountRegistry& accounts, std::ostream& out,
+			 std::vector<char>& changed);
+
+private:
+
+	// Stream buffer appending to a string whose size can be read cheaply,
+	// as it is read around every transaction
+	class Capture : public std::streambuf {
+
+	public:
+
+		// Returns everything captured
+		const std::string& Text() const;
+
+		// Discards everything captured
+		void Clear();
+
+	protected:
+
+		// Appends parameter c
+		int overflow(int c) override;
+
+		// Appends parameter count characters from parameter text
+		std::streamsize xsputn(const char* text, std::streamsize count)
+																	override;
+
+	private:
+
+		// Captured output
+		std::string text;
+
+	};
+
+	// Chain of transactions of the run on one Account, as links: link
+	// 2i is transaction i on its first Account, link 2i + 1 a 'T' i on its
+	// second Account
+	struct Group {
+
+		// Account of chain, nullptr if slot is empty
+		Account* acctPtr;
+
+		// First link of chain not run yet & last link, -1 if none
+		int head;
+		int tail;
+
+	};
+
+	// Hash table of chains by Account, with open addressing & a power of
+	// two slots, at least twice the Accounts a run can name, two per
+	// transaction
+	std::vector<Group> groups;
+
+	// Next link of the run on the same Account, -1 if none
+	std::vector<int> next;
+
+	// Slots of groups in use, in order of first use
+	std::vector<std::size_t> used;
+
+	// Slots of groups whose chains can go on running
+	std::vector<std::size_t> ready;
+
+	// For each 'T' of the run on two Accounts, true once one of its
+	// chains reached it
+	std::vector<char> reached;
+
+	// Accounts named by each transaction of the run
+	std::vector<Account*> firsts, seconds;
+
+	// Start & end in output of each transaction of the run
+	std::vector<std::size_t> starts, ends;
+
+	// Output of run, written to its stream in input order
+	Capture captured;
+
+	// Stream over captured
+	std::ostream output;
+
+	// Runs parameter count transactions starting at parameter transactions,
+	// none of them 'O', grouped by Account
+	void runGrouped(const Transaction* transactions, std::size_t count,
+					AccountRegistry& accounts, std::ostream& out,
+					char* changed);
+
+	// Returns slot of groups holding chain of parameter acctPtr, or empty
+	// slot ending its probe run
+	std::size_t findGroup(Account* acctPtr) const;
+
+	// Adds parameter link to chain of parameter acctPtr
+	void chain(Account* acctPtr, int link);
+
+	// Returns true if transaction parameter index of parameter transactions
+	// is a 'T' between two Accounts, false otherwise
+	bool paired(const Transaction* transactions, int index) const;
+
+	// Returns true if parameter transaction must run alone, false otherwise
+	static bool alone(const Transaction& transaction);
+
+	// Disallow copying, scratch space is reused between batches
+	BatchExecutor(const BatchExecutor&) = delete;
+	BatchExecutor& operator=(const BatchExecutor&) = delete;
+
+};
+#endif
@@ -0,0 +1,659 @@
+// benchmarks.cpp
+// Microbenchmarks for BSTree, AccountTable, ConcurrentTable, BPlusTree,
+// Account, BalanceStore, DedupIndex & BankSimulation
+// Author: Juan Arias
+//
+// Each benchmark runs a hot path many times and reports throughput,
+// nanoseconds per operation & heap allocations per operation. Output of
+// the code being measured goes to a DiscardSink.
+//
+// Usage: benchmarks [largest input exponent, 3 to 7, default 5]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+#include "accounttable.h"
+#include "balancestore.h"
+#include "banksimulation.h"
+#include "bplustree.h"
+#include "bstree.h"
+#include "concurrenttable.h"
+#include "dedupindex.h"
+#include "outputsink.h"
+
+// Keeps the counting operators out of line, so the compiler pairs operator
+// new with operator delete, not with the malloc & free inside them
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+// Number of heap allocations made by the program
+static std::atomic<long long> allocations(0);
+
+// Counts every heap allocation
+BENCH_NOINLINE
+void* operator new(std::size_t size) {
+
+	++allocations;
+
+	void* ptr(std::malloc(size > 0 ? size : 1));
+
+	if (ptr == nullptr) {
+
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+// Frees memory from counting operator new
+BENCH_NOINLINE
+void operator delete(void* ptr) noexcept {
+
+	std::free(ptr);
+}
+
+// Frees memory from counting operator new
+BENCH_NOINLINE
+void operator delete(void* ptr, std::size_t) noexcept {
+
+	std::free(ptr);
+}
+
+// Runs parameter body, which performs parameter ops operations,
+// then prints its throughput, ns/op & allocations/op under parameter name
+template <class Body>
+void Measure(const std::string& name, long long ops, Body body) {
+
+	long long allocationsBefore(allocations.load());
+
+	auto start(std::chrono::steady_clock::now());
+
+	body();
+
+	auto stop(std::chrono::steady_clock::now());
+
+	double seconds(std::chrono::duration<double>(stop - start).count());
+
+	double allocationsPerOp(static_cast<double>(allocations.load() -
+												allocationsBefore) / ops);
+
+	std::cout << std::left << std::setw(44) << name << std::right
+			  << std::setw(11) << ops << " ops"
+			  << std::fixed << std::setprecision(1)
+			  << std::setw(12) << seconds * 1e9 / ops << " ns/op"
+			  << std::setw(14) << static_cast<long long>(ops / seconds)
+			  << " ops/s"
+			  << std::setprecision(3)
+			  << std::setw(10) << allocationsPerOp << " allocs/op"
+			  << std::endl;
+}
+
+// Returns every four digit ID number, in ascending order if parameter
+// shuffled is false, in a fixed random order otherwise
+std::vector<long long> AccountIds(bool shuffled) {
+
+	std::vector<long long> ids;
+
+	for (long long id(Account::MIN_ID);
+		 id < Account::MIN_ID + AccountTable::CAPACITY; ++id) {
+
+		ids.push_back(id);
+	}
+
+	if (shuffled) {
+
+		std::shuffle(ids.begin(), ids.end(), std::mt19937(2019));
+	}
+
+	return ids;
+}
+
+// Benchmarks Insert & Retrieve of parameter Registry type with IDs in
+// ascending or random order
+template <class Registry>
+void BenchRegistry(const std::string& name, bool shuffled) {
+
+	std::vector<long long> ids(AccountIds(shuffled));
+
+	std::vector<Account*> accounts;
+
+	for (long long id : ids) {
+
+		accounts.push_back(new Account("Bench Client", id));
+	}
+
+	std::string order(shuffled ? " random" : " sequential");
+
+	Registry registry;
+
+	Measure(name + "::Insert" + order, ids.size(), [&]() {
+
+		for (Account* acctPtr : accounts) {
+
+			registry.Insert(acctPtr);
+		}
+	});
+
+	const int ROUNDS = 20;
+
+	long long found(0);
+
+	Measure(name + "::Retrieve" + order, ids.size() * ROUNDS, [&]() {
+
+		for (int round(0); round < ROUNDS; ++round) {
+
+			for (long long id : ids) {
+
+				Account* acctPtr;
+
+				found += registry.Retrieve(id, acctPtr);
+			}
+		}
+	});
+
+	if (found != static_cast<long long>(ids.size()) * ROUNDS) {
+
+		std::cout << "Retrieve missed Accounts" << std::endl;
+	}
+}
+
+// Benchmarks Insert, Retrieve & a full Scan of parameter Registry type
+// holding a million Accounts with random 64 bit IDs, kept in an Arena
+template <class Registry>
+void BenchLargeRegistry(const std::string& name) {
+
+	const int ACCOUNTS = 1 << 20;
+
+	std::mt19937_64 random(2021);
+
+	std::uniform_int_distribution<long long> pickId(Account::MIN_ID,
+													Account::MAX_ID);
+
+	Arena arena;
+
+	std::vector<Account*> accounts;
+
+	for (int count(0); count < ACCOUNTS; ++count) {
+
+		accounts.push_back(arena.New<Account>("Bench Client", pickId(random),
+											  &arena));
+	}
+
+	Registry registry;
+
+	Measure(name + "::Insert 1M random", ACCOUNTS, [&]() {
+
+		for (Account* acctPtr : accounts) {
+
+			registry.Insert(acctPtr);
+		}
+	});
+
+	std::shuffle(accounts.begin(), accounts.end(), random);
+
+	long long found(0);
+
+	Measure(name + "::Retrieve 1M random", ACCOUNTS, [&]() {
+
+		for (Account* acctPtr : accounts) {
+
+			Account* foundPtr;
+
+			found += registry.Retrieve(acctPtr->GetID(), foundPtr);
+		}
+	});
+
+	Measure(name + "::Scan 1M", ACCOUNTS, [&]() {
+
+		registry.Scan(Account::MIN_ID, Account::MAX_ID, [&](Account*) {
+
+			++found;
+		});
+	});
+
+	if (found != 2LL * ACCOUNTS) {
+
+		std::cout << "Retrieve missed Accounts" << std::endl;
+	}
+
+	// Accounts live in the Arena
+	registry.Release();
+}
+
+// Benchmarks ConcurrentTable::Retrieve from parameter readers threads while
+// another thread opens Accounts, total throughput should grow with readers
+// up to the number of cores
+void BenchConcurrentLookups(int readers) {
+
+	std::vector<long long> ids(AccountIds(true));
+
+	std::size_t half(ids.size() / 2);
+
+	ConcurrentTable registry;
+
+	for (std::size_t index(0); index < half; ++index) {
+
+		registry.Insert(new Account("Bench Client", ids[index]));
+	}
+
+	const long long LOOKUPS = 4000000;
+
+	std::atomic<long long> found(0);
+
+	Measure("ConcurrentTable::Retrieve " + std::to_string(readers) +
+			" readers + inserter", LOOKUPS * readers, [&]() {
+
+		std::vector<std::thread> threads;
+
+		threads.emplace_back([&]() {
+
+			for (std::size_t index(half); index < ids.size(); ++index) {
+
+				registry.Insert(new Account("Bench Client", ids[index]));
+			}
+		});
+
+		for (int reader(0); reader < readers; ++reader) {
+
+			threads.emplace_back([&, reader]() {
+
+				ConcurrentTable::ReadGuard guard(registry);
+
+				long long hits(0);
+
+				for (long long lookup(0); lookup < LOOKUPS; ++lookup) {
+
+					Account* acctPtr;
+
+					hits += registry.Retrieve(
+						ids[(lookup + reader) % ids.size()], acctPtr);
+				}
+
+				found += hits;
+			});
+		}
+
+		for (std::thread& thread : threads) {
+
+			thread.join();
+		}
+	});
+
+	if (found < static_cast<long long>(half)) {
+
+		std::cout << "Retrieve missed Accounts" << std::endl;
+	}
+}
+
+// Benchmarks BalanceStore over every fund of a million slots: changing
+// balances, counting below a threshold, each operation being one balance
+// read, & reports kept as balances change, each operation being one report,
+// the first report of each fund refilling its ranking
+void BenchBalanceStore() {
+
+	const int SLOTS = 1000000, ROUNDS = 10;
+
+	BalanceStore store;
+
+	std::mt19937 random(2019);
+
+	std::uniform_int_distribution<int> balance(0, 1000000);
+
+	for (int slot(0); slot < SLOTS; ++slot) {
+
+		store.Add();
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			store.BalanceChanged(slot, fund, balance(random));
+		}
+	}
+
+	long long ops(static_cast<long long>(SLOTS) * Account::MAX_FUNDS * ROUNDS),
+			  reports(ops / 1000);
+
+	std::int64_t checksum(0);
+
+	Measure("BalanceStore::BalanceChanged", SLOTS, [&]() {
+
+		for (int count(0); count < SLOTS; ++count) {
+
+			store.BalanceChanged(count, count % Account::MAX_FUNDS,
+								 balance(random));
+		}
+	});
+
+	Measure("BalanceStore::Total", reports, [&]() {
+
+		for (long long round(0); round < reports / Account::MAX_FUNDS;
+																	++round) {
+
+			for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+				checksum += store.Total(fund);
+			}
+		}
+	});
+
+	Measure("BalanceStore::CountBelow", ops, [&]() {
+
+		for (int round(0); round < ROUNDS; ++round) {
+
+			for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+				checksum += store.CountBelow(fund, 1000);
+			}
+		}
+	});
+
+	Measure("BalanceStore::Summarize", reports, [&]() {
+
+		for (long long round(0); round < reports / Account::MAX_FUNDS;
+																	++round) {
+
+			for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+				checksum += store.Summarize(fund).max;
+			}
+		}
+	});
+
+	std::vector<BalanceRanking::Entry> top;
+
+	Measure("BalanceStore::Top", reports, [&]() {
+
+		for (long long round(0); round < reports / Account::MAX_FUNDS;
+																	++round) {
+
+			for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+				store.Top(fund, 1, top);
+
+				checksum += top[0].first;
+			}
+		}
+	});
+
+	if (checksum == 0) {
+
+		std::cout << "BalanceStore reports were empty" << std::endl;
+	}
+}
+
+// Benchmarks one accrual over 10 million slots of ten funds, as at the
+// close of a period, with rates alternating between interest & fees
+void BenchAccrual() {
+
+	const int SLOTS = 10000000;
+
+	BalanceStore store;
+
+	for (int slot(0); slot < SLOTS; ++slot) {
+
+		store.Add();
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			store.BalanceChanged(slot, fund, 1000000 + slot);
+		}
+	}
+
+	int rates[Account::MAX_FUNDS] = { 25, -10, 40, -5, 100, 15, -30, 60,
+									  5, -1 };
+
+	Measure("BalanceStore::Accrue", static_cast<long long>(SLOTS) *
+									Account::MAX_FUNDS, [&]() {
+
+		store.Accrue(rates);
+	});
+}
+
+// Benchmarks DedupIndex::Insert on a full default window, where one in
+// four IDs is a retry still remembered & every new ID forgets the oldest
+void BenchDedup() {
+
+	const int OPS = 10000000;
+
+	DedupIndex index;
+
+	for (std::uint64_t id(0); id < DedupIndex::DEFAULT_WINDOW; ++id) {
+
+		index.Insert(id);
+	}
+
+	std::uint64_t next(DedupIndex::DEFAULT_WINDOW);
+
+	Measure("DedupIndex::Insert", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			index.Insert((op % 4 == 0) ? next - 1000 : next++);
+		}
+	});
+}
+
+// Benchmarks Deposit, Withdraw with & without covering from a linked
+// fund, & Transfer between Accounts
+void BenchAccount() {
+
+	const int OPS = 1000000;
+
+	Account acct("Bench Client", 1001), other("Other Client", 1002);
+
+	Measure("Account::Deposit", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			acct.Deposit(op % Account::MAX_FUNDS, 10);
+		}
+	});
+
+	Measure("Account::Withdraw", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			acct.Withdraw(Account::INDEX_FUND_500 +
+						  op % (Account::MAX_FUNDS - Account::INDEX_FUND_500),
+						  1);
+		}
+	});
+
+	// Linked funds start empty so every Withdraw is covered by its pair
+	Account linked("Linked Client", 1003);
+
+	linked.Deposit(Account::PRIME_MONEY_MARKET, OPS);
+	linked.Deposit(Account::SHORT_TERM_BOND, OPS);
+
+	Measure("Account::Withdraw cover MM<-Prime", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			linked.Withdraw(Account::MONEY_MARKET, 1);
+		}
+	});
+
+	Measure("Account::Withdraw cover Long<-Short", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			linked.Withdraw(Account::LONG_TERM_BOND, 1);
+		}
+	});
+
+	Measure("Account::Transfer", OPS, [&]() {
+
+		for (int op(0); op < OPS; ++op) {
+
+			acct.Transfer(&other, Account::VALUE_FUND, Account::VALUE_FUND, 1);
+			other.Transfer(&acct, Account::VALUE_FUND, Account::VALUE_FUND, 1);
+		}
+	});
+}
+
+// Writes parameter lines random transactions to file with parameter
+// fileName, opening Accounts first
+void GenerateInput(const std::string& fileName, long long lines) {
+
+	std::ofstream outFile(fileName);
+
+	std::mt19937 random(1001);
+
+	long long accounts(std::min<long long>(AccountTable::CAPACITY - 1,
+										   std::max<long long>(lines / 10, 1)));
+
+	for (long long acct(0); acct < accounts; ++acct) {
+
+		outFile << "O Client" << acct << " Bench " << Account::MIN_ID + acct
+				<< '\n';
+	}
+
+	std::uniform_int_distribution<int> pickAccount(Account::MIN_ID,
+											Account::MIN_ID + accounts - 1),
+									   pickFund(0, Account::MAX_FUNDS - 1),
+									   pickAmount(1, 1000),
+									   pickType(0, 99);
+
+	for (long long line(accounts); line < lines; ++line) {
+
+		int type(pickType(random));
+
+		int id(pickAccount(random) * Account::MAX_FUNDS + pickFund(random));
+
+		if (type < 45) {
+
+			outFile << "D " << id << ' ' << pickAmount(random) << '\n';
+
+		} else if (type < 80) {
+
+			outFile << "W " << id << ' ' << pickAmount(random) << '\n';
+
+		} else if (type < 99) {
+
+			outFile << "T " << id << ' ' << pickAmount(random) << ' '
+					<< pickAccount(random) * Account::MAX_FUNDS +
+					   pickFund(random) << '\n';
+
+		} else {
+
+			outFile << "H " << id << '\n';
+		}
+	}
+}
+
+// Benchmarks BankSimulation::Start end to end in every mode on generated
+// inputs of 10^3 up to 10^maxExponent lines
+void BenchSimulation(int maxExponent) {
+
+	const char* names[] = { "BUFFERED", "STREAMING", "MAPPED", "SHARDED",
+							"BATCHED", "PIPELINED", "PARALLEL" };
+
+	const std::string fileName("bench_input.txt");
+
+	long long lines(1000);
+
+	for (int exponent(3); exponent <= maxExponent; ++exponent, lines *= 10) {
+
+		GenerateInput(fileName, lines);
+
+		for (int mode(BankSimulation::BUFFERED);
+			 mode <= BankSimulation::PARALLEL; ++mode) {
+
+			DiscardSink discard;
+
+			BankSimulation sim(discard);
+
+			Measure(std::string("BankSimulation::Start ") + names[mode] +
+					" 10^" + std::to_string(exponent), lines, [&]() {
+
+				sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+			});
+		}
+	}
+
+	std::remove(fileName.c_str());
+}
+
+// Benchmarks BankSimulation::Start run again & again on one simulation,
+// as a batch runner does, so Accounts of each run reuse the memory of the
+// run before
+void BenchRestart() {
+
+	const int RUNS = 50;
+
+	const std::string fileName("bench_restart.txt");
+
+	GenerateInput(fileName, 100000);
+
+	DiscardSink discard;
+
+	BankSimulation sim(discard);
+
+	sim.Start(fileName, BankSimulation::MAPPED);
+
+	Measure("BankSimulation::Start again MAPPED 10^5", RUNS, [&]() {
+
+		for (int run(0); run < RUNS; ++run) {
+
+			sim.Start(fileName, BankSimulation::MAPPED);
+		}
+	});
+
+	std::remove(fileName.c_str());
+}
+
+// Runs all benchmarks
+int main(int argc, char* argv[]) {
+
+	int maxExponent(argc > 1 ? std::atoi(argv[1]) : 5);
+
+	maxExponent = std::min(std::max(maxExponent, 3), 7);
+
+	BenchRegistry<BSTree>("BSTree", false);
+	BenchRegistry<BSTree>("BSTree", true);
+	BenchRegistry<AccountTable>("AccountTable", false);
+	BenchRegistry<AccountTable>("AccountTable", true);
+	BenchRegistry<ConcurrentTable>("ConcurrentTable", false);
+	BenchRegistry<ConcurrentTable>("ConcurrentTable", true);
+	BenchRegistry<BPlusTree>("BPlusTree", false);
+	BenchRegistry<BPlusTree>("BPlusTree", true);
+
+	BenchLargeRegistry<BSTree>("BSTree");
+	BenchLargeRegistry<BPlusTree>("BPlusTree");
+
+	for (int readers(1); readers <= 8; readers *= 2) {
+
+		BenchConcurrentLookups(readers);
+	}
+
+	BenchAccount();
+
+	BenchBalanceStore();
+
+	BenchAccrual();
+
+	BenchDedup();
+
+	BenchSimulation(maxExponent);
+
+	BenchRestart();
+
+	return 0;
+}
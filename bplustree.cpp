@@ -0,0 +1,407 @@
+// bplustree.cpp
+// Implementations for BPlusTree class
+// Author: Juan Arias
+//
+// The BPlusTree class is an ordered index of objects of the Account class
+// by 64 bit ID number, with wide nodes & Accounts in linked leaves.
+
+#include <algorithm>
+#include <iostream>
+#include "bplustree.h"
+
+// Constants, defined here as they may be bound to references
+const int BPlusTree::FANOUT;
+const long long BPlusTree::UNUSED;
+
+// Constructs empty BPlusTree, taking nodes from parameter arena if not
+// nullptr
+BPlusTree::BPlusTree(Arena* arena) :root(nullptr), height(0), count(0),
+									arena(arena), segment(nullptr) {}
+
+// Destroys BPlusTree
+// Calls Empty to deallocate dynamic memory
+BPlusTree::~BPlusTree() {
+
+	Empty();
+}
+
+// Inserts Account object referenced by parameter acctPtr,
+// returns true if successful, false if ID is in use
+// A root that splits gets a new root above it, so all leaves stay at
+// the same depth
+bool BPlusTree::Insert(Account* acctPtr) {
+
+	if (root == nullptr) {
+
+		Leaf* leaf(newNode<Leaf>());
+
+		leaf->keys[0]     = acctPtr->GetID();
+		leaf->accounts[0] = acctPtr;
+		leaf->count       = 1;
+
+		root  = leaf;
+		count = 1;
+
+		return true;
+	}
+
+	Split split = { 0, nullptr };
+
+	if (!insertNode(root, height, acctPtr, split)) {
+
+		return false;
+	}
+
+	if (split.right != nullptr) {
+
+		Inner* top(newNode<Inner>());
+
+		top->keys[0]     = split.key;
+		top->children[0] = root;
+		top->children[1] = split.right;
+		top->count       = 1;
+
+		root = top;
+
+		++height;
+	}
+
+	++count;
+
+	return true;
+}
+
+// Points parameter acctPtr to Account object with ID given as a parameter
+// returns true if found, otherwise will point to nullptr then return false
+bool BPlusTree::Retrieve(const long long& ID, Account*& acctPtr) const {
+
+	const Leaf* leaf(findLeaf(ID));
+
+	acctPtr = nullptr;
+
+	if (leaf != nullptr) {
+
+		int pos(lowerBound(leaf, ID));
+
+		if (pos < leaf->count && leaf->keys[pos] == ID) {
+
+			acctPtr = leaf->accounts[pos];
+		}
+	}
+
+	return acctPtr != nullptr;
+}
+
+// Displays info of all stored Accounts to parameter out
+// Leaves are visited in ID order, same as an inorder traversal of BSTree
+void BPlusTree::Display(std::ostream& out) const {
+
+	Scan(Account::MIN_ID, Account::MAX_ID, [&out](Account* acctPtr) {
+
+		acctPtr->DisplayBalances(out);
+	});
+}
+
+// Clears all stored Accounts
+// Uses helper method deleteNode, unless the Arena frees them
+void BPlusTree::Empty() {
+
+	if (arena == nullptr && root != nullptr) {
+
+		deleteNode(root, height, true);
+	}
+
+	root   = nullptr;
+	height = 0;
+	count  = 0;
+}
+
+// Forgets all stored Accounts without deleting them,
+// for when another owner has taken them
+// Uses helper method deleteNode, unless the Arena frees nodes
+void BPlusTree::Release() {
+
+	if (arena == nullptr && root != nullptr) {
+
+		deleteNode(root, height, false);
+	}
+
+	root   = nullptr;
+	height = 0;
+	count  = 0;
+}
+
+// Returns true if BPlusTree is empty, false otherwise
+bool BPlusTree::isEmpty() const {
+
+	return count == 0;
+}
+
+// Returns number of stored Accounts
+std::size_t BPlusTree::Size() const {
+
+	return count;
+}
+
+// Returns Arena nodes & Accounts live in, nullptr if heap
+Arena* BPlusTree::GetArena() const {
+
+	return arena;
+}
+
+// Sets parameter segment as where Accounts opened in BPlusTree from now
+// on move older history, nullptr to keep it all in memory
+// Accounts already opened keep the segment they were given
+void BPlusTree::SetHistorySegment(HistorySegment* segment) {
+
+	this->segment = segment;
+}
+
+// Returns segment older history of new Accounts moves to, nullptr if none
+HistorySegment* BPlusTree::GetHistorySegment() const {
+
+	return segment;
+}
+
+// Returns leaf where parameter ID is or would be, nullptr if empty
+const BPlusTree::Leaf* BPlusTree::findLeaf(long long ID) const {
+
+	const Node* node(root);
+
+	for (int level(height); level > 0 && node != nullptr; --level) {
+
+		const Inner* inner(static_cast<const Inner*>(node));
+
+		node = inner->children[upperBound(inner, ID)];
+	}
+
+	return static_cast<const Leaf*>(node);
+}
+
+// Returns new empty node of type T
+// Value-initializing zeroes its count & links, unused ID numbers are the
+// largest possible
+template <class T>
+T* BPlusTree::newNode() {
+
+	T* node((arena != nullptr) ? arena->New<T>() : new T());
+
+	std::fill(node->keys, node->keys + FANOUT, UNUSED);
+
+	return node;
+}
+
+// Recursive helper for Insert, inserts parameter acctPtr under parameter
+// node at parameter level, filling parameter split if node split
+bool BPlusTree::insertNode(Node* node, int level, Account* acctPtr,
+						   Split& split) {
+
+	long long ID(acctPtr->GetID());
+
+	if (level == 0) {
+
+		Leaf* leaf(static_cast<Leaf*>(node));
+
+		int pos(lowerBound(leaf, ID));
+
+		if (pos < leaf->count && leaf->keys[pos] == ID) {
+
+			return false;
+		}
+
+		if (leaf->count == FANOUT) {
+
+			splitLeaf(leaf, pos, acctPtr, split);
+
+			return true;
+		}
+
+		std::copy_backward(leaf->keys + pos, leaf->keys + leaf->count,
+						   leaf->keys + leaf->count + 1);
+		std::copy_backward(leaf->accounts + pos,
+						   leaf->accounts + leaf->count,
+						   leaf->accounts + leaf->count + 1);
+
+		leaf->keys[pos]     = ID;
+		leaf->accounts[pos] = acctPtr;
+
+		++leaf->count;
+
+		return true;
+	}
+
+	Inner* inner(static_cast<Inner*>(node));
+
+	int pos(upperBound(inner, ID));
+
+	Split child = { 0, nullptr };
+
+	if (!insertNode(inner->children[pos], level - 1, acctPtr, child)) {
+
+		return false;
+	}
+
+	if (child.right == nullptr) {
+
+		return true;
+	}
+
+	if (inner->count == FANOUT) {
+
+		splitInner(inner, pos, child, split);
+
+		return true;
+	}
+
+	std::copy_backward(inner->keys + pos, inner->keys + inner->count,
+					   inner->keys + inner->count + 1);
+	std::copy_backward(inner->children + pos + 1,
+					   inner->children + inner->count + 1,
+					   inner->children + inner->count + 2);
+
+	inner->keys[pos]         = child.key;
+	inner->children[pos + 1] = child.right;
+
+	++inner->count;
+
+	return true;
+}
+
+// Inserts parameter acctPtr at parameter pos of full parameter leaf,
+// splitting it into parameter split
+// An ID past all of the leaf's goes alone into the new leaf, others split
+// the leaf in half
+void BPlusTree::splitLeaf(Leaf* leaf, int pos, Account* acctPtr,
+						  Split& split) {
+
+	long long keys[FANOUT + 1];
+	Account* accounts[FANOUT + 1];
+
+	std::copy(leaf->keys, leaf->keys + pos, keys);
+	std::copy(leaf->keys + pos, leaf->keys + FANOUT, keys + pos + 1);
+	std::copy(leaf->accounts, leaf->accounts + pos, accounts);
+	std::copy(leaf->accounts + pos, leaf->accounts + FANOUT,
+			  accounts + pos + 1);
+
+	keys[pos]     = acctPtr->GetID();
+	accounts[pos] = acctPtr;
+
+	int kept((pos == FANOUT) ? FANOUT : (FANOUT + 1) / 2);
+
+	Leaf* right(newNode<Leaf>());
+
+	std::copy(keys, keys + kept, leaf->keys);
+	std::copy(accounts, accounts + kept, leaf->accounts);
+	std::copy(keys + kept, keys + FANOUT + 1, right->keys);
+	std::copy(accounts + kept, accounts + FANOUT + 1, right->accounts);
+
+	std::fill(leaf->keys + kept, leaf->keys + FANOUT, UNUSED);
+
+	leaf->count  = kept;
+	right->count = FANOUT + 1 - kept;
+
+	right->next = leaf->next;
+	leaf->next  = right;
+
+	split.key   = right->keys[0];
+	split.right = right;
+}
+
+// Inserts parameter child at parameter pos of full parameter inner,
+// splitting it into parameter split
+// The middle ID number moves up to the parent rather than staying in
+// either half
+void BPlusTree::splitInner(Inner* inner, int pos, Split& child,
+						   Split& split) {
+
+	long long keys[FANOUT + 1];
+	Node* children[FANOUT + 2];
+
+	std::copy(inner->keys, inner->keys + pos, keys);
+	std::copy(inner->keys + pos, inner->keys + FANOUT, keys + pos + 1);
+	std::copy(inner->children, inner->children + pos + 1, children);
+	std::copy(inner->children + pos + 1, inner->children + FANOUT + 1,
+			  children + pos + 2);
+
+	keys[pos]         = child.key;
+	children[pos + 1] = child.right;
+
+	int kept((FANOUT + 1) / 2);
+
+	Inner* right(newNode<Inner>());
+
+	std::copy(keys, keys + kept, inner->keys);
+	std::copy(children, children + kept + 1, inner->children);
+	std::copy(keys + kept + 1, keys + FANOUT + 1, right->keys);
+	std::copy(children + kept + 1, children + FANOUT + 2, right->children);
+
+	std::fill(inner->keys + kept, inner->keys + FANOUT, UNUSED);
+
+	inner->count = kept;
+	right->count = FANOUT - kept;
+
+	split.key   = keys[kept];
+	split.right = right;
+}
+
+// Recursive helper for Empty & Release, uses parameter node at parameter
+// level to traverse, deleting Accounts if parameter owned is true
+void BPlusTree::deleteNode(Node* node, int level, bool owned) {
+
+	if (level == 0) {
+
+		Leaf* leaf(static_cast<Leaf*>(node));
+
+		if (owned) {
+
+			for (int pos(0); pos < leaf->count; ++pos) {
+
+				delete leaf->accounts[pos];
+			}
+		}
+
+		delete leaf;
+
+		return;
+	}
+
+	Inner* inner(static_cast<Inner*>(node));
+
+	for (int pos(0); pos <= inner->count; ++pos) {
+
+		deleteNode(inner->children[pos], level - 1, owned);
+	}
+
+	delete inner;
+}
+
+// Static function
+// Returns number of ID numbers of parameter node less than parameter ID
+// Counts over all FANOUT ID numbers with no early exit, so the loop has a
+// fixed length & no branch depends on the ID numbers compared
+int BPlusTree::lowerBound(const Node* node, long long ID) {
+
+	int less(0);
+
+	for (int pos(0); pos < FANOUT; ++pos) {
+
+		less += node->keys[pos] < ID;
+	}
+
+	return less;
+}
+
+// Static function
+// Returns number of ID numbers of parameter node not more than
+// parameter ID
+int BPlusTree::upperBound(const Node* node, long long ID) {
+
+	int notMore(0);
+
+	for (int pos(0); pos < FANOUT; ++pos) {
+
+		notMore += node->keys[pos] <= ID;
+	}
+
+	return notMore;
+}
@@ -0,0 +1,213 @@
+// bplustree.h
+// Specifications for BPlusTree class
+// Author: Juan Arias
+//
+// The BPlusTree class is an ordered index of objects of the Account class
+// by 64 bit ID number, for registries of millions of Accounts. Nodes are
+// wide, holding up to FANOUT ID numbers side by side, so a lookup reads a
+// few contiguous cache lines per level & the tree stays a handful of levels
+// deep: four levels hold over a million Accounts. Accounts are kept only in
+// leaves, which are linked in ID order. It has the same interface as
+// BSTree and can:
+//	-insert an Account in O(log n)
+//	-retrieve an Account in O(log n)
+//	-display info of all stored Accounts (in ID order)
+//	-visit the Accounts with ID numbers in a range, in ID order
+//	-clear all stored Accounts
+//	-release all stored Accounts to another owner
+//	-check if it is empty
+//
+// Unused ID numbers of a node hold a value past every valid one, so a
+// search compares all of them in a loop of fixed length with no branch on
+// the result, which the compiler can unroll or vectorize.
+//
+// A leaf that fills up splits in half, unless the new ID number is past all
+// of its own, when the full leaf is kept & the new one starts a leaf of its
+// own, so Accounts opened in increasing ID order leave every leaf full.
+//
+// A BPlusTree given an Arena (see arena.h) takes its nodes from it &
+// expects its Accounts to live there too. It never frees them: Empty &
+// Release only forget them, in constant time, leaving the owner of the
+// Arena to reset it.
+// A HistorySegment set on it (see historysegment.h) is given to Accounts
+// opened in it, as its Arena is.
+
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <climits>
+#include "account.h"
+#include "arena.h"
+
+class BPlusTree {
+
+public:
+
+	// Most ID numbers held by a node
+	static const int FANOUT = 32;
+
+	// Constructs empty BPlusTree, taking nodes from parameter arena if not
+	// nullptr
+	explicit BPlusTree(Arena* arena = nullptr);
+
+	// Destroys BPlusTree
+	virtual ~BPlusTree();
+
+	// Inserts Account object referenced by parameter acctPtr,
+	// returns true if successful, false if ID is in use
+	bool Insert(Account* acctPtr);
+
+	// Points parameter acctPtr to Account object with ID given as a parameter
+	// returns true if found, otherwise will point to nullptr then return false
+	bool Retrieve(const long long& ID, Account*& acctPtr) const;
+
+	// Calls parameter visit with each stored Account with ID number from
+	// parameter first through parameter last, in ID order
+	template <class Visit>
+	void Scan(long long first, long long last, Visit visit) const;
+
+	// Displays info of all stored Accounts to parameter out
+	void Display(std::ostream& out = std::cout) const;
+
+	// Clears all stored Accounts
+	void Empty();
+
+	// Forgets all stored Accounts without deleting them,
+	// for when another owner has taken them
+	void Release();
+
+	// Returns true if BPlusTree is empty, false otherwise
+	bool isEmpty() const;
+
+	// Returns number of stored Accounts
+	std::size_t Size() const;
+
+	// Returns Arena nodes & Accounts live in, nullptr if heap
+	Arena* GetArena() const;
+
+	// Sets parameter segment as where Accounts opened in BPlusTree from now
+	// on move older history, nullptr to keep it all in memory
+	void SetHistorySegment(HistorySegment* segment);
+
+	// Returns segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* GetHistorySegment() const;
+
+private:
+
+	// Constant for an unused ID number of a node, past every valid one
+	static const long long UNUSED = LLONG_MAX;
+
+	// ID numbers of a node, in increasing order
+	struct Node {
+
+		// Number of ID numbers held
+		int count;
+
+		// ID numbers held, then UNUSED
+		long long keys[FANOUT];
+
+	};
+
+	// Node at the bottom of the tree, holding Accounts
+	struct Leaf : Node {
+
+		// Account of each ID number
+		Account* accounts[FANOUT];
+
+		// Leaf with the next ID numbers, nullptr if last
+		Leaf* next;
+
+	};
+
+	// Node above the leaves, child i holds ID numbers from key i - 1 up to
+	// but not including key i
+	struct Inner : Node {
+
+		// Children, one more than ID numbers
+		Node* children[FANOUT + 1];
+
+	};
+
+	// New node made by a split, with the first ID number under it
+	struct Split {
+
+		long long key;
+		Node* right;
+
+	};
+
+	// Top node, nullptr if empty
+	Node* root;
+
+	// Number of levels of Inner nodes above the leaves
+	int height;
+
+	// Number of stored Accounts
+	std::size_t count;
+
+	// Arena nodes & Accounts live in, nullptr if heap
+	Arena* arena;
+
+	// Segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* segment;
+
+	// Returns leaf where parameter ID is or would be, nullptr if empty
+	const Leaf* findLeaf(long long ID) const;
+
+	// Returns new empty node of type T
+	template <class T>
+	T* newNode();
+
+	// Recursive helper for Insert, inserts parameter acctPtr under parameter
+	// node at parameter level, filling parameter split if node split
+	bool insertNode(Node* node, int level, Account* acctPtr, Split& split);
+
+	// Inserts parameter acctPtr at parameter pos of full parameter leaf,
+	// splitting it into parameter split
+	void splitLeaf(Leaf* leaf, int pos, Account* acctPtr, Split& split);
+
+	// Inserts parameter child at parameter pos of full parameter inner,
+	// splitting it into parameter split
+	void splitInner(Inner* inner, int pos, Split& child, Split& split);
+
+	// Recursive helper for Empty & Release, uses parameter node at parameter
+	// level to traverse, deleting Accounts if parameter owned is true
+	void deleteNode(Node* node, int level, bool owned);
+
+	// Returns number of ID numbers of parameter node less than parameter ID
+	static int lowerBound(const Node* node, long long ID);
+
+	// Returns number of ID numbers of parameter node not more than
+	// parameter ID
+	static int upperBound(const Node* node, long long ID);
+
+	// Disallow copying, nodes have a single owner
+	BPlusTree(const BPlusTree&) = delete;
+	BPlusTree& operator=(const BPlusTree&) = delete;
+
+};
+
+// Calls parameter visit with each stored Account with ID number from
+// parameter first through parameter last, in ID order
+// Finds the first leaf once, then follows links between leaves
+template <class Visit>
+void BPlusTree::Scan(long long first, long long last, Visit visit) const {
+
+	const Leaf* leaf(findLeaf(first));
+
+	int pos(leaf != nullptr ? lowerBound(leaf, first) : 0);
+
+	for (; leaf != nullptr; leaf = leaf->next, pos = 0) {
+
+		for (; pos < leaf->count; ++pos) {
+
+			if (leaf->keys[pos] > last) {
+
+				return;
+			}
+
+			visit(leaf->accounts[pos]);
+		}
+	}
+}
+#endif
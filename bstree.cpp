@@ -8,14 +8,16 @@
 //	-retrieve an Account
 //	-display info of all stored Accounts
 //	-clear all stored Accounts
+//	-release all stored Accounts to another owner
 //	-check if it is empty
 
 #include <iostream>
 #include "bstree.h"
 
-// Constructs BSTree
+// Constructs BSTree, taking nodes from parameter arena if not nullptr
 // Initializes root to nullptr
-BSTree::BSTree() :root(nullptr) {}
+BSTree::BSTree(Arena* arena) :root(nullptr), arena(arena),
+								segment(nullptr) {}
 
 // Destroys BSTree
 // Calls Empty to deallocate dynamic memory
@@ -31,7 +33,7 @@ bool BSTree::Insert(Account* newPtr) {
 
 	if (root == nullptr) {
 	
-		root = new Node(newPtr);
+		root = newNode(newPtr);
 		
 		return true;
 
@@ -43,24 +45,40 @@ bool BSTree::Insert(Account* newPtr) {
 // Points parameter acctPtr to Account object with ID given as a parameter
 // returns true if found, otherwise will point to nullptr then return false
 // Uses helper method retrieveNode
-bool BSTree::Retrieve(const int& ID, Account *& acct) const {
+bool BSTree::Retrieve(const long long& ID, Account *& acct) const {
 
 	return retrieveNode(root, ID, acct);
 }
 
-// Displays info of all stored Accounts to output
+// Displays info of all stored Accounts to parameter out
 // Uses helper method displayNode
-void BSTree::Display() const {
+void BSTree::Display(std::ostream& out) const {
 
-	displayNode(root);
+	displayNode(root, out);
 
 }
 
 // Clears all stored Accounts
-// Uses helper method deleteNode
+// Uses helper method deleteNode, unless the Arena frees them
 void BSTree::Empty() {
 
-	deleteNode(root);
+	if (arena == nullptr) {
+
+		deleteNode(root);
+	}
+
+	root = nullptr;
+}
+
+// Forgets all stored Accounts without deleting them,
+// for when another owner has taken them
+// Uses helper method releaseNode, unless the Arena frees nodes
+void BSTree::Release() {
+
+	if (arena == nullptr) {
+
+		releaseNode(root);
+	}
 
 	root = nullptr;
 }
@@ -71,6 +89,33 @@ bool BSTree::isEmpty() const {
 	return root == nullptr;
 }
 
+// Returns Arena nodes & Accounts live in, nullptr if heap
+Arena* BSTree::GetArena() const {
+
+	return arena;
+}
+
+// Sets parameter segment as where Accounts opened in BSTree from now
+// on move older history, nullptr to keep it all in memory
+// Accounts already opened keep the segment they were given
+void BSTree::SetHistorySegment(HistorySegment* segment) {
+
+	this->segment = segment;
+}
+
+// Returns segment older history of new Accounts moves to, nullptr if none
+HistorySegment* BSTree::GetHistorySegment() const {
+
+	return segment;
+}
+
+// Returns new Node holding parameter acctPtr
+BSTree::Node* BSTree::newNode(Account* acctPtr) {
+
+	return (arena != nullptr) ? arena->New<Node>(acctPtr)
+							  : new Node(acctPtr);
+}
+
 // Recursive helper for Insert, uses parameter curr to traverse
 bool BSTree::insertNode(Node* curr, Account* newPtr) {
 
@@ -78,7 +123,7 @@ bool BSTree::insertNode(Node* curr, Account* newPtr) {
 
 		if (curr->left == nullptr) {
 		
-			curr->left = new Node(newPtr);
+			curr->left = newNode(newPtr);
 			
 			return true;
 		}
@@ -89,7 +134,7 @@ bool BSTree::insertNode(Node* curr, Account* newPtr) {
 
 		if (curr->right == nullptr) {
 
-			curr->right = new Node(newPtr);
+			curr->right = newNode(newPtr);
 
 			return true;
 		}
@@ -101,7 +146,8 @@ bool BSTree::insertNode(Node* curr, Account* newPtr) {
 }
 
 // Recursive helper for Retrieve, uses parameter curr to traverse
-bool BSTree::retrieveNode(Node* curr, const int& ID, Account*& acct) const {
+bool BSTree::retrieveNode(Node* curr, const long long& ID,
+						  Account*& acct) const {
 
 	if (curr != nullptr) {
 		
@@ -125,15 +171,15 @@ bool BSTree::retrieveNode(Node* curr, const int& ID, Account*& acct) const {
 }
 
 // Recursive helper for Display, uses parameter curr to traverse
-void BSTree::displayNode(Node* curr) const {
+void BSTree::displayNode(Node* curr, std::ostream& out) const {
 
 	if (curr != nullptr) {
 
-		displayNode(curr->left);
+		displayNode(curr->left, out);
 		
-		curr->acctPtr->DisplayBalances();
+		curr->acctPtr->DisplayBalances(out);
 
-		displayNode(curr->right);
+		displayNode(curr->right, out);
 	}
 
 }
@@ -152,6 +198,19 @@ void BSTree::deleteNode(Node* curr) {
 
 }
 
+// Recursive helper for Release, uses parameter curr to traverse
+void BSTree::releaseNode(Node* curr) {
+
+	if (curr != nullptr) {
+
+		releaseNode(curr->left);
+		releaseNode(curr->right);
+
+		delete curr;
+	}
+
+}
+
 // Construct Node with given pointer to Account
 BSTree::Node::Node(Account* newPtr) :acctPtr(newPtr), left(nullptr),
 													 right(nullptr) {}
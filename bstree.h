@@ -7,20 +7,29 @@
 //	-insert an Account
 //	-retrieve an Account
 //	-display info of all stored Accounts
+//	-visit the Accounts with ID numbers in a range, in ID order
 //	-clear all stored Accounts
+//	-release all stored Accounts to another owner
 //	-check if it is empty
+//
+// A BSTree given an Arena (see arena.h) takes its nodes from it & expects
+// its Accounts to live there too. It never frees them: Empty & Release only
+// forget them, in constant time, leaving the owner of the Arena to reset it.
+// A HistorySegment set on it (see historysegment.h) is given to Accounts
+// opened in it, as its Arena is.
 
 #ifndef BSTREE_H
 #define BSTREE_H
 
 #include "account.h"
+#include "arena.h"
 
 class BSTree {
 
 public:
 
-	// Constructs BSTree
-	BSTree();
+	// Constructs BSTree, taking nodes from parameter arena if not nullptr
+	explicit BSTree(Arena* arena = nullptr);
 
 	// Destroys BSTree
 	virtual ~BSTree();
@@ -31,17 +40,36 @@ public:
 
 	// Points parameter acctPtr to Account object with ID given as a parameter
 	// returns true if found, otherwise will point to nullptr then return false
-	bool Retrieve(const int& ID, Account*& acctPtr) const;
+	bool Retrieve(const long long& ID, Account*& acctPtr) const;
+
+	// Calls parameter visit with each stored Account with ID number from
+	// parameter first through parameter last, in ID order
+	template <class Visit>
+	void Scan(long long first, long long last, Visit visit) const;
 
-	// Displays info of all stored Accounts to output
-	void Display() const;
+	// Displays info of all stored Accounts to parameter out
+	void Display(std::ostream& out = std::cout) const;
 
 	// Clears all stored Accounts
 	void Empty();
 
+	// Forgets all stored Accounts without deleting them,
+	// for when another owner has taken them
+	void Release();
+
 	// Returns true if BSTree is empty, false otherwise
 	bool isEmpty() const;
 
+	// Returns Arena nodes & Accounts live in, nullptr if heap
+	Arena* GetArena() const;
+
+	// Sets parameter segment as where Accounts opened in BSTree from now
+	// on move older history, nullptr to keep it all in memory
+	void SetHistorySegment(HistorySegment* segment);
+
+	// Returns segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* GetHistorySegment() const;
+
 private:
 
 	// Nodes of BSTree
@@ -64,17 +92,70 @@ private:
 	// Root Node of BSTree
 	Node* root;
 
+	// Arena nodes & Accounts live in, nullptr if heap
+	Arena* arena;
+
+	// Segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* segment;
+
+	// Returns new Node holding parameter acctPtr
+	Node* newNode(Account* acctPtr);
+
 	// Recursive helper for Insert, uses parameter curr to traverse
 	bool insertNode(Node* curr, Account* newPtr);
 
 	// Recursive helper for Retrieve, uses parameter curr to traverse
-	bool retrieveNode(Node* curr, const int& ID, Account*& acct) const;
+	bool retrieveNode(Node* curr, const long long& ID, Account*& acct) const;
+
+	// Recursive helper for Scan, uses parameter curr to traverse
+	template <class Visit>
+	void scanNode(Node* curr, long long first, long long last,
+				  Visit& visit) const;
 
 	// Recursive helper for Display, uses parameter curr to traverse
-	void displayNode(Node* curr) const;
+	void displayNode(Node* curr, std::ostream& out) const;
 
 	// Recursive helper for Empty, uses parameter curr to traverse
 	void deleteNode(Node* curr);
 
+	// Recursive helper for Release, uses parameter curr to traverse
+	void releaseNode(Node* curr);
+
 };
+
+// Calls parameter visit with each stored Account with ID number from
+// parameter first through parameter last, in ID order
+// Uses helper method scanNode
+template <class Visit>
+void BSTree::Scan(long long first, long long last, Visit visit) const {
+
+	scanNode(root, first, last, visit);
+}
+
+// Recursive helper for Scan, uses parameter curr to traverse
+// Subtrees wholly outside the range are skipped
+template <class Visit>
+void BSTree::scanNode(Node* curr, long long first, long long last,
+					  Visit& visit) const {
+
+	if (curr != nullptr) {
+
+		long long ID(curr->acctPtr->GetID());
+
+		if (first < ID) {
+
+			scanNode(curr->left, first, last, visit);
+		}
+
+		if (first <= ID && ID <= last) {
+
+			visit(curr->acctPtr);
+		}
+
+		if (ID < last) {
+
+			scanNode(curr->right, first, last, visit);
+		}
+	}
+}
 #endif
@@ -0,0 +1,235 @@
+// concurrenttable.cpp
+// Implementations for ConcurrentTable class
+// Author: Juan Arias
+//
+// The ConcurrentTable class is a direct-indexed table for objects of the
+// Account class that many threads can use at once. Retrieve never locks,
+// Insert claims a slot with compare-and-swap & Empty deletes Accounts only
+// once no ReadGuard can still be using them.
+
+#include <functional>
+#include <thread>
+#include <vector>
+#include "concurrenttable.h"
+
+// Constructs ReadGuard over parameter table
+// Starts looking for a free reader slot at one picked by thread, so threads
+// rarely compete for the same slot
+ConcurrentTable::ReadGuard::ReadGuard(const ConcurrentTable& table)
+	:table(table), slot(std::hash<std::thread::id>()(
+							std::this_thread::get_id()) % READERS) {
+
+	for (int tries(1); ; ++tries) {
+
+		unsigned long long idle(IDLE);
+
+		if (table.readers[slot].epoch.compare_exchange_weak(idle,
+														table.epoch.load())) {
+
+			break;
+		}
+
+		slot = (slot + 1) % READERS;
+
+		if (tries % READERS == 0) {
+
+			std::this_thread::yield();
+		}
+	}
+
+	// Pairs with fence in unlinkAll: either Empty sees this guard, or
+	// lookups made under it see the Accounts already unlinked
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+// Destroys ReadGuard, letting Empty delete Accounts
+ConcurrentTable::ReadGuard::~ReadGuard() {
+
+	table.readers[slot].epoch.store(IDLE, std::memory_order_release);
+}
+
+// Constructs empty ConcurrentTable of Accounts living in parameter arena,
+// or on the heap if nullptr
+// Allocates one empty slot for every valid ID number
+ConcurrentTable::ConcurrentTable(Arena* arena)
+									:slots(new std::atomic<Account*>[CAPACITY]),
+									count(0), epoch(0), arena(arena),
+									segment(nullptr) {
+
+	for (int index(0); index < CAPACITY; ++index) {
+
+		slots[index].store(nullptr, std::memory_order_relaxed);
+	}
+
+	for (Reader& reader : readers) {
+
+		reader.epoch.store(IDLE, std::memory_order_relaxed);
+	}
+}
+
+// Destroys ConcurrentTable
+// Calls Empty to deallocate dynamic memory
+ConcurrentTable::~ConcurrentTable() {
+
+	Empty();
+}
+
+// Inserts Account object referenced by parameter acctPtr,
+// returns true if successful, false if ID is in use or out of range
+bool ConcurrentTable::Insert(Account* acctPtr) {
+
+	long long ID(acctPtr->GetID());
+
+	if (!inRange(ID)) {
+
+		return false;
+	}
+
+	Account* empty(nullptr);
+
+	if (!slots[ID - Account::MIN_ID].compare_exchange_strong(empty, acctPtr,
+												std::memory_order_acq_rel)) {
+
+		return false;
+	}
+
+	count.fetch_add(1, std::memory_order_relaxed);
+
+	return true;
+}
+
+// Points parameter acctPtr to Account object with ID given as a parameter
+// returns true if found, otherwise will point to nullptr then return false
+bool ConcurrentTable::Retrieve(const long long& ID,
+							   Account*& acctPtr) const {
+
+	acctPtr = inRange(ID) ?
+		slots[ID - Account::MIN_ID].load(std::memory_order_acquire) : nullptr;
+
+	return acctPtr != nullptr;
+}
+
+// Displays info of all stored Accounts to parameter out
+// Slots are visited in ID order, same as an inorder traversal of BSTree
+void ConcurrentTable::Display(std::ostream& out) const {
+
+	for (int index(0); index < CAPACITY; ++index) {
+
+		Account* acctPtr(slots[index].load(std::memory_order_acquire));
+
+		if (acctPtr != nullptr) {
+
+			acctPtr->DisplayBalances(out);
+		}
+	}
+}
+
+// Clears all stored Accounts
+// Waits for ReadGuards that may be using them, not for later ones
+void ConcurrentTable::Empty() {
+
+	unlinkAll(true);
+}
+
+// Forgets all stored Accounts without deleting them,
+// for when another owner has taken them
+void ConcurrentTable::Release() {
+
+	unlinkAll(false);
+}
+
+// Returns true if ConcurrentTable is empty, false otherwise
+bool ConcurrentTable::isEmpty() const {
+
+	return count.load(std::memory_order_relaxed) == 0;
+}
+
+// Returns Arena Accounts live in, nullptr if heap
+Arena* ConcurrentTable::GetArena() const {
+
+	return arena;
+}
+
+// Sets parameter segment as where Accounts opened in ConcurrentTable
+// from now on move older history, nullptr to keep it all in memory
+// Accounts already opened keep the segment they were given
+void ConcurrentTable::SetHistorySegment(HistorySegment* segment) {
+
+	this->segment = segment;
+}
+
+// Returns segment older history of new Accounts moves to, nullptr if none
+HistorySegment* ConcurrentTable::GetHistorySegment() const {
+
+	return segment;
+}
+
+// Unlinks all stored Accounts, deleting them, unless they live in an
+// Arena, if parameter owned is true once no ReadGuard can still be
+// using them
+void ConcurrentTable::unlinkAll(bool owned) {
+
+	std::vector<Account*> unlinked;
+
+	for (int index(0); index < CAPACITY; ++index) {
+
+		Account* acctPtr(slots[index].exchange(nullptr));
+
+		if (acctPtr != nullptr) {
+
+			unlinked.push_back(acctPtr);
+		}
+	}
+
+	count.fetch_sub(static_cast<int>(unlinked.size()),
+					std::memory_order_relaxed);
+
+	if (!owned || unlinked.empty()) {
+
+		return;
+	}
+
+	unsigned long long retired(epoch.fetch_add(1));
+
+	// Pairs with fence in ReadGuard
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	waitForReaders(retired);
+
+	if (arena != nullptr) {
+
+		return;
+	}
+
+	for (Account* acctPtr : unlinked) {
+
+		delete acctPtr;
+	}
+}
+
+// Waits until every held ReadGuard started after parameter retired
+void ConcurrentTable::waitForReaders(unsigned long long retired) const {
+
+	for (const Reader& reader : readers) {
+
+		for (;;) {
+
+			unsigned long long started(
+							reader.epoch.load(std::memory_order_acquire));
+
+			if (started == IDLE || started > retired) {
+
+				break;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+}
+
+// Static function
+// Returns true if parameter ID has a slot in table, false otherwise
+bool ConcurrentTable::inRange(long long ID) {
+
+	return Account::MIN_ID <= ID && ID < Account::MIN_ID + CAPACITY;
+}
@@ -0,0 +1,188 @@
+// concurrenttable.h
+// Specifications for ConcurrentTable class
+// Author: Juan Arias
+//
+// The ConcurrentTable class is a direct-indexed table for objects of the
+// Account class that many threads can use at once. Like AccountTable, every
+// valid ID number owns one slot, but slots are atomic:
+//	-Retrieve is a single atomic load, it never locks or waits
+//	-Insert claims a slot with compare-and-swap, so when two threads open
+//	 the same ID exactly one of them succeeds
+// Like AccountTable, only four digit ID numbers have a slot.
+// Readers never write shared memory while looking up, so lookups scale with
+// the number of reader threads. It has the same interface as AccountTable.
+//
+// Empty deletes Accounts other threads may still be using. A thread that
+// uses Accounts while another may call Empty holds a ReadGuard for as long
+// as it uses them. Guards record the epoch they started in; Empty unlinks
+// all Accounts, starts a new epoch, then waits only for guards from older
+// epochs to end before deleting (epoch-based reclamation). Readers are never
+// delayed by Empty, and a guard taken after the unlinking cannot see the
+// deleted Accounts. Up to READERS guards can be held at once, more wait for
+// one to end.
+//
+// A ConcurrentTable given an Arena (see arena.h) expects its Accounts to
+// live there & never deletes them: Empty still waits for older ReadGuards,
+// so the owner of the Arena may reset it once Empty returns. An Arena is
+// not thread-safe, so Accounts in one are opened by one thread at a time.
+// A HistorySegment set on it (see historysegment.h) is given to Accounts
+// opened in it, as its Arena is.
+
+#ifndef CONCURRENTTABLE_H
+#define CONCURRENTTABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "account.h"
+#include "arena.h"
+
+class ConcurrentTable {
+
+public:
+
+	// Number of slots, one for every four digit ID number
+	static const int CAPACITY = 9000;
+
+	// Number of ReadGuards that can be held at once
+	static const int READERS = 64;
+
+	// Keeps Accounts retrieved from a ConcurrentTable from being deleted
+	// while it is held
+	class ReadGuard {
+
+	public:
+
+		// Constructs ReadGuard over parameter table
+		explicit ReadGuard(const ConcurrentTable& table);
+
+		// Destroys ReadGuard, letting Empty delete Accounts
+		virtual ~ReadGuard();
+
+	private:
+
+		// Table guarded
+		const ConcurrentTable& table;
+
+		// Reader slot held in table
+		int slot;
+
+		// Disallow copying, a reader slot has a single holder
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+	};
+
+	// Constructs empty ConcurrentTable of Accounts living in parameter
+	// arena, or on the heap if nullptr
+	explicit ConcurrentTable(Arena* arena = nullptr);
+
+	// Destroys ConcurrentTable
+	virtual ~ConcurrentTable();
+
+	// Inserts Account object referenced by parameter acctPtr,
+	// returns true if successful, false if ID is in use or out of range
+	bool Insert(Account* acctPtr);
+
+	// Points parameter acctPtr to Account object with ID given as a parameter
+	// returns true if found, otherwise will point to nullptr then return false
+	bool Retrieve(const long long& ID, Account*& acctPtr) const;
+
+	// Calls parameter visit with each stored Account with ID number from
+	// parameter first through parameter last, in ID order
+	template <class Visit>
+	void Scan(long long first, long long last, Visit visit) const;
+
+	// Displays info of all stored Accounts to parameter out
+	void Display(std::ostream& out = std::cout) const;
+
+	// Clears all stored Accounts
+	void Empty();
+
+	// Forgets all stored Accounts without deleting them,
+	// for when another owner has taken them
+	void Release();
+
+	// Returns true if ConcurrentTable is empty, false otherwise
+	bool isEmpty() const;
+
+	// Returns Arena Accounts live in, nullptr if heap
+	Arena* GetArena() const;
+
+	// Sets parameter segment as where Accounts opened in ConcurrentTable
+	// from now on move older history, nullptr to keep it all in memory
+	void SetHistorySegment(HistorySegment* segment);
+
+	// Returns segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* GetHistorySegment() const;
+
+private:
+
+	// Epoch stored by a reader slot that is not held
+	static const unsigned long long IDLE = ~0ULL;
+
+	// Epoch a held ReadGuard started in, on its own cache line so
+	// readers do not slow each other down
+	struct alignas(64) Reader {
+
+		std::atomic<unsigned long long> epoch;
+
+	};
+
+	// Slots of table, slot i holds Account with ID MIN_ID + i or nullptr
+	std::unique_ptr<std::atomic<Account*>[]> slots;
+
+	// Number of stored Accounts
+	std::atomic<int> count;
+
+	// Current epoch, advanced by Empty
+	mutable std::atomic<unsigned long long> epoch;
+
+	// Reader slots of ReadGuards
+	mutable Reader readers[READERS];
+
+	// Arena Accounts live in, nullptr if heap
+	Arena* arena;
+
+	// Segment older history of new Accounts moves to, nullptr if none
+	HistorySegment* segment;
+
+	// Unlinks all stored Accounts, deleting them, unless they live in an
+	// Arena, if parameter owned is true once no ReadGuard can still be
+	// using them
+	void unlinkAll(bool owned);
+
+	// Waits until every held ReadGuard started after parameter retired
+	void waitForReaders(unsigned long long retired) const;
+
+	// Returns true if parameter ID has a slot in table, false otherwise
+	static bool inRange(long long ID);
+
+	// Disallow copying, Accounts have a single owner
+	ConcurrentTable(const ConcurrentTable&) = delete;
+	ConcurrentTable& operator=(const ConcurrentTable&) = delete;
+
+};
+
+// Calls parameter visit with each stored Account with ID number from
+// parameter first through parameter last, in ID order
+// Like Retrieve, each slot is a single atomic load
+template <class Visit>
+void ConcurrentTable::Scan(long long first, long long last,
+						   Visit visit) const {
+
+	first = std::max<long long>(first, Account::MIN_ID);
+	last  = std::min<long long>(last, Account::MIN_ID + CAPACITY - 1);
+
+	for (long long ID(first); ID <= last; ++ID) {
+
+		Account* acctPtr(slots[ID - Account::MIN_ID].load(
+												std::memory_order_acquire));
+
+		if (acctPtr != nullptr) {
+
+			visit(acctPtr);
+		}
+	}
+}
+#endif
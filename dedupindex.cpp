@@ -0,0 +1,188 @@
+// dedupindex.cpp
+// Implementations for DedupIndex class
+// Author: Juan Arias
+//
+// The DedupIndex class remembers the IDs of the most recent transactions
+// applied in a fixed size hash set, forgetting the oldest once its window
+// is full.
+
+#include <algorithm>
+#include "dedupindex.h"
+
+// Constant for a slot with no ID, defined here as it is bound to references
+const std::uint64_t DedupIndex::EMPTY;
+
+// Constructs empty DedupIndex remembering the last parameter window IDs
+DedupIndex::DedupIndex(std::size_t window) :next(0), count(0),
+											duplicates(0), largestHeld(false) {
+
+	window = (window > 0) ? window : 1;
+
+	std::size_t size(2);
+
+	while (size < 2 * window) {
+
+		size *= 2;
+	}
+
+	slots.assign(size, EMPTY);
+	order.assign(window, EMPTY);
+
+	mask = size - 1;
+}
+
+// Destroys DedupIndex
+DedupIndex::~DedupIndex() {}
+
+// Adds parameter id, forgetting the oldest if window is full,
+// returns true if id was new, false if it is remembered already
+bool DedupIndex::Insert(std::uint64_t id) {
+
+	std::uint64_t key(id + 1);
+
+	if (holds(key)) {
+
+		++duplicates;
+
+		return false;
+	}
+
+	if (count == order.size()) {
+
+		erase(order[next]);
+
+	} else {
+
+		++count;
+	}
+
+	// Found after erasing, which may move later keys into an empty slot
+	if (key == EMPTY) {
+
+		largestHeld = true;
+
+	} else {
+
+		slots[find(key)] = key;
+	}
+
+	order[next] = key;
+
+	next = (next + 1 == order.size()) ? 0 : next + 1;
+
+	return true;
+}
+
+// Returns true if parameter id is remembered, false otherwise
+bool DedupIndex::Contains(std::uint64_t id) const {
+
+	return holds(id + 1);
+}
+
+// Returns number of IDs remembered
+std::size_t DedupIndex::Size() const {
+
+	return count;
+}
+
+// Returns most IDs remembered at once
+std::size_t DedupIndex::Window() const {
+
+	return order.size();
+}
+
+// Returns number of Inserts that found their ID remembered already
+long long DedupIndex::Duplicates() const {
+
+	return duplicates;
+}
+
+// Forgets all IDs & resets count of duplicates
+void DedupIndex::Clear() {
+
+	std::fill(slots.begin(), slots.end(), EMPTY);
+	std::fill(order.begin(), order.end(), EMPTY);
+
+	next        = 0;
+	count       = 0;
+	duplicates  = 0;
+	largestHeld = false;
+}
+
+// Returns true if parameter key is remembered, false otherwise
+bool DedupIndex::holds(std::uint64_t key) const {
+
+	return (key == EMPTY) ? largestHeld : slots[find(key)] == key;
+}
+
+// Returns slot holding parameter key, or empty slot ending its probe run
+// The table is never more than half full, so an empty slot is always found
+std::size_t DedupIndex::find(std::uint64_t key) const {
+
+	std::size_t slot(hash(key) & mask);
+
+	while (slots[slot] != key && slots[slot] != EMPTY) {
+
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+// Removes parameter key from table
+// Each later key of the probe run moves back into the gap unless its home
+// slot lies cyclically after the gap, so every key stays reachable
+void DedupIndex::erase(std::uint64_t key) {
+
+	if (key == EMPTY) {
+
+		largestHeld = false;
+
+		return;
+	}
+
+	std::size_t gap(find(key));
+
+	if (slots[gap] != key) {
+
+		return;
+	}
+
+	std::size_t slot(gap);
+
+	while (true) {
+
+		slot = (slot + 1) & mask;
+
+		if (slots[slot] == EMPTY) {
+
+			break;
+		}
+
+		std::size_t home(hash(slots[slot]) & mask);
+
+		// Distance from home to slot is at least distance from gap to slot
+		if (((slot - home) & mask) >= ((slot - gap) & mask)) {
+
+			slots[gap] = slots[slot];
+
+			gap = slot;
+		}
+	}
+
+	slots[gap] = EMPTY;
+}
+
+// Static function
+// Returns hash of parameter key
+// Uses the splitmix64 finalizer, so sequential IDs spread over the table
+std::uint64_t DedupIndex::hash(std::uint64_t key) {
+
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+
+	return key;
+}
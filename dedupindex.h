@@ -0,0 +1,102 @@
+// dedupindex.h
+// Specifications for DedupIndex class
+// Author: Juan Arias
+//
+// The DedupIndex class remembers the IDs of the most recent transactions
+// applied, so a transaction sent again by a retried feed can be skipped. It
+// is a hash set of 64 bit IDs with open addressing & linear probing, plus a
+// ring holding the same IDs in the order they were added. Once it holds its
+// window of IDs, adding one more forgets the oldest (windowed expiry), so
+// memory stays fixed however many IDs pass through it:
+//	-the table has a power of two slots, at least twice the window, so
+//	 probes stay short
+//	-each remembered ID costs at most 24 bytes
+//	-checking & adding an ID takes constant time & never allocates
+// A retry is caught as long as fewer than a window of new IDs came between
+// the first copy & the retry.
+//
+// Forgotten IDs are removed by shifting later IDs of their probe run back,
+// so the table needs no tombstones & never slows down with use.
+//
+// IDs are stored plus one, so 0 can mark an empty slot. The largest ID
+// would wrap to 0, so it is remembered by a flag of its own instead.
+
+#ifndef DEDUPINDEX_H
+#define DEDUPINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class DedupIndex {
+
+public:
+
+	// IDs remembered by default
+	static const std::size_t DEFAULT_WINDOW = 1 << 20;
+
+	// Constructs empty DedupIndex remembering the last parameter window IDs
+	explicit DedupIndex(std::size_t window = DEFAULT_WINDOW);
+
+	// Destroys DedupIndex
+	virtual ~DedupIndex();
+
+	// Adds parameter id, forgetting the oldest if window is full,
+	// returns true if id was new, false if it is remembered already
+	bool Insert(std::uint64_t id);
+
+	// Returns true if parameter id is remembered, false otherwise
+	bool Contains(std::uint64_t id) const;
+
+	// Returns number of IDs remembered
+	std::size_t Size() const;
+
+	// Returns most IDs remembered at once
+	std::size_t Window() const;
+
+	// Returns number of Inserts that found their ID remembered already
+	long long Duplicates() const;
+
+	// Forgets all IDs & resets count of duplicates
+	void Clear();
+
+private:
+
+	// Constant for a slot with no ID, IDs are stored plus one
+	static const std::uint64_t EMPTY = 0;
+
+	// Slots of hash table, holding IDs plus one
+	std::vector<std::uint64_t> slots;
+
+	// Number of slots less one, masks a hash to a slot
+	std::size_t mask;
+
+	// IDs plus one in order added, oldest at next once full
+	std::vector<std::uint64_t> order;
+
+	// Position in order of next ID added
+	std::size_t next;
+
+	// Number of IDs remembered
+	std::size_t count;
+
+	// Number of Inserts that found their ID remembered already
+	long long duplicates;
+
+	// True if the largest ID, whose key is EMPTY, is remembered
+	bool largestHeld;
+
+	// Returns true if parameter key is remembered, false otherwise
+	bool holds(std::uint64_t key) const;
+
+	// Returns slot holding parameter key, or empty slot ending its probe run
+	std::size_t find(std::uint64_t key) const;
+
+	// Removes parameter key from table
+	void erase(std::uint64_t key);
+
+	// Returns hash of parameter key
+	static std::uint64_t hash(std::uint64_t key);
+
+};
+#endif
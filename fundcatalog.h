@@ -0,0 +1,98 @@
+// fundcatalog.h
+// Specifications for StandardFunds & CashFunds fund catalogs
+// Author: Juan Arias
+//
+// A fund catalog describes, at compile time, the funds held by an Account
+// of one product line (see BasicAccount in account.h). It gives:
+//	-MAX_FUNDS, the number of funds
+//	-FUNDNUM, constants for fund numbers with NONE for no fund
+//	-NAMES, the name of each fund
+//	-LINKED, the fund that covers an overdraft of each fund, NONE if none
+// An Account holds exactly MAX_FUNDS funds, so a product line with fewer
+// funds pays for fewer. Names are constant views, never built at run time.
+//
+// StandardFunds is the catalog of Account, with the following ten funds:
+//	 0: Money Market
+//	 1: Prime Money Market
+//	 2: Long-Term Bond
+//	 3: Short-Term Bond
+//	 4: 500 Index Fund
+//	 5: Capital Value Fund
+//	 6: Growth Equity Fund
+//	 7: Growth Index Fund
+//	 8: Value Fund
+//	 9: Value Stock Index
+// Money Market & Prime Money Market cover each other, as do Long-Term Bond
+// & Short-Term Bond.
+//
+// CashFunds is a catalog of two funds, Checking & Savings, covering each
+// other.
+
+#ifndef FUNDCATALOG_H
+#define FUNDCATALOG_H
+
+#include <string_view>
+
+struct StandardFunds {
+
+	// MAX number of funds
+	static const int MAX_FUNDS = 10;
+
+	// Constants to represent fund numbers
+	enum FUNDNUM {
+
+		NONE              = -1,
+		MONEY_MARKET       = 0,
+		PRIME_MONEY_MARKET = 1,
+		LONG_TERM_BOND     = 2,
+		SHORT_TERM_BOND    = 3,
+		INDEX_FUND_500     = 4,
+		CAPITAL_VALUE_FUND = 5,
+		GROWTH_EQUITY_FUND = 6,
+		GROWTH_INDEX_FUND  = 7,
+		VALUE_FUND         = 8,
+		VALUE_STOCK_INDEX  = 9
+	};
+
+	// Names of funds, indexed by fund number
+	static constexpr std::string_view NAMES[MAX_FUNDS] = {
+
+		"Money Market", "Prime Money Market", "Long-Term Bond",
+		"Short-Term Bond", "500 Index Fund", "Capital Value Fund",
+		"Growth Equity Fund", "Growth Index Fund", "Value Fund",
+		"Value Stock Index"
+	};
+
+	// Fund covering an overdraft of each fund, NONE if none
+	static constexpr int LINKED[MAX_FUNDS] = {
+
+		PRIME_MONEY_MARKET, MONEY_MARKET, SHORT_TERM_BOND, LONG_TERM_BOND,
+		NONE, NONE, NONE, NONE, NONE, NONE
+	};
+
+};
+
+struct CashFunds {
+
+	// MAX number of funds
+	static const int MAX_FUNDS = 2;
+
+	// Constants to represent fund numbers
+	enum FUNDNUM {
+
+		NONE     = -1,
+		CHECKING = 0,
+		SAVINGS  = 1
+	};
+
+	// Names of funds, indexed by fund number
+	static constexpr std::string_view NAMES[MAX_FUNDS] = {
+
+		"Checking", "Savings"
+	};
+
+	// Fund covering an overdraft of each fund, NONE if none
+	static constexpr int LINKED[MAX_FUNDS] = { SAVINGS, CHECKING };
+
+};
+#endif
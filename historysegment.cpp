@@ -0,0 +1,178 @@
+// historysegment.cpp
+// Implementations for HistorySegment class
+// Author: Juan Arias
+//
+// The HistorySegment class keeps the cold end of Account histories in an
+// append-only file, written through its descriptor & read through a
+// mapping of it.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "historysegment.h"
+
+// Constants, defined here as they may be bound to references
+const std::size_t HistorySegment::HOT_EVENTS;
+const std::uint64_t HistorySegment::NONE;
+
+// Constructs HistorySegment with no file open, keeping parameter
+// hotEvents newest events of each history in memory
+// At least one event stays in memory, so a history never spills whole
+HistorySegment::HistorySegment(std::size_t hotEvents)
+								:hotEvents(std::max<std::size_t>(hotEvents, 1)),
+								fd(-1), size(0) {}
+
+// Destroys HistorySegment, closing & removing its file
+HistorySegment::~HistorySegment() {
+
+	Close();
+}
+
+// Creates segment file with parameter fileName, truncating it if it
+// exists, returns true if successful, false otherwise
+bool HistorySegment::Open(const std::string& fileName) {
+
+	Close();
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+	if (fd < 0) {
+
+		return false;
+	}
+
+	this->fileName = fileName;
+
+	return true;
+}
+
+// Returns true if a segment file is open, false otherwise
+bool HistorySegment::IsOpen() const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return fd >= 0;
+}
+
+// Returns number of newest events of a history kept in memory
+std::size_t HistorySegment::HotEvents() const {
+
+	return hotEvents;
+}
+
+// Appends parameter bytes as an extent, returns its offset,
+// NONE if not written
+// A write cut short is cut off again, so a failed extent leaves no trace
+std::uint64_t HistorySegment::Append(std::string_view bytes) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (fd < 0) {
+
+		return NONE;
+	}
+
+	std::uint64_t offset(size);
+
+	while (!bytes.empty()) {
+
+		ssize_t written(pwrite(fd, bytes.data(), bytes.size(), size));
+
+		if (written < 0 && errno == EINTR) {
+
+			continue;
+		}
+
+		if (written <= 0) {
+
+			size = offset;
+
+			ftruncate(fd, size);
+
+			return NONE;
+		}
+
+		bytes.remove_prefix(written);
+
+		size += written;
+	}
+
+	return offset;
+}
+
+// Copies parameter size bytes at parameter offset to parameter dest,
+// returns true if successful, false if not written
+// Only a read past the end of the mapping maps the file again
+bool HistorySegment::Read(std::uint64_t offset, void* dest,
+						  std::size_t size) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (offset + size > this->size) {
+
+		return false;
+	}
+
+	std::string_view data(mapping.Data());
+
+	if (offset + size > data.size()) {
+
+		if (!mapping.Open(fileName)) {
+
+			return false;
+		}
+
+		data = mapping.Data();
+	}
+
+	std::memcpy(dest, data.data() + offset, size);
+
+	return true;
+}
+
+// Returns bytes of all extents written
+std::uint64_t HistorySegment::Size() const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return size;
+}
+
+// Forgets all extents, truncating the file
+void HistorySegment::Clear() {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	mapping.Close();
+
+	if (fd >= 0) {
+
+		ftruncate(fd, 0);
+	}
+
+	size = 0;
+}
+
+// Closes & removes segment file
+void HistorySegment::Close() {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	mapping.Close();
+
+	if (fd >= 0) {
+
+		close(fd);
+
+		unlink(fileName.c_str());
+	}
+
+	fileName.clear();
+
+	fd   = -1;
+	size = 0;
+}
@@ -0,0 +1,101 @@
+// historysegment.h
+// Specifications for HistorySegment class
+// Author: Juan Arias
+//
+// The HistorySegment class keeps the cold end of Account histories in an
+// append-only file on local disk, so the memory an Account's history takes
+// stays bounded however many transactions it has. An Account given a
+// HistorySegment keeps the newest events of each history in memory & moves
+// older ones to the segment in extents, reading them back when history is
+// displayed. It can:
+//	-create or truncate a segment file
+//	-append an extent of bytes, returning its offset
+//	-read bytes back from any offset written
+//	-clear all extents for a new run
+//
+// Extents are written through the file descriptor & read through a
+// read-only mapping of the file, which is remapped when a read reaches past
+// its end. Extents are never changed once written, so a mapped extent stays
+// valid. The file is scratch space for one process: nothing is synced &
+// numbers are in the byte order of the machine. Any number of threads may
+// append & read at once.
+
+#ifndef HISTORYSEGMENT_H
+#define HISTORYSEGMENT_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "mappedfile.h"
+
+class HistorySegment {
+
+public:
+
+	// Default number of newest events of a history kept in memory
+	static const std::size_t HOT_EVENTS = 256;
+
+	// Constant for the offset of no extent
+	static const std::uint64_t NONE = ~0ULL;
+
+	// Constructs HistorySegment with no file open, keeping parameter
+	// hotEvents newest events of each history in memory
+	explicit HistorySegment(std::size_t hotEvents = HOT_EVENTS);
+
+	// Destroys HistorySegment, closing & removing its file
+	virtual ~HistorySegment();
+
+	// Creates segment file with parameter fileName, truncating it if it
+	// exists, returns true if successful, false otherwise
+	bool Open(const std::string& fileName);
+
+	// Returns true if a segment file is open, false otherwise
+	bool IsOpen() const;
+
+	// Returns number of newest events of a history kept in memory
+	std::size_t HotEvents() const;
+
+	// Appends parameter bytes as an extent, returns its offset,
+	// NONE if not written
+	std::uint64_t Append(std::string_view bytes);
+
+	// Copies parameter size bytes at parameter offset to parameter dest,
+	// returns true if successful, false if not written
+	bool Read(std::uint64_t offset, void* dest, std::size_t size);
+
+	// Returns bytes of all extents written
+	std::uint64_t Size() const;
+
+	// Forgets all extents, truncating the file
+	void Clear();
+
+	// Closes & removes segment file
+	void Close();
+
+private:
+
+	// Number of newest events of a history kept in memory
+	const std::size_t hotEvents;
+
+	// Name of segment file, empty if none open
+	std::string fileName;
+
+	// Descriptor of segment file, -1 if none open
+	int fd;
+
+	// Bytes of all extents written
+	std::uint64_t size;
+
+	// Read-only mapping of segment file
+	MappedFile mapping;
+
+	// Guards file, size & mapping
+	mutable std::mutex lock;
+
+	// Disallow copying, a segment file has a single owner
+	HistorySegment(const HistorySegment&) = delete;
+	HistorySegment& operator=(const HistorySegment&) = delete;
+
+};
+#endif
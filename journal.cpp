@@ -0,0 +1,475 @@
+// journal.cpp
+// Implementations for Journal & JournalReader classes
+// Author: Juan Arias
+//
+// The Journal class writes journals and converts between journals and
+// transaction text files. The JournalReader class decodes Transactions from
+// a view of a whole journal, such as a MappedFile.
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include "account.h"
+#include "journal.h"
+#include "mappedfile.h"
+
+// Magic bytes at start of header
+const char Journal::MAGIC[8] = { 'B', 'A', 'N', 'K', 'J', 'N', 'L', '\0' };
+
+// Static function
+// Returns true if parameter data starts with a journal header
+bool Journal::IsJournal(std::string_view data) {
+
+	return data.size() >= HEADER_SIZE &&
+		   std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Static function
+// Returns true if file with parameter fileName is a journal
+bool Journal::IsJournal(const std::string& fileName) {
+
+	std::ifstream inFile(fileName, std::ios::binary);
+
+	char header[HEADER_SIZE];
+
+	inFile.read(header, HEADER_SIZE);
+
+	return IsJournal(std::string_view(header, inFile.gcount()));
+}
+
+// Static function
+// Writes journal header to parameter out
+void Journal::WriteHeader(std::ostream& out) {
+
+	char header[HEADER_SIZE] = {};
+
+	std::memcpy(header, MAGIC, sizeof(MAGIC));
+	std::memcpy(header + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+
+	out.write(header, HEADER_SIZE);
+}
+
+// Static function
+// Writes parameter transaction to parameter out as a record
+void Journal::Write(std::ostream& out, const Transaction& transaction) {
+
+	std::string bytes;
+
+	Encode(transaction, bytes);
+
+	out.write(bytes.data(), bytes.size());
+}
+
+// Static function
+// Appends parameter transaction as a record to parameter bytes
+void Journal::Encode(const Transaction& transaction, std::string& bytes) {
+
+	Record record = {};
+
+	bool wide(!fits(transaction.id1) || !fits(transaction.id2));
+
+	record.type  = transaction.type;
+	record.fund1 = static_cast<std::int8_t>(transaction.fund1);
+	record.fund2 = static_cast<std::int8_t>(transaction.fund2);
+	record.flags = (transaction.twoAccounts ? TWO_ACCOUNTS : 0) |
+				   (transaction.txid != Transaction::NONE ? HAS_ID : 0) |
+				   (transaction.page != '\0' ? HAS_PAGE : 0) |
+				   (wide ? WIDE_IDS : 0);
+	record.id1   = wide ? Transaction::NONE
+						: static_cast<std::int32_t>(transaction.id1);
+
+	if (transaction.type == Transaction::OPEN) {
+
+		record.amount = static_cast<std::int32_t>(transaction.lastName.size());
+		record.id2    = static_cast<std::int32_t>(transaction.firstName.size());
+
+	} else if (transaction.type == Transaction::ACCRUAL) {
+
+		record.amount = transaction.amount;
+		record.id2    = Transaction::NONE;
+
+	} else if (transaction.page != '\0') {
+
+		record.fund2  = static_cast<std::int8_t>(transaction.page);
+		record.amount = transaction.amount;
+		record.id2    = static_cast<std::int32_t>(transaction.id2);
+
+	} else {
+
+		record.amount = transaction.amount;
+		record.id2    = wide ? Transaction::NONE
+						 : static_cast<std::int32_t>(transaction.id2);
+	}
+
+	bytes.append(reinterpret_cast<const char*>(&record), RECORD_SIZE);
+
+	if (transaction.type == Transaction::OPEN) {
+
+		std::size_t length(transaction.lastName.size() +
+						   transaction.firstName.size());
+
+		bytes.append(transaction.lastName);
+		bytes.append(transaction.firstName);
+		bytes.append(padding(length), '\0');
+	}
+
+	if (transaction.type == Transaction::ACCRUAL) {
+
+		std::size_t length(transaction.amount * sizeof(std::int32_t));
+
+		for (int index(0); index < transaction.amount; ++index) {
+
+			std::int32_t rate(transaction.rates[index]);
+
+			bytes.append(reinterpret_cast<const char*>(&rate), sizeof(rate));
+		}
+
+		bytes.append(padding(length), '\0');
+	}
+
+	if (wide) {
+
+		std::int64_t ids[2] = { transaction.id1, transaction.id2 };
+
+		bytes.append(reinterpret_cast<const char*>(ids), sizeof(ids));
+	}
+
+	if (transaction.txid != Transaction::NONE) {
+
+		std::int64_t txid(transaction.txid);
+
+		bytes.append(reinterpret_cast<const char*>(&txid), sizeof(txid));
+		bytes.append(padding(sizeof(txid)), '\0');
+	}
+}
+
+// Static function
+// Fills parameter line with parameter transaction as a line of a
+// transaction text file
+void Journal::Format(const Transaction& transaction, std::string& line) {
+
+	line.clear();
+
+	if (transaction.txid != Transaction::NONE) {
+
+		line += '#';
+		line += std::to_string(transaction.txid);
+		line += ' ';
+	}
+
+	line += transaction.type;
+
+	if (transaction.type == Transaction::OPEN) {
+
+		line += ' ';
+		line += transaction.lastName;
+		line += ' ';
+		line += transaction.firstName;
+		line += ' ';
+		line += std::to_string(transaction.id1);
+
+		return;
+	}
+
+	if (transaction.type == Transaction::ACCRUAL) {
+
+		for (int index(0); index < transaction.amount; ++index) {
+
+			line += ' ';
+			line += std::to_string(transaction.rates[index]);
+		}
+
+		return;
+	}
+
+	line += ' ';
+
+	appendIdFund(line, transaction.id1, transaction.fund1,
+				 Account::MIN_ID * Account::MAX_FUNDS);
+
+	if (transaction.page != '\0') {
+
+		line += ' ';
+		line += transaction.page;
+		line += ' ';
+		line += std::to_string(transaction.amount);
+
+		if (transaction.page != Transaction::LATEST) {
+
+			line += ' ';
+			line += std::to_string(transaction.id2);
+		}
+
+		return;
+	}
+
+	if (transaction.amount != Transaction::NONE || transaction.twoAccounts) {
+
+		line += ' ';
+		line += std::to_string(transaction.amount);
+	}
+
+	if (transaction.twoAccounts) {
+
+		line += ' ';
+
+		appendIdFund(line, transaction.id2, transaction.fund2, LLONG_MIN);
+	}
+}
+
+// Static function
+// Converts transaction text file with parameter inName to journal with
+// parameter outName, returns true if successful, false otherwise
+bool Journal::TextToBinary(const std::string& inName,
+						   const std::string& outName) {
+
+	MappedFile inFile;
+
+	std::ofstream outFile(outName, std::ios::binary);
+
+	if (!inFile.Open(inName) || !outFile) {
+
+		return false;
+	}
+
+	WriteHeader(outFile);
+
+	TransactionParser parser(inFile.Data());
+
+	Transaction transaction;
+
+	while (parser.Next(transaction)) {
+
+		Write(outFile, transaction);
+	}
+
+	return static_cast<bool>(outFile.flush());
+}
+
+// Static function
+// Converts journal with parameter inName to transaction text file with
+// parameter outName, returns true if successful, false otherwise
+bool Journal::BinaryToText(const std::string& inName,
+						   const std::string& outName) {
+
+	MappedFile inFile;
+
+	std::ofstream outFile(outName, std::ios::binary);
+
+	if (!inFile.Open(inName) || !outFile) {
+
+		return false;
+	}
+
+	JournalReader reader(inFile.Data());
+
+	if (!reader.Valid()) {
+
+		return false;
+	}
+
+	Transaction transaction;
+
+	std::string line;
+
+	while (reader.Next(transaction)) {
+
+		Format(transaction, line);
+
+		outFile << line << '\n';
+	}
+
+	return static_cast<bool>(outFile.flush());
+}
+
+// Static function
+// Returns number of zero bytes padding parameter length to a record
+std::size_t Journal::padding(std::size_t length) {
+
+	return (RECORD_SIZE - length % RECORD_SIZE) % RECORD_SIZE;
+}
+
+// Static function
+// Returns true if parameter id fits in an ID number of a record,
+// false otherwise
+bool Journal::fits(long long id) {
+
+	return INT32_MIN <= id && id <= INT32_MAX;
+}
+
+// Static function
+// Appends ID number with fund digit to parameter line, in a form that
+// reads back as the same ID number & fund when a number of parameter
+// least or more is split into ID number & fund
+// Any other is written with a separator, so it can not be read as a split
+void Journal::appendIdFund(std::string& line, long long id, int fund,
+						   long long least) {
+
+	bool plain(fund == Transaction::NONE ? id < least :
+			   0 <= id && id <= (LLONG_MAX - fund) / Account::MAX_FUNDS &&
+			   id * Account::MAX_FUNDS + fund >= least);
+
+	line += std::to_string(id);
+
+	if (!plain) {
+
+		line += Transaction::SEPARATOR;
+	}
+
+	if (fund != Transaction::NONE) {
+
+		line += static_cast<char>('0' + fund);
+	}
+}
+
+// Constructs JournalReader over records of parameter input, the first
+// of them at byte parameter start
+JournalReader::JournalReader(std::string_view input, std::size_t start)
+											:input(input), pos(start) {}
+
+// Returns true if input starts with a supported journal header
+// Every version up to the current one is supported
+bool JournalReader::Valid() const {
+
+	if (!Journal::IsJournal(input)) {
+
+		return false;
+	}
+
+	std::uint32_t version;
+
+	std::memcpy(&version, input.data() + sizeof(Journal::MAGIC),
+														sizeof(version));
+
+	return 1 <= version && version <= Journal::VERSION;
+}
+
+// Decodes next record of input into parameter transaction,
+// returns true if successful, false if input is exhausted
+// Text of transaction is left empty, Journal::Format rebuilds it where
+// a line is wanted, so replay builds no strings
+bool JournalReader::Next(Transaction& transaction) {
+
+	if (pos + Journal::RECORD_SIZE > input.size()) {
+
+		return false;
+	}
+
+	Journal::Record record;
+
+	std::memcpy(&record, input.data() + pos, Journal::RECORD_SIZE);
+
+	pos += Journal::RECORD_SIZE;
+
+	transaction = Transaction();
+
+	transaction.type        = record.type;
+	transaction.id1         = record.id1;
+	transaction.fund1       = record.fund1;
+	transaction.twoAccounts = (record.flags & Journal::TWO_ACCOUNTS) != 0;
+	transaction.txid        = Transaction::NONE;
+
+	if (record.type == Transaction::OPEN) {
+
+		if (record.amount < 0 || record.id2 < 0) {
+
+			return false;
+		}
+
+		std::size_t lastLength(record.amount), firstLength(record.id2),
+					length(lastLength + firstLength);
+
+		if (pos + length > input.size()) {
+
+			return false;
+		}
+
+		transaction.lastName  = input.substr(pos, lastLength);
+		transaction.firstName = input.substr(pos + lastLength, firstLength);
+		transaction.amount    = Transaction::NONE;
+		transaction.id2       = Transaction::NONE;
+		transaction.fund2     = Transaction::NONE;
+
+		pos += length + Journal::padding(length);
+
+	} else if (record.type == Transaction::ACCRUAL) {
+
+		if (record.amount < 0 || record.amount > Transaction::MAX_RATES) {
+
+			return false;
+		}
+
+		std::size_t length(record.amount * sizeof(std::int32_t));
+
+		if (pos + length > input.size()) {
+
+			return false;
+		}
+
+		for (int index(0); index < record.amount; ++index) {
+
+			std::int32_t rate;
+
+			std::memcpy(&rate, input.data() + pos + index * sizeof(rate),
+															sizeof(rate));
+
+			transaction.rates[index] = rate;
+		}
+
+		transaction.amount = record.amount;
+		transaction.id2    = Transaction::NONE;
+		transaction.fund2  = Transaction::NONE;
+
+		pos += length + Journal::padding(length);
+
+	} else if (record.flags & Journal::HAS_PAGE) {
+
+		transaction.amount = record.amount;
+		transaction.id2    = record.id2;
+		transaction.fund2  = Transaction::NONE;
+		transaction.page   = static_cast<char>(record.fund2);
+
+	} else {
+
+		transaction.amount = record.amount;
+		transaction.id2    = record.id2;
+		transaction.fund2  = record.fund2;
+	}
+
+	if (record.flags & Journal::WIDE_IDS) {
+
+		std::int64_t ids[2];
+
+		if (pos + sizeof(ids) > input.size()) {
+
+			return false;
+		}
+
+		std::memcpy(ids, input.data() + pos, sizeof(ids));
+
+		transaction.id1 = ids[0];
+		transaction.id2 = ids[1];
+
+		pos += sizeof(ids);
+	}
+
+	if (record.flags & Journal::HAS_ID) {
+
+		std::int64_t txid;
+
+		if (pos + Journal::RECORD_SIZE > input.size()) {
+
+			return false;
+		}
+
+		std::memcpy(&txid, input.data() + pos, sizeof(txid));
+
+		transaction.txid = txid;
+
+		pos += Journal::RECORD_SIZE;
+	}
+
+	transaction.text = std::string_view();
+
+	return true;
+}
@@ -0,0 +1,155 @@
+// journal.h
+// Specifications for Journal & JournalReader classes
+// Author: Juan Arias
+//
+// A journal is a binary transaction file. Replaying it needs no text
+// parsing, each record decodes straight into a Transaction. It starts with
+// a 16 byte header:
+//	 bytes 0-7:   magic "BANKJNL" followed by a zero byte
+//	 bytes 8-11:  format version
+//	 bytes 12-15: reserved, zero
+// followed by one 16 byte record per transaction:
+//	 byte  0:     transaction type ('O', 'D', 'W', 'T', 'H' or 'A')
+//	 byte  1:     fund of first Account, -1 if none
+//	 byte  2:     fund of second Account, -1 if none, or page letter
+//	 byte  3:     flags, bit 0 set if a second Account was given, bit 1 set
+//	              if the transaction has an ID, bit 2 set if an 'H' record
+//	              shows a page of history, bit 3 set if an ID number does
+//	              not fit in 4 bytes
+//	 bytes 4-7:   ID number of first Account
+//	 bytes 8-11:  amount, length of last name for 'O', number of rates
+//	              for 'A' or first number of page for 'H'
+//	 bytes 12-15: ID number of second Account, length of first name for 'O'
+//	              or second number of page for 'H'
+// 'O' records are followed by the last then first name of the client &
+// 'A' records by their rates as 4 byte numbers, both padded with zero bytes
+// to a multiple of 16. A record with an ID number too long for 4 bytes then
+// has 16 more bytes, both ID numbers as 8 byte numbers, which replace those
+// of the record. A record of a transaction with an ID ends with 16 more
+// bytes, the ID in the first 8 & zero in the rest. Numbers are stored in
+// the byte order of the machine that wrote the journal. Version 2 added 'A'
+// records, version 3 transaction IDs, version 4 pages of history & version
+// 5 long ID numbers, journals of earlier versions are still read.
+//
+// The Journal class writes journals and converts between journals and
+// transaction text files. The JournalReader class decodes Transactions from
+// a view of a whole journal, such as a MappedFile.
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "transactionparser.h"
+
+class Journal {
+
+public:
+
+	// Size of header & of each fixed-width record in bytes
+	static const std::size_t HEADER_SIZE = 16;
+	static const std::size_t RECORD_SIZE = 16;
+
+	// Version of journal format
+	static const std::uint32_t VERSION = 5;
+
+	// Returns true if parameter data starts with a journal header
+	static bool IsJournal(std::string_view data);
+
+	// Returns true if file with parameter fileName is a journal
+	static bool IsJournal(const std::string& fileName);
+
+	// Writes journal header to parameter out
+	static void WriteHeader(std::ostream& out);
+
+	// Writes parameter transaction to parameter out as a record
+	static void Write(std::ostream& out, const Transaction& transaction);
+
+	// Appends parameter transaction as a record to parameter bytes
+	static void Encode(const Transaction& transaction, std::string& bytes);
+
+	// Fills parameter line with parameter transaction as a line of a
+	// transaction text file
+	static void Format(const Transaction& transaction, std::string& line);
+
+	// Converts transaction text file with parameter inName to journal with
+	// parameter outName, returns true if successful, false otherwise
+	static bool TextToBinary(const std::string& inName,
+							 const std::string& outName);
+
+	// Converts journal with parameter inName to transaction text file with
+	// parameter outName, returns true if successful, false otherwise
+	static bool BinaryToText(const std::string& inName,
+							 const std::string& outName);
+
+private:
+
+	// Flags for record with a second Account, with a transaction ID, with
+	// a page of history & with ID numbers too long for a record
+	static const std::uint8_t TWO_ACCOUNTS = 1;
+	static const std::uint8_t HAS_ID       = 2;
+	static const std::uint8_t HAS_PAGE     = 4;
+	static const std::uint8_t WIDE_IDS     = 8;
+
+	// Magic bytes at start of header
+	static const char MAGIC[8];
+
+	// Record as laid out in a journal
+	struct Record {
+
+		char          type;
+		std::int8_t   fund1;
+		std::int8_t   fund2;
+		std::uint8_t  flags;
+		std::int32_t  id1;
+		std::int32_t  amount;
+		std::int32_t  id2;
+
+	};
+
+	// Returns number of zero bytes padding parameter length to a record
+	static std::size_t padding(std::size_t length);
+
+	// Returns true if parameter id fits in an ID number of a record,
+	// false otherwise
+	static bool fits(long long id);
+
+	// Appends ID number with fund digit to parameter line, in a form that
+	// reads back as the same ID number & fund when a number of parameter
+	// least or more is split into ID number & fund
+	static void appendIdFund(std::string& line, long long id, int fund,
+							 long long least);
+
+	friend class JournalReader;
+
+};
+
+class JournalReader {
+
+public:
+
+	// Constructs JournalReader over records of parameter input, the first
+	// of them at byte parameter start, just past the header by default
+	explicit JournalReader(std::string_view input,
+						   std::size_t start = Journal::HEADER_SIZE);
+
+	// Returns true if input starts with a supported journal header
+	bool Valid() const;
+
+	// Decodes next record of input into parameter transaction,
+	// returns true if successful, false if input is exhausted
+	// Text of transaction is left empty
+	bool Next(Transaction& transaction);
+
+private:
+
+	// Input being decoded
+	std::string_view input;
+
+	// Position of next record to decode
+	std::size_t pos;
+
+};
+#endif
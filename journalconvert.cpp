@@ -0,0 +1,34 @@
+// journalconvert.cpp
+// Converts a transaction text file to a journal or a journal back to a
+// transaction text file, detecting the direction from the input file
+// Author: Juan Arias
+//
+// Usage: journalconvert <input file> <output file>
+
+#include <iostream>
+#include "journal.h"
+
+// Converts file named by first argument into file named by second argument
+int main(int argc, char* argv[]) {
+
+	if (argc != 3) {
+
+		std::cerr << "Usage: " << argv[0] << " <input file> <output file>"
+				  << std::endl;
+
+		return 1;
+	}
+
+	bool converted = Journal::IsJournal(std::string(argv[1])) ?
+					 Journal::BinaryToText(argv[1], argv[2]) :
+					 Journal::TextToBinary(argv[1], argv[2]);
+
+	if (!converted) {
+
+		std::cerr << "Could not convert " << argv[1] << std::endl;
+
+		return 1;
+	}
+
+	return 0;
+}
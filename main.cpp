@@ -2,7 +2,9 @@
 // Runs banking program with command line input for all files specified
 // Author: Juan Arias
 
+#include <unistd.h>
 #include "banksimulation.h"
+#include "outputsink.h"
 
 // Constant for test file name
 const char FILENAME[] = "BankTransIn.txt";
@@ -10,7 +12,9 @@ const char FILENAME[] = "BankTransIn.txt";
 // Runs simulation with specified file name
 int main() {
 
-	BankSimulation sim;
+	FileSink out(STDOUT_FILENO);
+
+	BankSimulation sim(out);
 
 	sim.Start(FILENAME);
 
@@ -0,0 +1,81 @@
+// mappedfile.cpp
+// Implementations for MappedFile class
+// Author: Juan Arias
+//
+// The MappedFile class maps a whole file read-only into memory so its
+// contents can be viewed as one std::string_view without copying. It can:
+//	-open & map a file
+//	-view the contents of the mapped file
+//	-unmap & close the file
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedfile.h"
+
+// Constructs MappedFile with nothing mapped
+MappedFile::MappedFile() :data(nullptr), size(0) {}
+
+// Destroys MappedFile, unmapping any mapped file
+MappedFile::~MappedFile() {
+
+	Close();
+}
+
+// Maps file with parameter fileName,
+// returns true if successful, false otherwise
+// An empty file opens successfully with nothing mapped
+bool MappedFile::Open(const std::string& fileName) {
+
+	Close();
+
+	int fd(open(fileName.c_str(), O_RDONLY));
+
+	if (fd < 0) {
+
+		return false;
+	}
+
+	struct stat info;
+
+	bool opened(fstat(fd, &info) == 0);
+
+	if (opened && info.st_size > 0) {
+
+		void* addr(mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+
+		opened = (addr != MAP_FAILED);
+
+		if (opened) {
+
+			data = static_cast<char*>(addr);
+			size = info.st_size;
+
+			madvise(addr, size, MADV_SEQUENTIAL);
+		}
+	}
+
+	// Mapping stays valid after its descriptor is closed
+	close(fd);
+
+	return opened;
+}
+
+// Returns view of contents of mapped file, empty if nothing is mapped
+std::string_view MappedFile::Data() const {
+
+	return std::string_view(data, size);
+}
+
+// Unmaps & closes mapped file
+void MappedFile::Close() {
+
+	if (data != nullptr) {
+
+		munmap(data, size);
+	}
+
+	data = nullptr;
+	size = 0;
+}
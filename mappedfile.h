@@ -0,0 +1,50 @@
+// mappedfile.h
+// Specifications for MappedFile class
+// Author: Juan Arias
+//
+// The MappedFile class maps a whole file read-only into memory so its
+// contents can be viewed as one std::string_view without copying. It can:
+//	-open & map a file
+//	-view the contents of the mapped file
+//	-unmap & close the file
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+
+class MappedFile {
+
+public:
+
+	// Constructs MappedFile with nothing mapped
+	MappedFile();
+
+	// Destroys MappedFile, unmapping any mapped file
+	virtual ~MappedFile();
+
+	// Maps file with parameter fileName,
+	// returns true if successful, false otherwise
+	bool Open(const std::string& fileName);
+
+	// Returns view of contents of mapped file, empty if nothing is mapped
+	std::string_view Data() const;
+
+	// Unmaps & closes mapped file
+	void Close();
+
+private:
+
+	// Start of mapped memory, nullptr if nothing is mapped
+	char* data;
+
+	// Size of mapped memory in bytes
+	std::size_t size;
+
+	// Disallow copying, a mapping has a single owner
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+};
+#endif
@@ -0,0 +1,158 @@
+// outputsink.cpp
+// Implementations for FileSink, MemorySink & DiscardSink classes
+// Author: Juan Arias
+//
+// Output sinks are output streams that BankSimulation & Account can print
+// to instead of std::cout:
+//	-FileSink collects output in a large buffer & writes it to a file
+//	 descriptor only when the buffer fills or the sink is flushed
+//	-MemorySink keeps all output in memory, for tests
+//	-DiscardSink throws all output away, for benchmarks
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "outputsink.h"
+
+// Constructs FileSink writing to open file descriptor parameter fd,
+// which stays open after the FileSink is destroyed
+FileSink::FileSink(int fd) :std::ostream(nullptr), buffer(fd, false) {
+
+	rdbuf(&buffer);
+}
+
+// Constructs FileSink writing to new file with parameter fileName
+FileSink::FileSink(const std::string& fileName) :std::ostream(nullptr),
+	buffer(::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644), true) {
+
+	rdbuf(&buffer);
+
+	if (!IsOpen()) {
+
+		setstate(std::ios::badbit);
+	}
+}
+
+// Destroys FileSink, writing anything left in buffer
+FileSink::~FileSink() {
+
+	flush();
+}
+
+// Returns true if file was opened, false otherwise
+bool FileSink::IsOpen() const {
+
+	return buffer.Descriptor() >= 0;
+}
+
+// Constructs Buffer writing to parameter fd, closing it
+// when destroyed if parameter owned is true
+FileSink::Buffer::Buffer(int fd, bool owned) :fd(fd), owned(owned),
+											  memory(BUFFER_SIZE) {
+
+	setp(memory.data(), memory.data() + memory.size());
+}
+
+// Destroys Buffer, writing anything left
+FileSink::Buffer::~Buffer() {
+
+	drain();
+
+	if (owned && fd >= 0) {
+
+		::close(fd);
+	}
+}
+
+// Returns file descriptor, negative if none
+int FileSink::Buffer::Descriptor() const {
+
+	return fd;
+}
+
+// Writes full buffer then stores parameter c
+int FileSink::Buffer::overflow(int c) {
+
+	if (!drain()) {
+
+		return traits_type::eof();
+	}
+
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+
+		*pptr() = traits_type::to_char_type(c);
+
+		pbump(1);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+// Writes everything in buffer
+int FileSink::Buffer::sync() {
+
+	return drain() ? 0 : -1;
+}
+
+// Writes everything in buffer, returns false if write failed
+bool FileSink::Buffer::drain() {
+
+	const char* next(pbase());
+
+	while (next < pptr()) {
+
+		ssize_t written(::write(fd, next, pptr() - next));
+
+		if (written < 0 && errno == EINTR) {
+
+			continue;
+		}
+
+		if (written <= 0) {
+
+			return false;
+		}
+
+		next += written;
+	}
+
+	setp(memory.data(), memory.data() + memory.size());
+
+	return true;
+}
+
+// Constructs empty MemorySink
+MemorySink::MemorySink() :std::ostream(nullptr) {
+
+	rdbuf(&buffer);
+}
+
+// Returns everything written to sink
+std::string MemorySink::Str() const {
+
+	return buffer.str();
+}
+
+// Discards everything written to sink
+void MemorySink::Clear() {
+
+	buffer.str("");
+}
+
+// Constructs DiscardSink
+DiscardSink::DiscardSink() :std::ostream(nullptr) {
+
+	rdbuf(&buffer);
+}
+
+// Discards parameter c
+int DiscardSink::Buffer::overflow(int c) {
+
+	return traits_type::not_eof(c);
+}
+
+// Discards parameter count characters
+std::streamsize DiscardSink::Buffer::xsputn(const char*,
+											std::streamsize count) {
+	return count;
+}
@@ -0,0 +1,138 @@
+// outputsink.h
+// Specifications for FileSink, MemorySink & DiscardSink classes
+// Author: Juan Arias
+//
+// Output sinks are output streams that BankSimulation & Account can print
+// to instead of std::cout:
+//	-FileSink collects output in a large buffer & writes it to a file
+//	 descriptor only when the buffer fills or the sink is flushed
+//	-MemorySink keeps all output in memory, for tests
+//	-DiscardSink throws all output away, for benchmarks
+//
+// Output is ended with '\n' rather than std::endl, so nothing is written
+// to a FileSink's file until its buffer is full. Everything left in the
+// buffer is written when the FileSink is flushed or destroyed.
+
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+class FileSink : public std::ostream {
+
+public:
+
+	// Size of buffer in bytes
+	static const std::size_t BUFFER_SIZE = 1 << 20;
+
+	// Constructs FileSink writing to open file descriptor parameter fd,
+	// which stays open after the FileSink is destroyed
+	explicit FileSink(int fd);
+
+	// Constructs FileSink writing to new file with parameter fileName
+	explicit FileSink(const std::string& fileName);
+
+	// Destroys FileSink, writing anything left in buffer
+	virtual ~FileSink();
+
+	// Returns true if file was opened, false otherwise
+	bool IsOpen() const;
+
+private:
+
+	// Stream buffer writing to a file descriptor in large blocks
+	class Buffer : public std::streambuf {
+
+	public:
+
+		// Constructs Buffer writing to parameter fd, closing it
+		// when destroyed if parameter owned is true
+		Buffer(int fd, bool owned);
+
+		// Destroys Buffer, writing anything left
+		virtual ~Buffer();
+
+		// Returns file descriptor, negative if none
+		int Descriptor() const;
+
+	protected:
+
+		// Writes full buffer then stores parameter c
+		int overflow(int c) override;
+
+		// Writes everything in buffer
+		int sync() override;
+
+	private:
+
+		// File descriptor written to
+		int fd;
+
+		// True if file descriptor is closed by Buffer
+		bool owned;
+
+		// Memory for buffered output
+		std::vector<char> memory;
+
+		// Writes everything in buffer, returns false if write failed
+		bool drain();
+
+	};
+
+	// Stream buffer of sink
+	Buffer buffer;
+
+};
+
+class MemorySink : public std::ostream {
+
+public:
+
+	// Constructs empty MemorySink
+	MemorySink();
+
+	// Returns everything written to sink
+	std::string Str() const;
+
+	// Discards everything written to sink
+	void Clear();
+
+private:
+
+	// Stream buffer holding output
+	std::stringbuf buffer;
+
+};
+
+class DiscardSink : public std::ostream {
+
+public:
+
+	// Constructs DiscardSink
+	DiscardSink();
+
+private:
+
+	// Stream buffer that discards everything written to it
+	class Buffer : public std::streambuf {
+
+	protected:
+
+		// Discards parameter c
+		int overflow(int c) override;
+
+		// Discards parameter count characters
+		std::streamsize xsputn(const char* text, std::streamsize count)
+																	override;
+
+	};
+
+	// Stream buffer of sink
+	Buffer buffer;
+
+};
+#endif
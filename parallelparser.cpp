@@ -0,0 +1,154 @@
+// parallelparser.cpp
+// Implementations for ParallelParser class
+// Author: Juan Arias
+//
+// The ParallelParser class decodes chunks of a transaction file on worker
+// threads & applies them in input order on the thread calling Run. Output
+// is the same as a serial run.
+
+#include <thread>
+#include "banksimulation.h"
+#include "parallelparser.h"
+
+// Constants, defined here as they may be bound to references
+const std::size_t ParallelParser::CHUNK_SIZE;
+const std::size_t ParallelParser::CHUNKS_PER_THREAD;
+
+// Constructs ParallelParser applying transactions to parameter simulation,
+// decoding on parameter threads worker threads
+ParallelParser::ParallelParser(BankSimulation& simulation, int threads)
+								:simulation(simulation),
+								threads((threads > 0) ? threads : 1),
+								chunks(0), next(0), applied(0) {}
+
+// Destroys ParallelParser
+ParallelParser::~ParallelParser() {}
+
+// Runs every transaction of parameter input
+// Buffers keep their storage between chunks, so once the window has gone
+// round once decoding allocates nothing
+void ParallelParser::Run(std::string_view input) {
+
+	this->input = input;
+
+	chunks  = (input.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	next    = 0;
+	applied = 0;
+
+	buffers.resize(threads * CHUNKS_PER_THREAD);
+
+	for (Buffer& buffer : buffers) {
+
+		buffer.ready = false;
+	}
+
+	std::vector<std::thread> workers;
+
+	for (int worker(0); worker < threads; ++worker) {
+
+		workers.emplace_back(&ParallelParser::decode, this);
+	}
+
+	for (std::size_t index(0); index < chunks; ++index) {
+
+		Buffer& buffer(buffers[index % buffers.size()]);
+
+		{
+			std::unique_lock<std::mutex> guard(lock);
+
+			decoded.wait(guard, [&buffer]() { return buffer.ready; });
+		}
+
+		for (const Transaction& transaction : buffer.transactions) {
+
+			simulation.apply(transaction);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			buffer.ready = false;
+
+			++applied;
+		}
+
+		freed.notify_all();
+	}
+
+	for (std::thread& worker : workers) {
+
+		worker.join();
+	}
+}
+
+// Decodes chunks until all are taken, run by each worker thread
+// A chunk is taken only once the chunk a window before it is applied, as
+// both use the same buffer
+void ParallelParser::decode() {
+
+	for (;;) {
+
+		std::size_t index;
+
+		{
+			std::unique_lock<std::mutex> guard(lock);
+
+			freed.wait(guard, [this]() {
+
+				return next >= chunks || next < applied + buffers.size();
+			});
+
+			if (next >= chunks) {
+
+				return;
+			}
+
+			index = next++;
+		}
+
+		Buffer& buffer(buffers[index % buffers.size()]);
+
+		std::size_t start(chunkStart(index));
+
+		TransactionParser parser(input.substr(start,
+											  chunkStart(index + 1) - start));
+
+		buffer.transactions.clear();
+		buffer.transactions.emplace_back();
+
+		while (parser.Next(buffer.transactions.back())) {
+
+			buffer.transactions.emplace_back();
+		}
+
+		buffer.transactions.pop_back();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			buffer.ready = true;
+		}
+
+		decoded.notify_one();
+	}
+}
+
+// Returns position of first line of chunk parameter index
+// A chunk starts just past the first line break at or after the byte
+// before its nominal start, so a line ending exactly there begins it
+std::size_t ParallelParser::chunkStart(std::size_t index) const {
+
+	if (index == 0) {
+
+		return 0;
+	}
+
+	if (index >= chunks) {
+
+		return input.size();
+	}
+
+	std::size_t lineEnd(input.find('\n', index * CHUNK_SIZE - 1));
+
+	return (lineEnd == std::string_view::npos) ? input.size() : lineEnd + 1;
+}
@@ -0,0 +1,104 @@
+// parallelparser.h
+// Specifications for ParallelParser class
+// Author: Juan Arias
+//
+// The ParallelParser class decodes a transaction file on several threads
+// while still applying its transactions one at a time in input order. The
+// file is viewed whole, such as from a MappedFile, & cut into chunks of
+// about CHUNK_SIZE bytes, each ending at a line break:
+//	-worker threads each take the next chunk not yet taken & decode it
+//	 into a buffer of Transactions, which view the file's text
+//	-the thread calling Run applies the buffers to a BankSimulation in
+//	 chunk order, waiting for a chunk if it is not decoded yet
+//
+// Each chunk finds its own first line by looking back one byte from where
+// it would start for a line break, so no thread scans another's chunk &
+// no line is split or decoded twice. Workers stay at most a window of
+// CHUNKS_PER_THREAD chunks per thread ahead of the chunk being applied,
+// whose buffers are reused, so memory does not grow with the size of the
+// file. The thread calling Run is the only one touching Accounts, so output
+// is the same as a serial run.
+
+#ifndef PARALLELPARSER_H
+#define PARALLELPARSER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "transactionparser.h"
+
+class BankSimulation;
+
+class ParallelParser {
+
+public:
+
+	// Bytes of file in a chunk, before moving its end to a line break
+	static const std::size_t CHUNK_SIZE = 1 << 18;
+
+	// Chunks each worker thread may decode ahead of the one being applied
+	static const std::size_t CHUNKS_PER_THREAD = 2;
+
+	// Constructs ParallelParser applying transactions to parameter
+	// simulation, decoding on parameter threads worker threads
+	ParallelParser(BankSimulation& simulation, int threads);
+
+	// Destroys ParallelParser
+	virtual ~ParallelParser();
+
+	// Runs every transaction of parameter input
+	void Run(std::string_view input);
+
+private:
+
+	// Transactions decoded from a chunk, reused for each chunk after it
+	// in the window
+	struct Buffer {
+
+		std::vector<Transaction> transactions;
+
+		// True once transactions hold the chunk to apply next from buffer
+		bool ready;
+
+	};
+
+	// Simulation transactions are applied to
+	BankSimulation& simulation;
+
+	// Number of worker threads
+	int threads;
+
+	// Input being run
+	std::string_view input;
+
+	// Number of chunks input is cut into
+	std::size_t chunks;
+
+	// One buffer per chunk of the window, chunk i uses buffer i modulo
+	// its size
+	std::vector<Buffer> buffers;
+
+	// Index of next chunk to decode & number of chunks applied
+	std::size_t next;
+	std::size_t applied;
+
+	// Guards buffers' ready flags, next & applied
+	std::mutex lock;
+
+	// Signaled when a chunk is decoded & when one is applied
+	std::condition_variable decoded;
+	std::condition_variable freed;
+
+	// Decodes chunks until all are taken, run by each worker thread
+	void decode();
+
+	// Returns position of first line of chunk parameter index
+	std::size_t chunkStart(std::size_t index) const;
+
+	// Disallow copying, a ParallelParser refers to its simulation
+	ParallelParser(const ParallelParser&) = delete;
+	ParallelParser& operator=(const ParallelParser&) = delete;
+
+};
+#endif
@@ -0,0 +1,169 @@
+// pipeline.cpp
+// Implementations for Pipeline class
+// Author: Juan Arias
+//
+// The Pipeline class runs a transaction file through a reader, a parser &
+// an executor stage, each on its own thread, joined by SpscRings. Output is
+// the same as a serial run.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include "banksimulation.h"
+#include "pipeline.h"
+
+// Constructs Pipeline applying transactions to parameter simulation
+Pipeline::Pipeline(BankSimulation& simulation) :simulation(simulation),
+												counters() {}
+
+// Destroys Pipeline
+Pipeline::~Pipeline() {}
+
+// Runs every transaction of file with parameter fileName
+void Pipeline::Run(const std::string& fileName) {
+
+	counters = Counters();
+
+	SpscRing<Block> blocks(RING_BLOCKS), parsed(RING_BLOCKS);
+
+	std::thread reader(&Pipeline::read, this, std::cref(fileName),
+					   std::ref(blocks));
+	std::thread parser(&Pipeline::parse, this, std::ref(blocks),
+					   std::ref(parsed));
+
+	execute(parsed);
+
+	reader.join();
+	parser.join();
+
+	counters.reader.outputStalls   = blocks.FullStalls();
+	counters.parser.inputStalls    = blocks.EmptyStalls();
+	counters.parser.outputStalls   = parsed.FullStalls();
+	counters.executor.inputStalls  = parsed.EmptyStalls();
+	counters.readOccupancy         = blocks.MeanOccupancy();
+	counters.parsedOccupancy       = parsed.MeanOccupancy();
+}
+
+// Returns measurements of last run
+const Pipeline::Counters& Pipeline::GetCounters() const {
+
+	return counters;
+}
+
+// Reads file with parameter fileName into parameter blocks
+// A line left unfinished at the end of a block is carried to the next one,
+// so no line is split between blocks
+void Pipeline::read(const std::string& fileName, SpscRing<Block>& blocks) {
+
+	std::ifstream inFile(fileName, std::ios::binary);
+
+	std::vector<char> carried;
+
+	bool more(static_cast<bool>(inFile));
+
+	while (more) {
+
+		std::chrono::steady_clock::time_point start(
+											std::chrono::steady_clock::now());
+
+		Block block;
+
+		block.text.swap(carried);
+
+		std::size_t kept(block.text.size());
+
+		block.text.resize(kept + BLOCK_SIZE);
+
+		inFile.read(block.text.data() + kept, BLOCK_SIZE);
+
+		block.text.resize(kept + inFile.gcount());
+
+		more = static_cast<bool>(inFile);
+
+		if (more) {
+
+			std::vector<char>::reverse_iterator lineEnd(
+					std::find(block.text.rbegin(), block.text.rend(), '\n'));
+
+			carried.assign(lineEnd.base(), block.text.end());
+
+			block.text.erase(lineEnd.base(), block.text.end());
+		}
+
+		counters.reader.busyNanoseconds += nanosecondsSince(start);
+
+		if (!block.text.empty()) {
+
+			++counters.reader.blocks;
+
+			blocks.Push(std::move(block));
+		}
+	}
+
+	blocks.Close();
+}
+
+// Decodes each block of parameter blocks into parameter parsed
+void Pipeline::parse(SpscRing<Block>& blocks, SpscRing<Block>& parsed) {
+
+	Block block;
+
+	while (blocks.Pop(block)) {
+
+		std::chrono::steady_clock::time_point start(
+											std::chrono::steady_clock::now());
+
+		TransactionParser parser(std::string_view(block.text.data(),
+												  block.text.size()));
+
+		block.transactions.emplace_back();
+
+		while (parser.Next(block.transactions.back())) {
+
+			block.transactions.emplace_back();
+		}
+
+		block.transactions.pop_back();
+
+		counters.parser.busyNanoseconds += nanosecondsSince(start);
+
+		++counters.parser.blocks;
+
+		parsed.Push(std::move(block));
+
+		block = Block();
+	}
+
+	parsed.Close();
+}
+
+// Applies transactions of each block of parameter parsed
+void Pipeline::execute(SpscRing<Block>& parsed) {
+
+	Block block;
+
+	while (parsed.Pop(block)) {
+
+		std::chrono::steady_clock::time_point start(
+											std::chrono::steady_clock::now());
+
+		for (const Transaction& transaction : block.transactions) {
+
+			simulation.apply(transaction);
+		}
+
+		counters.executor.busyNanoseconds += nanosecondsSince(start);
+
+		++counters.executor.blocks;
+	}
+}
+
+// Static function
+// Returns nanoseconds from parameter start to now
+long long Pipeline::nanosecondsSince(
+						std::chrono::steady_clock::time_point start) {
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,119 @@
+// pipeline.h
+// Specifications for Pipeline class
+// Author: Juan Arias
+//
+// The Pipeline class runs a transaction file through three stages, each on
+// its own thread:
+//	-the reader reads the file in large blocks, each ending at a line break
+//	-the parser decodes each block into Transactions
+//	-the executor, the thread calling Run, applies them to a BankSimulation
+// Stages are joined by SpscRings (see spscring.h) of a few blocks each, so
+// a stage that gets ahead waits for the next one rather than filling
+// memory. Blocks pass through the rings in file order & the executor is
+// the only stage touching Accounts, so transactions run in input order &
+// output is the same as a serial run.
+//
+// After a run, Counters tells, for each stage, how many blocks it handled,
+// how long it spent working & how often it waited on the stage before or
+// after it, with how full each ring was on average. The stage that is busy
+// the longest & waits the least is the bottleneck.
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "spscring.h"
+#include "transactionparser.h"
+
+class BankSimulation;
+
+class Pipeline {
+
+public:
+
+	// Measurements of one stage
+	struct Stage {
+
+		// Blocks handled
+		long long blocks;
+
+		// Nanoseconds spent working, not waiting
+		long long busyNanoseconds;
+
+		// Times stage waited for a block from the stage before it
+		long long inputStalls;
+
+		// Times stage waited for room in the ring to the stage after it
+		long long outputStalls;
+
+	};
+
+	// Measurements of a whole run
+	struct Counters {
+
+		Stage reader;
+		Stage parser;
+		Stage executor;
+
+		// Mean blocks waiting in ring from reader & ring from parser
+		double readOccupancy;
+		double parsedOccupancy;
+
+	};
+
+	// Bytes read from file at a time
+	static const std::size_t BLOCK_SIZE = 1 << 16;
+
+	// Blocks each ring can hold
+	static const std::size_t RING_BLOCKS = 8;
+
+	// Constructs Pipeline applying transactions to parameter simulation
+	explicit Pipeline(BankSimulation& simulation);
+
+	// Destroys Pipeline
+	virtual ~Pipeline();
+
+	// Runs every transaction of file with parameter fileName
+	void Run(const std::string& fileName);
+
+	// Returns measurements of last run
+	const Counters& GetCounters() const;
+
+private:
+
+	// Whole lines of file & Transactions decoded from them, which view
+	// text, whose storage stays put when a Block is moved
+	struct Block {
+
+		std::vector<char> text;
+		std::vector<Transaction> transactions;
+
+	};
+
+	// Simulation transactions are applied to
+	BankSimulation& simulation;
+
+	// Measurements of last run
+	Counters counters;
+
+	// Reads file with parameter fileName into parameter blocks
+	void read(const std::string& fileName, SpscRing<Block>& blocks);
+
+	// Decodes each block of parameter blocks into parameter parsed
+	void parse(SpscRing<Block>& blocks, SpscRing<Block>& parsed);
+
+	// Applies transactions of each block of parameter parsed
+	void execute(SpscRing<Block>& parsed);
+
+	// Returns nanoseconds from parameter start to now
+	static long long nanosecondsSince(
+						std::chrono::steady_clock::time_point start);
+
+	// Disallow copying, a Pipeline refers to its simulation
+	Pipeline(const Pipeline&) = delete;
+	Pipeline& operator=(const Pipeline&) = delete;
+
+};
+#endif
@@ -0,0 +1,449 @@
+// shardedengine.cpp
+// Implementations for ShardedEngine class
+// Author: Juan Arias
+//
+// The ShardedEngine class runs transactions on several worker threads.
+// Accounts are split into shards by ID number and each shard is owned by
+// one worker, which alone opens, reads & changes its Accounts. Output
+// matches a serial run exactly.
+
+#include <algorithm>
+#include "shardedengine.h"
+
+// Constructs ShardedEngine with parameter count shards, shard i opening
+// Accounts in Arena i of parameter arenas, which gets more Arenas if
+// needed, or on the heap if nullptr, moving their older history to
+// parameter segment if not nullptr
+ShardedEngine::ShardedEngine(int count,
+							 std::vector<std::unique_ptr<Arena>>* arenas,
+							 HistorySegment* segment) {
+
+	count = std::max(count, 1);
+
+	for (int index(0); index < count; ++index) {
+
+		Arena* arena(nullptr);
+
+		if (arenas != nullptr) {
+
+			if (arenas->size() == static_cast<std::size_t>(index)) {
+
+				arenas->emplace_back(new Arena());
+			}
+
+			arena = (*arenas)[index].get();
+		}
+
+		shards.emplace_back(new Shard(arena, segment));
+	}
+}
+
+// Destroys ShardedEngine, deleting Accounts it still owns
+ShardedEngine::~ShardedEngine() {}
+
+// Runs every transaction decoded by parameter parser whose ID is not
+// in parameter dedup, printing output to parameter out as it goes
+void ShardedEngine::Run(TransactionParser& parser, std::ostream& out,
+						DedupIndex& dedup) {
+
+	for (std::size_t index(0); index < shards.size(); ++index) {
+
+		shards[index]->closed = false;
+		shards[index]->worker = std::thread(&ShardedEngine::work, this, index);
+	}
+
+	std::vector<std::vector<Item>> pending(shards.size());
+
+	std::size_t round(BATCH_SIZE * shards.size()), routed(0);
+
+	Transaction transaction;
+
+	for (long long seq(0); parser.Next(transaction); ++seq) {
+
+		if (transaction.txid != Transaction::NONE &&
+			!dedup.Insert(transaction.txid)) {
+
+			continue;
+		}
+
+		if (transaction.type == Transaction::ACCRUAL) {
+
+			broadcast(pending, seq, transaction);
+
+			continue;
+		}
+
+		bool twoAccounts(transaction.type != Transaction::OPEN &&
+						 (transaction.twoAccounts ||
+						  transaction.type == Transaction::TRANSFER));
+
+		std::size_t owner1(owner(transaction.id1)),
+					owner2(twoAccounts ? owner(transaction.id2) : owner1);
+
+		if (owner1 == owner2) {
+
+			pending[owner1].push_back({ seq, transaction, LOCAL, nullptr });
+
+		} else {
+
+			Handoff* handoff = new Handoff();
+
+			pending[owner1].push_back({ seq, transaction, SOURCE, handoff });
+			pending[owner2].push_back({ seq, transaction, DESTINATION,
+																  handoff });
+		}
+
+		// Batches of a round are all sent before any of the next round,
+		// so a shard never waits on a transaction still held here
+		if (++routed == round) {
+
+			flush(pending);
+
+			write(out);
+
+			routed = 0;
+		}
+	}
+
+	flush(pending);
+
+	for (std::unique_ptr<Shard>& shard : shards) {
+
+		{
+			std::lock_guard<std::mutex> guard(shard->lock);
+
+			shard->closed = true;
+		}
+
+		shard->changed.notify_all();
+		shard->worker.join();
+	}
+
+	write(out);
+
+	out.flush();
+}
+
+// Moves all opened Accounts into parameter registry, shard by shard
+// Each shard's Accounts go in ID order
+void ShardedEngine::MoveAccounts(AccountRegistry& registry) {
+
+	for (std::unique_ptr<Shard>& shard : shards) {
+
+		shard->accounts.Scan(Account::MIN_ID, Account::MAX_ID,
+							 [&registry](Account* acctPtr) {
+
+			registry.Insert(acctPtr);
+		});
+
+		shard->accounts.Release();
+	}
+}
+
+// Adds accrual parameter transaction with position parameter seq to
+// parameter pending of every shard, as it changes Accounts of all of them
+// An accrual that will be refused goes to one shard, to print its error
+// once
+void ShardedEngine::broadcast(std::vector<std::vector<Item>>& pending,
+							  long long seq, const Transaction& transaction) {
+
+	int rates[Account::MAX_FUNDS];
+
+	std::size_t count(BankSimulation::accrualRates(transaction, rates) ?
+													shards.size() : 1);
+
+	for (std::size_t index(0); index < count; ++index) {
+
+		pending[index].push_back({ seq, transaction, LOCAL, nullptr });
+	}
+}
+
+// Returns index of shard owning Account with parameter id
+std::size_t ShardedEngine::owner(long long id) const {
+
+	return static_cast<unsigned long long>(id) % shards.size();
+}
+
+// Sends every pending batch in parameter pending to its shard, even
+// empty, as one round
+// Every shard gets a batch, so the batches a shard runs count its rounds
+void ShardedEngine::flush(std::vector<std::vector<Item>>& pending) {
+
+	for (std::size_t index(0); index < shards.size(); ++index) {
+
+		push(*shards[index], pending[index]);
+	}
+}
+
+// Writes output of every round all shards have run to parameter out,
+// in input order
+// Never waits for a shard, rounds still running are written by a later call
+void ShardedEngine::write(std::ostream& out) {
+
+	std::vector<Round> rounds(shards.size());
+
+	std::vector<Segment> segments;
+
+	for (;;) {
+
+		for (std::unique_ptr<Shard>& shard : shards) {
+
+			std::lock_guard<std::mutex> guard(shard->lock);
+
+			if (shard->done.empty()) {
+
+				return;
+			}
+		}
+
+		segments.clear();
+
+		for (std::size_t index(0); index < shards.size(); ++index) {
+
+			{
+				std::lock_guard<std::mutex> guard(shards[index]->lock);
+
+				rounds[index] = std::move(shards[index]->done.front());
+
+				shards[index]->done.pop_front();
+			}
+
+			segments.insert(segments.end(), rounds[index].segments.begin(),
+											rounds[index].segments.end());
+		}
+
+		std::sort(segments.begin(), segments.end(),
+				  [](const Segment& a, const Segment& b) {
+
+			return (a.seq != b.seq) ? a.seq < b.seq : a.role < b.role;
+		});
+
+		for (const Segment& segment : segments) {
+
+			out.write(rounds[segment.shard].text.data() + segment.begin,
+					  segment.end - segment.begin);
+		}
+	}
+}
+
+// Adds parameter batch to queue of parameter shard,
+// waiting while the queue is full
+void ShardedEngine::push(Shard& shard, std::vector<Item>& batch) {
+
+	std::unique_lock<std::mutex> guard(shard.lock);
+
+	shard.changed.wait(guard, [&shard]() {
+
+		return shard.queue.size() < QUEUE_BATCHES;
+	});
+
+	shard.queue.push_back(std::move(batch));
+
+	batch.clear();
+
+	guard.unlock();
+
+	shard.changed.notify_all();
+}
+
+// Takes next batch of parameter shard into parameter batch,
+// returns false once the shard is closed & drained
+bool ShardedEngine::pop(Shard& shard, std::vector<Item>& batch) {
+
+	std::unique_lock<std::mutex> guard(shard.lock);
+
+	shard.changed.wait(guard, [&shard]() {
+
+		return !shard.queue.empty() || shard.closed;
+	});
+
+	if (shard.queue.empty()) {
+
+		return false;
+	}
+
+	batch = std::move(shard.queue.front());
+
+	shard.queue.pop_front();
+
+	guard.unlock();
+
+	shard.changed.notify_all();
+
+	return true;
+}
+
+// Runs every batch sent to shard with parameter index
+// Each batch's output is handed over as a round once it is run
+void ShardedEngine::work(int index) {
+
+	Shard& shard(*shards[index]);
+
+	std::vector<Item> batch;
+
+	while (pop(shard, batch)) {
+
+		for (const Item& item : batch) {
+
+			std::size_t begin(shard.out.tellp());
+
+			execute(shard, item);
+
+			std::size_t end(shard.out.tellp());
+
+			if (end != begin) {
+
+				shard.segments.push_back({ item.seq, item.role, index,
+														begin, end });
+			}
+		}
+
+		Round round;
+
+		round.text = shard.out.str();
+		round.segments.swap(shard.segments);
+
+		shard.out.str("");
+
+		std::lock_guard<std::mutex> guard(shard.lock);
+
+		shard.done.push_back(std::move(round));
+	}
+}
+
+// Runs parameter item on parameter shard
+void ShardedEngine::execute(Shard& shard, const Item& item) {
+
+	switch (item.role) {
+
+	case LOCAL:
+
+		if (item.transaction.type == Transaction::ACCRUAL) {
+
+			BankSimulation::accrueAccounts(item.transaction, shard.accounts,
+															 shard.out);
+			break;
+		}
+
+		BankSimulation::analyzeTransaction(item.transaction, shard.accounts,
+															 shard.out);
+		break;
+
+	case SOURCE:
+
+		executeSource(shard, item);
+		break;
+
+	case DESTINATION:
+
+		executeDestination(shard, item);
+		break;
+	}
+}
+
+// Runs first Account's side of a transaction split between shards
+// Follows BankSimulation::analyzeTransaction & processTransaction,
+// with the second Account's side left to its shard
+void ShardedEngine::executeSource(Shard& shard, const Item& item) {
+
+	const Transaction& transaction(item.transaction);
+
+	Account* acct1Ptr;
+
+	bool found(shard.accounts.Retrieve(transaction.id1, acct1Ptr));
+
+	int destination(waitFor(item.handoff->destination));
+
+	if (!found || destination == MISSING) {
+
+		item.handoff->result.store(NOT_APPLIED, std::memory_order_release);
+
+		BankSimulation::printAccountNotFound(found ? transaction.id2 :
+											 transaction.id1, shard.out);
+		return;
+	}
+
+	if (transaction.type != Transaction::TRANSFER) {
+
+		item.handoff->result.store(NOT_APPLIED, std::memory_order_release);
+
+		BankSimulation::processTransaction(acct1Ptr, nullptr, transaction,
+										   shard.out);
+		return;
+	}
+
+	bool wentThrough(acct1Ptr->Withdraw(transaction.fund1,
+										transaction.amount, shard.out));
+
+	item.handoff->result.store(wentThrough ? WENT_THROUGH : FAILED,
+							   std::memory_order_release);
+
+	if (wentThrough) {
+
+		acct1Ptr->RecordTransaction(transaction, transaction.fund1);
+
+	} else {
+
+		BankSimulation::printInsufficientFunds(acct1Ptr->GetName(),
+											   transaction.amount,
+											   transaction.fund1, shard.out);
+
+		acct1Ptr->RecordFailedTransaction(transaction, transaction.fund1);
+	}
+}
+
+// Runs second Account's side of a transaction split between shards
+// Reports whether the second Account exists, then waits for the first
+// Account's side to finish a Transfer into it
+void ShardedEngine::executeDestination(Shard& shard, const Item& item) {
+
+	const Transaction& transaction(item.transaction);
+
+	Account* acct2Ptr;
+
+	bool found(shard.accounts.Retrieve(transaction.id2, acct2Ptr));
+
+	item.handoff->destination.store(found ? FOUND : MISSING,
+									std::memory_order_release);
+
+	int result(waitFor(item.handoff->result));
+
+	// Source shard is done with handoff once it reported its result
+	delete item.handoff;
+
+	if (result == WENT_THROUGH) {
+
+		acct2Ptr->Deposit(transaction.fund2, transaction.amount, shard.out);
+
+		acct2Ptr->RecordTransaction(transaction, transaction.fund2);
+
+	} else if (result == FAILED) {
+
+		acct2Ptr->RecordFailedTransaction(transaction, transaction.fund2);
+	}
+}
+
+// Static function
+// Waits until parameter state is reported, returns reported state
+int ShardedEngine::waitFor(const std::atomic<int>& state) {
+
+	int reported;
+
+	while ((reported = state.load(std::memory_order_acquire)) == PENDING) {
+
+		std::this_thread::yield();
+	}
+
+	return reported;
+}
+
+// Constructs Handoff with nothing reported
+ShardedEngine::Handoff::Handoff() :destination(PENDING), result(PENDING) {}
+
+// Constructs Shard with no Accounts, opening them in parameter arena,
+// or on the heap if nullptr, & giving them parameter segment
+ShardedEngine::Shard::Shard(Arena* arena, HistorySegment* segment)
+												:accounts(arena), closed(false) {
+
+	accounts.SetHistorySegment(segment);
+}
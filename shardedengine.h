@@ -0,0 +1,221 @@
+// shardedengine.h
+// Specifications for ShardedEngine class
+// Author: Juan Arias
+//
+// The ShardedEngine class runs transactions on several worker threads.
+// Accounts are split into shards by ID number and each shard is owned by
+// one worker, which alone opens, reads & changes its Accounts. The thread
+// calling Run decodes transactions and routes each one to the shard owning
+// its Account, in batches.
+//
+// A transaction naming Accounts in two shards is sent to both. The shard
+// of the second Account reports whether that Account exists, then the shard
+// of the first Account runs its side & reports the result, then the second
+// shard finishes. Every shard runs its transactions in input order, so each
+// Account sees the same sequence of changes as in a serial run.
+//
+// Transactions are routed in rounds, each shard getting one batch per
+// round. Output of each transaction is kept with its position in the input
+// & a round's output is written in input order as soon as every shard has
+// run the round, so output matches a serial run exactly & only the rounds
+// in flight are held in memory.
+//
+// Transactions whose ID was applied already are dropped before routing.
+//
+// Given Arenas (see arena.h), each shard opens its Accounts in an Arena of
+// its own, so workers never share one. The Accounts outlive the engine, so
+// the Arenas belong to its caller.
+//
+// An accrual is sent to every shard, each accruing it on its own Accounts
+// in its place among the shard's transactions.
+
+#ifndef SHARDEDENGINE_H
+#define SHARDEDENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "banksimulation.h"
+
+class ShardedEngine {
+
+public:
+
+	// Constructs ShardedEngine with parameter count shards, shard i opening
+	// Accounts in Arena i of parameter arenas, which gets more Arenas if
+	// needed, or on the heap if nullptr, moving their older history to
+	// parameter segment if not nullptr
+	explicit ShardedEngine(int count,
+				std::vector<std::unique_ptr<Arena>>* arenas = nullptr,
+				HistorySegment* segment = nullptr);
+
+	// Destroys ShardedEngine, deleting Accounts it still owns
+	virtual ~ShardedEngine();
+
+	// Runs every transaction decoded by parameter parser whose ID is not
+	// in parameter dedup, printing output to parameter out as it goes
+	void Run(TransactionParser& parser, std::ostream& out, DedupIndex& dedup);
+
+	// Moves all opened Accounts into parameter registry, shard by shard
+	void MoveAccounts(AccountRegistry& registry);
+
+private:
+
+	// Transactions sent to a shard at a time
+	static const std::size_t BATCH_SIZE = 1024;
+
+	// Batches a shard can have waiting before the router waits for it
+	static const std::size_t QUEUE_BATCHES = 16;
+
+	// Constants for the part a shard plays in a transaction
+	enum ROLE {
+
+		LOCAL       = 0,
+		SOURCE      = 1,
+		DESTINATION = 2
+	};
+
+	// Constants for states reported between shards
+	enum STATE {
+
+		PENDING,
+		FOUND,
+		MISSING,
+		NOT_APPLIED,
+		WENT_THROUGH,
+		FAILED
+	};
+
+	// States reported between the two shards of one transaction
+	struct Handoff {
+
+		// Constructs Handoff with nothing reported
+		Handoff();
+
+		// Whether second Account exists, reported by its shard
+		std::atomic<int> destination;
+
+		// Result of first Account's side, reported by its shard
+		std::atomic<int> result;
+
+	};
+
+	// Transaction routed to a shard
+	struct Item {
+
+		// Position of transaction in input
+		long long seq;
+
+		// Decoded transaction
+		Transaction transaction;
+
+		// Part shard plays in transaction
+		ROLE role;
+
+		// States shared with other shard, nullptr if LOCAL
+		Handoff* handoff;
+
+	};
+
+	// Range of a shard's output printed by one transaction
+	struct Segment {
+
+		long long seq;
+		int role;
+		int shard;
+		std::size_t begin;
+		std::size_t end;
+
+	};
+
+	// Output a shard printed running one round's batch
+	struct Round {
+
+		std::string text;
+		std::vector<Segment> segments;
+
+	};
+
+	// Shard of Accounts & its worker
+	struct Shard {
+
+		// Constructs Shard with no Accounts, opening them in parameter
+		// arena, or on the heap if nullptr, & giving them parameter segment
+		Shard(Arena* arena, HistorySegment* segment);
+
+		// Accounts owned by shard
+		AccountRegistry accounts;
+
+		// Batches waiting to run, guarded by lock
+		std::deque<std::vector<Item>> queue;
+		std::mutex lock;
+		std::condition_variable changed;
+		bool closed;
+
+		// Output printed by shard & where each transaction's output is,
+		// for the batch running
+		std::ostringstream out;
+		std::vector<Segment> segments;
+
+		// Output of rounds run, oldest first, not yet written, guarded
+		// by lock
+		std::deque<Round> done;
+
+		// Thread running shard
+		std::thread worker;
+
+	};
+
+	// Shards of engine
+	std::vector<std::unique_ptr<Shard>> shards;
+
+	// Adds accrual parameter transaction with position parameter seq to
+	// parameter pending of every shard
+	void broadcast(std::vector<std::vector<Item>>& pending, long long seq,
+				   const Transaction& transaction);
+
+	// Returns index of shard owning Account with parameter id
+	std::size_t owner(long long id) const;
+
+	// Sends every pending batch in parameter pending to its shard, even
+	// empty, as one round
+	void flush(std::vector<std::vector<Item>>& pending);
+
+	// Writes output of every round all shards have run to parameter out,
+	// in input order
+	void write(std::ostream& out);
+
+	// Adds parameter batch to queue of parameter shard,
+	// waiting while the queue is full
+	void push(Shard& shard, std::vector<Item>& batch);
+
+	// Takes next batch of parameter shard into parameter batch,
+	// returns false once the shard is closed & drained
+	bool pop(Shard& shard, std::vector<Item>& batch);
+
+	// Runs every batch sent to shard with parameter index
+	void work(int index);
+
+	// Runs parameter item on parameter shard
+	void execute(Shard& shard, const Item& item);
+
+	// Runs first Account's side of a transaction split between shards
+	void executeSource(Shard& shard, const Item& item);
+
+	// Runs second Account's side of a transaction split between shards
+	void executeDestination(Shard& shard, const Item& item);
+
+	// Waits until parameter state is reported, returns reported state
+	static int waitFor(const std::atomic<int>& state);
+
+	// Disallow copying, workers refer to their engine
+	ShardedEngine(const ShardedEngine&) = delete;
+	ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+};
+#endif
@@ -0,0 +1,207 @@
+// spscring.h
+// Specifications & implementations for SpscRing class template
+// Author: Juan Arias
+//
+// The SpscRing class is a bounded queue between exactly one producer thread
+// & one consumer thread. It never locks: the producer alone writes the tail
+// & the consumer alone writes the head, each published with a release store
+// & read by the other thread with an acquire load. Head & tail sit on their
+// own cache lines, so the two threads do not slow each other down. It can:
+//	-push an item, waiting while the ring is full (backpressure)
+//	-pop an item, waiting while the ring is empty & not closed
+//	-close, so the consumer stops once it has drained the ring
+//	-report how often each side had to wait & how full the ring was
+//
+// Waiting threads yield, so a stage waiting on a slower one gives the core
+// to it. Counters are kept by the thread they belong to & should only be
+// read after both threads are done.
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <class T>
+class SpscRing {
+
+public:
+
+	// Constructs empty SpscRing holding at least parameter capacity items
+	explicit SpscRing(std::size_t capacity);
+
+	// Moves parameter item into ring, waiting while ring is full
+	// Called by producer only
+	void Push(T&& item);
+
+	// Moves next item into parameter item, waiting while ring is empty,
+	// returns false once ring is closed & drained
+	// Called by consumer only
+	bool Pop(T& item);
+
+	// Tells consumer no more items will be pushed
+	// Called by producer only
+	void Close();
+
+	// Returns number of pushes that found ring full & had to wait
+	long long FullStalls() const;
+
+	// Returns number of pops that found ring empty & had to wait
+	long long EmptyStalls() const;
+
+	// Returns mean number of items already in ring when one was pushed
+	double MeanOccupancy() const;
+
+private:
+
+	// Bytes in a cache line
+	static const std::size_t CACHE_LINE = 64;
+
+	// Items of ring, a power of two of them
+	std::vector<T> slots;
+
+	// Number of slots less one, masks a position to its slot
+	std::size_t mask;
+
+	// Position of next item to pop, written by consumer
+	alignas(CACHE_LINE) std::atomic<std::size_t> head;
+
+	// Position of next item to push, written by producer
+	alignas(CACHE_LINE) std::atomic<std::size_t> tail;
+
+	// True once producer is done
+	std::atomic<bool> closed;
+
+	// Counters of producer
+	alignas(CACHE_LINE) long long fullStalls;
+	long long pushes;
+	long long occupancy;
+
+	// Counters of consumer
+	alignas(CACHE_LINE) long long emptyStalls;
+
+	// Disallow copying, two threads share one ring
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+};
+
+// Constructs empty SpscRing holding at least parameter capacity items
+// Capacity is rounded up to a power of two so positions wrap with a mask
+template <class T>
+SpscRing<T>::SpscRing(std::size_t capacity) :head(0), tail(0), closed(false),
+							fullStalls(0), pushes(0), occupancy(0),
+							emptyStalls(0) {
+
+	std::size_t size(1);
+
+	while (size < capacity) {
+
+		size *= 2;
+	}
+
+	slots.resize(size);
+
+	mask = size - 1;
+}
+
+// Moves parameter item into ring, waiting while ring is full
+// Called by producer only
+template <class T>
+void SpscRing<T>::Push(T&& item) {
+
+	std::size_t position(tail.load(std::memory_order_relaxed)),
+				used(position - head.load(std::memory_order_acquire));
+
+	if (used > mask) {
+
+		++fullStalls;
+
+		do {
+
+			std::this_thread::yield();
+
+			used = position - head.load(std::memory_order_acquire);
+
+		} while (used > mask);
+	}
+
+	++pushes;
+
+	occupancy += used;
+
+	slots[position & mask] = std::move(item);
+
+	tail.store(position + 1, std::memory_order_release);
+}
+
+// Moves next item into parameter item, waiting while ring is empty,
+// returns false once ring is closed & drained
+// Called by consumer only
+// Closed is read before tail, so an item pushed before closing is seen
+template <class T>
+bool SpscRing<T>::Pop(T& item) {
+
+	std::size_t position(head.load(std::memory_order_relaxed));
+
+	if (position == tail.load(std::memory_order_acquire)) {
+
+		++emptyStalls;
+
+		while (true) {
+
+			bool done(closed.load(std::memory_order_acquire));
+
+			if (position != tail.load(std::memory_order_acquire)) {
+
+				break;
+			}
+
+			if (done) {
+
+				return false;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+
+	item = std::move(slots[position & mask]);
+
+	head.store(position + 1, std::memory_order_release);
+
+	return true;
+}
+
+// Tells consumer no more items will be pushed
+// Called by producer only
+template <class T>
+void SpscRing<T>::Close() {
+
+	closed.store(true, std::memory_order_release);
+}
+
+// Returns number of pushes that found ring full & had to wait
+template <class T>
+long long SpscRing<T>::FullStalls() const {
+
+	return fullStalls;
+}
+
+// Returns number of pops that found ring empty & had to wait
+template <class T>
+long long SpscRing<T>::EmptyStalls() const {
+
+	return emptyStalls;
+}
+
+// Returns mean number of items already in ring when one was pushed
+template <class T>
+double SpscRing<T>::MeanOccupancy() const {
+
+	return (pushes > 0) ? static_cast<double>(occupancy) / pushes : 0.0;
+}
+#endif
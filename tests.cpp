@@ -1,10 +1,35 @@
 // tests.cpp
-// Tests for BSTree & Account classes
+// Tests for BSTree, AccountTable, BPlusTree & Account classes
 // Author: Juan Arias
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include "bstree.h"
+#include "accounttable.h"
+#include "arena.h"
+#include "bplustree.h"
+#include "balanceranking.h"
+#include "balancestore.h"
+#include "bankstats.h"
+#include "banksimulation.h"
+#include "concurrenttable.h"
+#include "dedupindex.h"
+#include "historysegment.h"
+#include "journal.h"
+#include "outputsink.h"
+#include "spscring.h"
+#include "transactionparser.h"
+#include "writeaheadlog.h"
 
 // Test Deposit & RecordTransaction
 void TestDeposit(Account* acctPtr) {
@@ -103,6 +128,94 @@ void TestTransfer2Accounts(Account* acctPtr) {
 
 }
 
+// Test history of two Accounts renders each kind of event as the bank
+// always printed it: deposits, failed withdraws, transfers between the two
+// Accounts, failed & covered, & the cover events of a fund short of money
+void TestDisplayEvents() {
+
+	Account alpha("One Alpha", 1000), beta("Two Beta", 1001);
+
+	DiscardSink errors;
+
+	MemorySink history;
+
+	alpha.Deposit(Account::MONEY_MARKET, 500, errors);
+	alpha.RecordTransaction("D 10000 500", Account::MONEY_MARKET);
+
+	beta.Deposit(Account::PRIME_MONEY_MARKET, 50, errors);
+	beta.RecordTransaction("D 10011 50", Account::PRIME_MONEY_MARKET);
+
+	assert(!beta.Withdraw(Account::PRIME_MONEY_MARKET, 120, errors));
+	beta.RecordFailedTransaction("W 10011 120", Account::PRIME_MONEY_MARKET);
+
+	assert(!alpha.Withdraw(Account::LONG_TERM_BOND, 30, errors));
+	alpha.RecordFailedTransaction("W 10002 30", Account::LONG_TERM_BOND);
+
+	assert(!alpha.Withdraw(Account::MONEY_MARKET, 900, errors));
+	alpha.RecordFailedTransaction("W 10000 900", Account::MONEY_MARKET);
+
+	assert(alpha.Transfer(&beta, Account::MONEY_MARKET,
+						  Account::SHORT_TERM_BOND, 60, errors));
+	alpha.RecordTransaction("T 10000 60 10013", Account::MONEY_MARKET);
+	beta.RecordTransaction("T 10000 60 10013", Account::SHORT_TERM_BOND);
+
+	// Long-Term Bond is covered from Short-Term Bond
+	assert(beta.Transfer(&alpha, Account::LONG_TERM_BOND,
+						 Account::SHORT_TERM_BOND, 10, errors));
+	beta.RecordTransaction("T 10012 10 10003", Account::LONG_TERM_BOND);
+	alpha.RecordTransaction("T 10012 10 10003", Account::SHORT_TERM_BOND);
+
+	assert(!beta.Transfer(&alpha, Account::MONEY_MARKET,
+						  Account::GROWTH_INDEX_FUND, 100, errors));
+	beta.RecordFailedTransaction("T 10010 100 10007", Account::MONEY_MARKET);
+	alpha.RecordFailedTransaction("T 10010 100 10007",
+								  Account::GROWTH_INDEX_FUND);
+
+	alpha.DisplayHistory(Account::NONE, history);
+	beta.DisplayHistory(Account::PRIME_MONEY_MARKET, history);
+	beta.DisplayHistory(Account::NONE, history);
+
+	assert(history.Str() ==
+		"Transaction history for One Alpha by fund.\n"
+		"Money Market: $440\n"
+		"  D 10000 500\n"
+		"  W 10000 900 (Failed)\n"
+		"  T 10000 60 10013\n"
+		"Prime Money Market: $0\n"
+		"Long-Term Bond: $0\n"
+		"  W 10002 30 (Failed)\n"
+		"Short-Term Bond: $10\n"
+		"  T 10012 10 10003\n"
+		"500 Index Fund: $0\n"
+		"Capital Value Fund: $0\n"
+		"Growth Equity Fund: $0\n"
+		"Growth Index Fund: $0\n"
+		"  T 10010 100 10007 (Failed)\n"
+		"Value Fund: $0\n"
+		"Value Stock Index: $0\n"
+		"Transaction history for Two Beta Prime Money Market: $50\n"
+		"  D 10011 50\n"
+		"  W 10011 120 (Failed)\n"
+		"Transaction history for Two Beta by fund.\n"
+		"Money Market: $0\n"
+		"  T 10010 100 10007 (Failed)\n"
+		"Prime Money Market: $50\n"
+		"  D 10011 50\n"
+		"  W 10011 120 (Failed)\n"
+		"Long-Term Bond: $0\n"
+		"  Transfered 10 from Short-Term Bond\n"
+		"  T 10012 10 10003\n"
+		"Short-Term Bond: $50\n"
+		"  T 10000 60 10013\n"
+		"  Transfered 10 to Long-Term Bond\n"
+		"500 Index Fund: $0\n"
+		"Capital Value Fund: $0\n"
+		"Growth Equity Fund: $0\n"
+		"Growth Index Fund: $0\n"
+		"Value Fund: $0\n"
+		"Value Stock Index: $0\n");
+}
+
 // Run Account Tests
 void RunAccountTests() {
 	
@@ -146,10 +259,13 @@ void RunAccountTests() {
 	std::cout << "-----Testing Transfer with two Accounts------" << std::endl;
 
 	TestTransfer2Accounts(&acct);
+
+	TestDisplayEvents();
 }
 
 // Test Insert, check for inserting duplicate Ids
-void TestInsert(BSTree* treePtr) {
+template <class Registry>
+void TestInsert(Registry* treePtr) {
 
 	assert(treePtr->Insert(new Account("Kobe Bryant", 5824)));
 	assert(treePtr->Insert(new Account("LeBron James", 3600)));
@@ -164,7 +280,8 @@ void TestInsert(BSTree* treePtr) {
 }
 
 // Test Retrieve, check for Accounts with ids not stored
-void TestRetrieve(BSTree* treePtr) {
+template <class Registry>
+void TestRetrieve(Registry* treePtr) {
 
 	Account* kobePtr,
 		   * lebronPtr,
@@ -188,10 +305,11 @@ void TestRetrieve(BSTree* treePtr) {
 	assert(!treePtr->Retrieve(2359, cp3Ptr) && cp3Ptr == nullptr);
 }
 
-// Run BSTree tests
-void RunBSTreeTests() {
+// Run registry tests for BSTree, AccountTable, ConcurrentTable or BPlusTree
+template <class Registry>
+void RunRegistryTests() {
 
-	BSTree tree;
+	Registry tree;
 
 	// Test Insert
 	TestInsert(&tree);
@@ -210,14 +328,1999 @@ void RunBSTreeTests() {
 	assert(tree.isEmpty());
 }
 
-// Run all tests for each class
-void RunAllTests() {
+// Test Arena hands out aligned memory & reuses the same chunks after
+// Reset, then parameter Registry keeping Accounts & nodes in an Arena over
+// several runs
+template <class Registry>
+void TestArena() {
 
-	std::cout <<"-------------------Running Account Tests------------------\n";
-	RunAccountTests();
-	std::cout << std::endl << std::endl <<
-		"------------------Running BSTree Tests-------------------\n";
-	RunBSTreeTests();
+	Arena arena;
+
+	char* first(static_cast<char*>(arena.allocate(3, 1)));
+	double* aligned(static_cast<double*>(arena.allocate(sizeof(double),
+														alignof(double))));
+
+	assert(reinterpret_cast<std::uintptr_t>(aligned) % alignof(double) == 0);
+
+	// Bigger than any chunk yet
+	void* big(arena.allocate(Arena::CHUNK_SIZE * 4, 64));
+
+	assert(reinterpret_cast<std::uintptr_t>(big) % 64 == 0);
+
+	std::size_t reserved(arena.Reserved());
+
+	arena.Reset();
+
+	assert(arena.Used() == 0 && arena.Reserved() == reserved);
+	assert(static_cast<char*>(arena.allocate(3, 1)) == first);
+
+	for (int run(0); run < 3; ++run) {
+
+		arena.Reset();
+
+		Registry registry(&arena);
+
+		for (int id(Account::MIN_ID); id < Account::MIN_ID + 500; ++id) {
+
+			Account* acctPtr(arena.New<Account>("Arena Client", id, &arena));
+
+			assert(registry.Insert(acctPtr));
+
+			for (int amount(1); amount <= 20; ++amount) {
+
+				acctPtr->Deposit(amount % Account::MAX_FUNDS, amount);
+				acctPtr->RecordTransaction("D 10000 1",
+										   amount % Account::MAX_FUNDS);
+			}
+		}
+
+		Account* acctPtr;
+
+		assert(registry.Retrieve(Account::MIN_ID + 7, acctPtr) &&
+			   acctPtr->GetName() == "Arena Client" &&
+			   acctPtr->GetBalance(1) == 1 + 11 &&
+			   acctPtr->HistorySize(1) == 2);
+
+		registry.Empty();
+
+		assert(registry.isEmpty());
+
+		// Every run after the first fits in the chunks already there
+		if (run == 0) {
+
+			reserved = arena.Reserved();
+
+		} else {
+
+			assert(arena.Reserved() == reserved);
+		}
+	}
+}
+
+// Test AccountTable with Accounts opened in ascending ID order and
+// IDs at and past both ends of the table
+void TestAccountTableBounds() {
+
+	AccountTable table;
+
+	long long first(Account::MIN_ID),
+			  last(Account::MIN_ID + AccountTable::CAPACITY - 1);
+
+	for (long long id(first); id <= last; ++id) {
+
+		assert(table.Insert(new Account("Sequential Client", id)));
+	}
+
+	Account* acctPtr;
+
+	assert(table.Retrieve(first, acctPtr) && acctPtr->GetID() == first);
+	assert(table.Retrieve(last, acctPtr) && acctPtr->GetID() == last);
+
+	assert(!table.Retrieve(first - 1, acctPtr) && acctPtr == nullptr);
+	assert(!table.Retrieve(last + 1, acctPtr) && acctPtr == nullptr);
+
+	Account outOfRange("Out Range", last + 1);
+
+	assert(!table.Insert(&outOfRange));
+
+	int scanned(0);
+
+	table.Scan(first + 10, first + 19, [&scanned](Account*) { ++scanned; });
+
+	assert(scanned == 10);
+
+	table.Empty();
+
+	assert(table.isEmpty());
+}
+
+// Test BPlusTree with a hundred thousand 64 bit IDs inserted in random
+// order, then in ascending order, checking lookups, ordered iteration &
+// range scans against a sorted copy of the IDs
+void TestBPlusTree() {
+
+	std::mt19937_64 random(21);
+
+	std::uniform_int_distribution<long long> pickId(Account::MIN_ID,
+													Account::MAX_ID);
+
+	std::vector<long long> ids;
+
+	for (int count(0); count < 100000; ++count) {
+
+		ids.push_back(pickId(random));
+	}
+
+	ids.push_back(Account::MIN_ID);
+	ids.push_back(Account::MAX_ID);
+
+	for (int pass(0); pass < 2; ++pass) {
+
+		BPlusTree tree;
+
+		for (long long id : ids) {
+
+			assert(tree.Insert(new Account("Tree Client", id)));
+		}
+
+		std::vector<long long> sorted(ids);
+
+		std::sort(sorted.begin(), sorted.end());
+
+		assert(tree.Size() == sorted.size());
+
+		Account duplicate("Duplicate Client", sorted[sorted.size() / 2]);
+
+		assert(!tree.Insert(&duplicate));
+
+		Account* acctPtr;
+
+		for (std::size_t index(0); index < sorted.size(); index += 97) {
+
+			assert(tree.Retrieve(sorted[index], acctPtr) &&
+				   acctPtr->GetID() == sorted[index]);
+
+			assert(!tree.Retrieve(sorted[index] + 1, acctPtr) ||
+				   std::binary_search(sorted.begin(), sorted.end(),
+									  sorted[index] + 1));
+		}
+
+		std::vector<long long> visited;
+
+		tree.Scan(Account::MIN_ID, Account::MAX_ID,
+				  [&visited](Account* acctPtr) {
+
+			visited.push_back(acctPtr->GetID());
+		});
+
+		assert(visited == sorted);
+
+		for (int range(0); range < 100; ++range) {
+
+			long long first(pickId(random)),
+					  last(first + pickId(random) / 8);
+
+			long long expected(std::upper_bound(sorted.begin(), sorted.end(),
+												last) -
+							   std::lower_bound(sorted.begin(), sorted.end(),
+												first));
+
+			long long scanned(0), previous(first - 1);
+
+			tree.Scan(first, last, [&](Account* acctPtr) {
+
+				assert(acctPtr->GetID() > previous &&
+					   acctPtr->GetID() <= last);
+
+				previous = acctPtr->GetID();
+
+				++scanned;
+			});
+
+			assert(scanned == expected);
+		}
+
+		tree.Empty();
+
+		assert(tree.isEmpty() && !tree.Retrieve(sorted[0], acctPtr));
+
+		ids = sorted;
+	}
+}
+
+// Test Parse on each transaction type, fused id & fund digits
+// and malformed fields
+void TestParse() {
+
+	Transaction transaction;
+
+	assert(TransactionParser::Parse("O Cash Johnny 1001", transaction));
+	assert(transaction.type == Transaction::OPEN &&
+		   transaction.lastName == "Cash" && transaction.firstName == "Johnny" &&
+		   transaction.id1 == 1001);
+
+	assert(TransactionParser::Parse("T 10017 54 10015", transaction));
+	assert(transaction.type == Transaction::TRANSFER &&
+		   transaction.id1 == 1001 && transaction.fund1 == 7 &&
+		   transaction.amount == 54 && transaction.twoAccounts &&
+		   transaction.id2 == 1001 && transaction.fund2 == 5);
+
+	// History of whole Account has no fund
+	assert(TransactionParser::Parse("H 1001", transaction));
+	assert(transaction.id1 == 1001 &&
+		   transaction.fund1 == Transaction::NONE &&
+		   transaction.amount == Transaction::NONE &&
+		   !transaction.twoAccounts);
+
+	// Funds past the rates given accrue nothing
+	assert(TransactionParser::Parse("A 25 -10 0 5", transaction));
+	assert(transaction.type == Transaction::ACCRUAL &&
+		   transaction.amount == 4 && transaction.rates[1] == -10 &&
+		   transaction.rates[3] == 5 && transaction.rates[4] == 0);
+
+	// Transaction ID comes before the type
+	assert(TransactionParser::Parse("#42 D 10010 5", transaction));
+	assert(transaction.txid == 42 &&
+		   transaction.type == Transaction::DEPOSIT &&
+		   transaction.id1 == 1001 && transaction.amount == 5);
+
+	assert(TransactionParser::Parse("D 10010 5", transaction));
+	assert(transaction.txid == Transaction::NONE);
+
+	// ID numbers past 32 bits, with & without a fund digit
+	assert(TransactionParser::Parse("O Big Id 123456789012345", transaction));
+	assert(transaction.id1 == 123456789012345LL);
+
+	assert(TransactionParser::Parse("T 1234567890123456 7 99999999999",
+									transaction));
+	assert(transaction.id1 == 123456789012345LL && transaction.fund1 == 6 &&
+		   transaction.id2 == 9999999999LL && transaction.fund2 == 9);
+
+	// A separator names a whole Account or a fund of any ID number
+	assert(TransactionParser::Parse("H 12345: L 2", transaction));
+	assert(transaction.id1 == 12345 &&
+		   transaction.fund1 == Transaction::NONE &&
+		   transaction.page == Transaction::LATEST && transaction.amount == 2);
+
+	assert(TransactionParser::Parse("T 12345:3 70 1001:", transaction));
+	assert(transaction.id1 == 12345 && transaction.fund1 == 3 &&
+		   transaction.amount == 70 && transaction.id2 == 1001 &&
+		   transaction.fund2 == Transaction::NONE);
+
+	assert(TransactionParser::Parse("H 12345", transaction));
+	assert(transaction.id1 == 1234 && transaction.fund1 == 5);
+
+	// Field that is not a number reads as 0 and ends the line
+	assert(TransactionParser::Parse("D abc 5", transaction));
+	assert(transaction.id1 == 0 && transaction.amount == Transaction::NONE);
+
+	// Blank lines are skipped
+	assert(!TransactionParser::Parse(" \t", transaction));
+
+	TransactionParser parser("D 10010 542\n\nW 10010 72");
+
+	assert(parser.Next(transaction) && transaction.text == "D 10010 542");
+	assert(parser.Next(transaction) && transaction.text == "W 10010 72");
+	assert(!parser.Next(transaction));
+}
+
+// Test writing Transactions to a journal then reading them back,
+// including the names of an OPEN record
+void TestJournal() {
+
+	const char* lines[] = { "O Cash Johnny 1001", "D 10010 542",
+							"T 10017 54 10015", "A 25 -10 0 5", "H 1001",
+							"#7 D 10010 5", "H 10013 S 5 9",
+							"H 1001 L 3", "O Big Id 123456789012345",
+							"#8 T 1234567890123456 7 10015",
+							"H 1234567890123 P 0 2", "H 12345:",
+							"D 999:7 9", "T 5:3 1 10015",
+							"T 10013 5 1002:" };
+
+	std::stringstream journal;
+
+	Journal::WriteHeader(journal);
+
+	Transaction transaction;
+
+	for (const char* line : lines) {
+
+		assert(TransactionParser::Parse(line, transaction));
+
+		Journal::Write(journal, transaction);
+	}
+
+	std::string bytes(journal.str());
+
+	assert(Journal::IsJournal(std::string_view(bytes)));
+
+	JournalReader reader(bytes);
+
+	assert(reader.Valid());
+
+	std::string text;
+
+	for (const char* line : lines) {
+
+		assert(reader.Next(transaction) && transaction.text.empty());
+
+		Journal::Format(transaction, text);
+
+		assert(text == line);
+	}
+
+	assert(!reader.Next(transaction));
+}
+
+// Test DedupIndex forgets the oldest IDs once full & keeps the rest
+// reachable as they are shifted back, then a retried chunk of transactions
+// is skipped in every mode
+void TestDedup() {
+
+	DedupIndex index(1000);
+
+	assert(index.Insert(7) && !index.Insert(7) && index.Duplicates() == 1);
+
+	for (std::uint64_t id(100); id < 1100; ++id) {
+
+		assert(index.Insert(id));
+	}
+
+	// 7 was the oldest of 1000
+	assert(index.Size() == 1000 && !index.Contains(7));
+
+	std::mt19937_64 random(5);
+
+	std::vector<std::uint64_t> window;
+
+	for (int count(0); count < 200000; ++count) {
+
+		std::uint64_t id(random() % 5000);
+
+		if (index.Insert(id)) {
+
+			window.push_back(id);
+		}
+
+		if (count % 20000 == 0) {
+
+			std::size_t first(window.size() > 1000 ? window.size() - 1000 : 0);
+
+			for (std::size_t slot(first); slot < window.size(); ++slot) {
+
+				assert(index.Contains(window[slot]));
+			}
+		}
+	}
+
+	assert(index.Size() == 1000);
+
+	index.Clear();
+
+	assert(index.Size() == 0 && index.Duplicates() == 0 &&
+		   !index.Contains(window.back()));
+
+	// Largest ID, whose key wraps to the empty marker, is caught & forgotten
+	// in turn like any other
+	const std::uint64_t LARGEST = UINT64_MAX;
+
+	assert(!index.Contains(LARGEST) && index.Insert(LARGEST) &&
+		   !index.Insert(LARGEST) && index.Contains(LARGEST));
+
+	for (std::uint64_t id(0); id < 999; ++id) {
+
+		assert(index.Insert(id));
+	}
+
+	assert(index.Contains(LARGEST) && index.Insert(1000));
+	assert(!index.Contains(LARGEST) && index.Contains(0));
+
+	index.Clear();
+
+	std::stringstream chunk;
+
+	for (int id(0); id < 50; ++id) {
+
+		chunk << '#' << id << " D " << (1000 + id % 5) << id % 10 << ' '
+			  << id << '\n';
+	}
+
+	std::string text("O A B 1000\nO C D 1001\nO E F 1002\nO G H 1003\n"
+					 "O I J 1004\n#50 A 100\n");
+
+	const char* fileName = "tests_dedup.txt";
+	const char* expectedName = "tests_dedup_expected.txt";
+
+	{
+		std::ofstream inFile(fileName), expectedFile(expectedName);
+
+		inFile << text << chunk.str() << chunk.str() << "#50 A 100\n";
+		expectedFile << text << chunk.str();
+	}
+
+	MemorySink expectedOut;
+
+	BankSimulation expectedSim(expectedOut);
+
+	expectedSim.Start(expectedName, BankSimulation::BUFFERED);
+
+	std::remove(expectedName);
+
+	for (int mode(BankSimulation::BUFFERED); mode <= BankSimulation::PARALLEL;
+		 ++mode) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+		assert(out.Str() == expectedOut.Str());
+		assert(sim.Duplicates() == 51);
+	}
+
+	std::remove(fileName);
+}
+
+// Test a run with ID numbers of five digits & more in every mode, with
+// 'H' lines naming a whole Account or a fund where both are open Accounts,
+// on several shards so the two Accounts may be in different shards
+void TestLongIds() {
+
+	const char* fileName = "tests_long_ids.txt";
+
+	{
+		std::ofstream inFile(fileName);
+
+		inFile << "O Big One 123456789012\n"
+			   << "O Short Id 1234\n"
+			   << "O Five Digit 12345\n"
+			   << "D 1234567890123 500\n"
+			   << "T 1234567890123 200 123452\n"
+			   << "D 12341 40\n"
+			   << "D 12345 60\n"
+			   << "D 12345:5 70\n"
+			   << "H 12345:\n"
+			   << "H 12345\n"
+			   << "H 12345:5\n"
+			   << "H 12341\n"
+			   << "H 1234567890123\n"
+			   << "H 123456789012 L 1\n"
+			   << "O Too Big 100000000000000000\n"
+			   << "O Again Five 12345\n"
+			   << "D 99999999999990 1\n";
+	}
+
+	std::string expected;
+
+	for (int mode(BankSimulation::BUFFERED); mode <= BankSimulation::PARALLEL;
+		 ++mode) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.SetThreads(3);
+
+		sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+		if (mode == BankSimulation::BUFFERED) {
+
+			expected = out.Str();
+		}
+
+		assert(out.Str() == expected);
+	}
+
+	std::remove(fileName);
+
+	// Tables hold only four digit ID numbers, every mode still agrees
+	AccountRegistry registry;
+
+	Account* probePtr(new Account("Probe Client", 12345));
+
+	if (!registry.Insert(probePtr)) {
+
+		delete probePtr;
+
+		return;
+	}
+
+	// Whole history of 12345 & its fund 5 only with a separator, without
+	// one the last digit is a fund of 1234
+	assert(expected.find("Transaction history for Digit Five by fund.") !=
+														std::string::npos);
+	assert(expected.find("Transaction history for Digit Five Capital Value "
+						 "Fund: $70") != std::string::npos);
+	assert(expected.find("Transaction history for Id Short Capital Value "
+						 "Fund: $60") != std::string::npos);
+	assert(expected.find("Transaction history for Id Short Prime Money "
+						 "Market: $40") != std::string::npos);
+	assert(expected.find("Transaction history for One Big Short-Term Bond: "
+						 "$300") != std::string::npos);
+	assert(expected.find("Invalid ID number 100000000000000000") !=
+														std::string::npos);
+	assert(expected.find("Account 12345 is already open") !=
+														std::string::npos);
+	assert(expected.find("Account 9999999999999 not found") !=
+														std::string::npos);
+	assert(expected.find("Account ID: 123456789012") != std::string::npos);
+}
+
+// Test STREAMING mode prints the same as BUFFERED, with & without a line
+// break after the last line, which still runs
+void TestStreaming() {
+
+	const char* fileName = "tests_streaming.txt";
+
+	const std::string lines("O Alpha One 1000\n"
+							"O Beta Two 1001\n"
+							"O Beta Again 1001\n"
+							"D 10000 500\n"
+							"W 10001 20\n"
+							"T 10000 120 10013\n"
+							"X 10000 1\n"
+							"H 1001\n"
+							"D 10001 7");
+
+	for (const std::string& ending : { std::string(), std::string("\n") }) {
+
+		{
+			std::ofstream inFile(fileName, std::ios::binary);
+
+			inFile << lines << ending;
+		}
+
+		MemorySink bufferedOut, streamingOut;
+
+		BankSimulation bufferedSim(bufferedOut), streamingSim(streamingOut);
+
+		bufferedSim.Start(fileName, BankSimulation::BUFFERED);
+		streamingSim.Start(fileName, BankSimulation::STREAMING);
+
+		assert(streamingOut.Str() == bufferedOut.Str());
+		assert(bufferedOut.Str().find("Prime Money Market: $7\n") !=
+														std::string::npos);
+	}
+
+	std::remove(fileName);
+}
+
+// Test SHARDED mode with transfers between Accounts of different shards
+// prints the same as BUFFERED: transfers that cover from the other money
+// market, name a missing Account, fail to withdraw & are rolled back, or
+// move money between two funds of one Account
+void TestShardedTransfers() {
+
+	const char* fileName = "tests_sharded.txt";
+
+	{
+		std::ofstream inFile(fileName);
+
+		inFile << "O Alpha One 1000\n"
+			   << "O Beta Two 1001\n"
+			   << "O Gamma Three 1002\n"
+			   << "D 10000 500\n"
+			   << "D 10011 300\n"
+			   << "D 10010 100\n"
+			   << "D 10025 200\n"
+			   << "D 10005 100\n"
+			   << "T 10000 100 10011\n"
+			   << "T 10011 50 10022\n"
+			   << "T 10011 400 10020\n"
+			   << "T 10000 40 99990\n"
+			   << "T 99990 40 10000\n"
+			   << "T 10025 900 10014\n"
+			   << "W 10026 10\n"
+			   << "T 10005 30 10008\n"
+			   << "T 10000 20 10003\n"
+			   << "T 10021 400 10004\n"
+			   << "H 1000\n"
+			   << "H 1001\n"
+			   << "H 1002\n";
+	}
+
+	MemorySink bufferedOut;
+
+	BankSimulation bufferedSim(bufferedOut);
+
+	bufferedSim.Start(fileName, BankSimulation::BUFFERED);
+
+	const std::string& expected(bufferedOut.Str());
+
+	// Each Account in a shard of its own with 3, two sharing one with 2
+	for (int threads(2); threads <= 4; ++threads) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.SetThreads(threads);
+
+		sim.Start(fileName, BankSimulation::SHARDED);
+
+		assert(out.Str() == expected);
+	}
+
+	std::remove(fileName);
+
+	assert(expected.find("Account 9999 not found") != std::string::npos);
+	assert(expected.find("Not enough funds to withdraw 900 from Three Gamma "
+						 "Capital Value Fund") != std::string::npos);
+	assert(expected.find("Prime Money Market: $0\n  D 10011 300\n"
+						 "  T 10000 100 10011\n") != std::string::npos);
+	assert(expected.find("500 Index Fund: $0\n  T 10025 900 10014 (Failed)") !=
+														std::string::npos);
+	assert(expected.find("Value Fund: $30\n  T 10005 30 10008\n") !=
+														std::string::npos);
+}
+
+// Test Account output to a MemorySink & a DiscardSink
+void TestOutputSinks() {
+
+	Account acct("Johnny Cash", 1001);
+
+	acct.Deposit(Account::MONEY_MARKET, 542);
+	acct.RecordTransaction("D 10010 542", Account::MONEY_MARKET);
+
+	MemorySink memory;
+
+	acct.DisplayHistory(Account::MONEY_MARKET, memory);
+
+	assert(memory.Str() == "Transaction history for Johnny Cash "
+						   "Money Market: $542\n  D 10010 542\n");
+
+	memory.Clear();
+
+	assert(!acct.Deposit(Account::NONE, 1, memory));
+	assert(memory.Str() == "DEPOSIT ERROR\n");
+
+	DiscardSink discard;
+
+	acct.DisplayHistory(Account::NONE, discard);
+
+	assert(discard.good());
+}
+
+// Test pages of history by latest, by position & by sequence number, for
+// one fund & for all funds, then an 'H' line naming a page
+void TestHistoryPages() {
+
+	Account acct("Johnny Cash", 1001);
+
+	for (int amount(1); amount <= 10; ++amount) {
+
+		acct.RecordTransaction("D 10010 " + std::to_string(amount),
+							   Account::MONEY_MARKET);
+	}
+
+	acct.RecordTransaction("D 10011 5", Account::PRIME_MONEY_MARKET);
+
+	assert(acct.HistorySize(Account::MONEY_MARKET) == 10);
+	assert(acct.LastSequence() == 11);
+
+	MemorySink memory;
+
+	acct.DisplayLatest(Account::MONEY_MARKET, 2, memory);
+
+	assert(memory.Str() == "Transaction history for Johnny Cash "
+						   "Money Market: $0, 2 of 10\n"
+						   "  [9] D 10010 9\n  [10] D 10010 10\n");
+
+	// Page running past the end is cut short
+	memory.Clear();
+
+	acct.DisplayPage(Account::MONEY_MARKET, 8, 5, memory);
+
+	assert(memory.Str().find(", 2 of 10\n  [9] D 10010 9\n") !=
+		   std::string::npos);
+
+	memory.Clear();
+
+	acct.DisplayRange(Account::MONEY_MARKET, 3, 4, memory);
+
+	assert(memory.Str().find(", 2 of 10\n  [3] D 10010 3\n"
+							 "  [4] D 10010 4\n") != std::string::npos);
+
+	// A range picks the same stretch of time in every fund
+	memory.Clear();
+
+	acct.DisplayRange(Account::NONE, 10, 11, memory);
+
+	assert(memory.Str().find("by fund.\nMoney Market: $0, 1 of 10\n"
+							 "  [10] D 10010 10\nPrime Money Market: $0, "
+							 "1 of 1\n  [11] D 10011 5\n") !=
+		   std::string::npos);
+
+	memory.Clear();
+
+	acct.DisplayRange(Account::MONEY_MARKET, 20, 30, memory);
+
+	assert(memory.Str().find(", 0 of 10\n") != std::string::npos);
+
+	Transaction transaction;
+
+	assert(TransactionParser::Parse("H 10010 P 40 20", transaction));
+	assert(transaction.page == Transaction::SLICE &&
+		   transaction.fund1 == 0 && transaction.amount == 40 &&
+		   transaction.id2 == 20 && !transaction.twoAccounts);
+
+	assert(TransactionParser::Parse("H 1001 L 5", transaction));
+	assert(transaction.page == Transaction::LATEST &&
+		   transaction.fund1 == Transaction::NONE && transaction.amount == 5);
+
+	assert(TransactionParser::Parse("H 1001", transaction));
+	assert(transaction.page == '\0');
+
+	const char* fileName = "tests_pages.txt";
+
+	{
+		std::ofstream inFile(fileName);
+
+		inFile << "O Cash Johnny 1001\n";
+
+		for (int amount(1); amount <= 30; ++amount) {
+
+			inFile << "D 1001" << amount % 3 << ' ' << amount << '\n';
+		}
+
+		inFile << "H 10011 L 2\nH 1001 S 28 29\nH 10012 P 1 1\n";
+	}
+
+	MemorySink out;
+
+	BankSimulation sim(out);
+
+	sim.Start(fileName, BankSimulation::MAPPED);
+
+	std::remove(fileName);
+
+	assert(out.Str().find("Prime Money Market: $145, 2 of 10\n"
+						  "  [25] D 10011 25\n  [28] D 10011 28\n") !=
+		   std::string::npos);
+	assert(out.Str().find("Prime Money Market: $145, 1 of 11\n"
+						  "  [28] D 10011 28\nLong-Term Bond: $155, 1 of 10\n"
+						  "  [29] D 10012 29\n") != std::string::npos);
+	assert(out.Str().find("Long-Term Bond: $155, 1 of 10\n"
+						  "  [5] D 10012 5\n") != std::string::npos);
+}
+
+// Test history moved to a HistorySegment displays the same as history
+// kept in memory, for an Account & for a run in every mode
+void TestHistorySpill() {
+
+	const char* segmentName = "tests_history.seg";
+	const char* fileName = "tests_history.txt";
+
+	HistorySegment segment(4);
+
+	assert(segment.Open(segmentName));
+
+	Account spilled("Johnny Cash", 1001, std::pmr::get_default_resource(),
+					&segment);
+
+	Account kept("Johnny Cash", 1001);
+
+	int rates[Account::MAX_FUNDS] = { 100 };
+
+	for (int amount(1); amount <= 50; ++amount) {
+
+		for (Account* acctPtr : { &spilled, &kept }) {
+
+			acctPtr->Deposit(Account::MONEY_MARKET, amount);
+			acctPtr->RecordTransaction("D 10010 " + std::to_string(amount),
+									   Account::MONEY_MARKET);
+			acctPtr->RecordFailedTransaction("W 10011 1",
+											 Account::PRIME_MONEY_MARKET);
+
+			if (amount % 5 == 0) {
+
+				acctPtr->Accrue(rates);
+			}
+		}
+	}
+
+	assert(segment.Size() > 0);
+	assert(spilled.HistorySize(Account::MONEY_MARKET) == 50 &&
+		   kept.HistorySize(Account::MONEY_MARKET) == 50);
+
+	MemorySink spilledOut, keptOut;
+
+	for (Account* acctPtr : { &spilled, &kept }) {
+
+		MemorySink& out(acctPtr == &spilled ? spilledOut : keptOut);
+
+		acctPtr->DisplayHistory(Account::MONEY_MARKET, out);
+		acctPtr->DisplayHistory(Account::NONE, out);
+		acctPtr->DisplayLatest(Account::NONE, 6, out);
+		acctPtr->DisplayPage(Account::MONEY_MARKET, 3, 20, out);
+		acctPtr->DisplayRange(Account::NONE, 7, 90, out);
+		acctPtr->DisplayRange(Account::MONEY_MARKET, 150, 151, out);
+	}
+
+	assert(spilledOut.Str() == keptOut.Str());
+	assert(keptOut.Str().find("  [7] D 10010 4\n") != std::string::npos);
+
+	segment.Close();
+
+	{
+		std::ofstream inFile(fileName);
+
+		inFile << "O Cash Johnny 1001\nO Cash June 1002\n";
+
+		for (int line(1); line <= 300; ++line) {
+
+			inFile << "D 1001" << (line % 3) << ' ' << line << '\n'
+				   << "T 1001" << (line % 3) << " 1 1002" << (line % 4)
+				   << '\n';
+
+			if (line % 50 == 0) {
+
+				inFile << "H 1001\nH 10020 P 10 30\nH 1002 R 100 400\n";
+			}
+		}
+	}
+
+	std::string expected;
+
+	for (int mode(BankSimulation::BUFFERED); mode <= BankSimulation::PARALLEL;
+		 ++mode) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.SetThreads(3);
+
+		if (mode != BankSimulation::BUFFERED) {
+
+			assert(sim.SetHistorySpill(segmentName, 8));
+		}
+
+		sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+		if (mode == BankSimulation::BUFFERED) {
+
+			expected = out.Str();
+		}
+
+		assert(out.Str() == expected);
+	}
+
+	// Only Accounts of the simulation with a segment spill to it, not those
+	// of another simulation nor an Account constructed alone
+	MemorySink spillOut, plainOut;
+
+	std::unique_ptr<BankSimulation> spilling(new BankSimulation(spillOut));
+
+	BankSimulation plain(plainOut);
+
+	assert(spilling->SetHistorySpill(segmentName, 8));
+
+	spilling->Start(fileName, BankSimulation::SHARDED);
+
+	std::streamoff spilledBytes(std::ifstream(segmentName,
+								std::ios::ate | std::ios::binary).tellg());
+
+	assert(spilledBytes > 0);
+
+	Account alone("Johnny Cash", 1001);
+
+	for (int amount(1); amount <= 50; ++amount) {
+
+		alone.RecordTransaction("D 10010 1", Account::MONEY_MARKET);
+	}
+
+	plain.Start(fileName, BankSimulation::SHARDED);
+
+	assert(std::ifstream(segmentName, std::ios::ate |
+						 std::ios::binary).tellg() == spilledBytes);
+
+	spilling.reset();
+
+	plain.Start(fileName, BankSimulation::BUFFERED);
+
+	assert(spillOut.Str() == expected);
+
+	std::remove(fileName);
+}
+
+// Test WriteAheadLog group commit & recovery of a log with a torn end
+void TestWriteAheadLog() {
+
+	const char* fileName = "tests_wal.log";
+	const char* lines[] = { "O Cash Johnny 1001", "D 10010 542",
+							"W 10011 7", "T 10017 54 10015" };
+
+	std::remove(fileName);
+
+	WriteAheadLog log;
+
+	assert(log.Open(fileName));
+
+	log.SetGroup(3, 60000);
+
+	Transaction transaction;
+
+	long long sequence(0);
+
+	for (const char* line : lines) {
+
+		assert(TransactionParser::Parse(line, transaction));
+
+		log.Append(sequence += 2, transaction);
+	}
+
+	// First three make a group, the last waits for Close
+	assert(log.Commits() == 1);
+
+	log.Close();
+
+	{
+		std::ofstream torn(fileName, std::ios::binary | std::ios::app);
+
+		torn << "partial entry";
+	}
+
+	assert(log.Open(fileName));
+
+	std::vector<std::string> recovered;
+
+	assert(log.Recover([&recovered](const Transaction& transaction) {
+
+		recovered.emplace_back();
+
+		Journal::Format(transaction, recovered.back());
+	}) == 8);
+
+	assert(recovered == std::vector<std::string>(lines, lines + 4));
+
+	// Torn end was cut off, new entries follow the last whole one
+	log.Append(9, transaction);
+	log.Close();
+
+	assert(log.Open(fileName));
+	assert(log.Recover([](const Transaction&) {}) == 9);
+
+	// A group left waiting is committed once due, with nothing appended
+	long long commits(log.Commits());
+
+	log.SetGroup(100, 5);
+	log.Append(10, transaction);
+
+	for (int tries(0); tries < 200 && log.Commits() == commits; ++tries) {
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	assert(log.Commits() == commits + 1);
+
+	log.Close();
+
+	std::remove(fileName);
+}
+
+// Test a run cut short & carried on from its log shows the same history
+// as a run never cut short, in every mode, with an 'H' of a fund logged
+// before the cut, as it is recorded in that fund's history
+void TestLogRecovery() {
+
+	const char* logName = "tests_recovery.log";
+	const char* shortName = "tests_recovery_short.txt";
+	const char* fileName = "tests_recovery.txt";
+
+	const char* lines = "O A B 1000\nD 10000 50\nH 10000\nD 10000 5\n";
+
+	{
+		std::ofstream shortFile(shortName), inFile(fileName);
+
+		shortFile << lines;
+		inFile << lines << "H 10000\n";
+	}
+
+	std::string expected;
+
+	{
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.Start(fileName, BankSimulation::BUFFERED);
+
+		expected = out.Str().substr(out.Str().rfind("Transaction history"));
+	}
+
+	assert(expected.find("  D 10000 50\n  H 10000\n  D 10000 5\n") !=
+														std::string::npos);
+
+	for (int mode(BankSimulation::BUFFERED); mode <= BankSimulation::PARALLEL;
+		 ++mode) {
+
+		std::remove(logName);
+
+		{
+			MemorySink out;
+
+			BankSimulation sim(out);
+
+			assert(sim.SetLog(logName));
+
+			sim.Start(shortName, static_cast<BankSimulation::MODE>(mode));
+		}
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		assert(sim.SetLog(logName));
+
+		sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+		assert(out.Str().substr(out.Str().rfind("Transaction history")) ==
+																	expected);
+	}
+
+	std::remove(logName);
+	std::remove(shortName);
+	std::remove(fileName);
+}
+
+// Test BankStats counts, percentiles & JSON report
+void TestBankStats() {
+
+	BankStats::Reset();
+
+	for (int count(0); count < 99; ++count) {
+
+		BankStats::RecordTransaction('D', 100);
+	}
+
+	BankStats::RecordTransaction('D', 5000);
+	BankStats::RecordTransaction('?', 5000);
+	BankStats::RecordFailure(BankStats::ID_IN_USE);
+
+	MemorySink report;
+
+	BankStats::Report(report);
+
+	std::string json(report.Str());
+
+	// 100 falls in bucket 64-127, 5000 in bucket 4096-8191, whose upper
+	// end is above the largest time, so p999 is that time
+	assert(json.find("\"id_in_use\":1,") != std::string::npos);
+	assert(json.find("\"D\":{\"count\":100,\"mean_ns\":149,\"p50_ns\":127,"
+					 "\"p99_ns\":127,\"p999_ns\":5000,\"max_ns\":5000}")
+														!= std::string::npos);
+
+	BankStats::Reset();
+}
+
+// Test ConcurrentTable with threads opening the same IDs at once & a
+// reader using Accounts while they are emptied
+void TestConcurrentTable() {
+
+	const int THREADS = 4, IDS = 1000;
+
+	ConcurrentTable table;
+
+	std::atomic<int> opened(0);
+
+	std::vector<std::thread> threads;
+
+	for (int thread(0); thread < THREADS; ++thread) {
+
+		threads.emplace_back([&table, &opened]() {
+
+			for (int id(Account::MIN_ID); id < Account::MIN_ID + IDS; ++id) {
+
+				Account* acctPtr = new Account("Racing Client", id);
+
+				if (table.Insert(acctPtr)) {
+
+					++opened;
+
+				} else {
+
+					delete acctPtr;
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+
+		thread.join();
+	}
+
+	// Exactly one thread opened each ID
+	assert(opened == IDS);
+
+	std::atomic<bool> done(false);
+
+	std::thread reader([&table, &done]() {
+
+		while (!done) {
+
+			ConcurrentTable::ReadGuard guard(table);
+
+			for (int id(Account::MIN_ID); id < Account::MIN_ID + IDS; ++id) {
+
+				Account* acctPtr;
+
+				if (table.Retrieve(id, acctPtr)) {
+
+					assert(acctPtr->GetID() == id);
+				}
+			}
+		}
+	});
+
+	for (int round(0); round < 20; ++round) {
+
+		table.Empty();
+
+		assert(table.isEmpty());
+
+		for (int id(Account::MIN_ID); id < Account::MIN_ID + IDS; ++id) {
+
+			assert(table.Insert(new Account("Returning Client", id)));
+		}
+	}
+
+	done = true;
+
+	reader.join();
+}
+
+// Test that Transfers between shared Accounts from 64 threads at once,
+// in both directions & covering from linked funds, neither lose nor make
+// money
+void TestAccountConservation() {
+
+	const int THREADS = 64, ACCOUNTS = 8, TRANSFERS = 2000, START = 1000;
+
+	std::vector<Account*> accounts;
+
+	for (int index(0); index < ACCOUNTS; ++index) {
+
+		accounts.push_back(new Account("Shared Client",
+									   Account::MIN_ID + index));
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			accounts.back()->Deposit(fund, START);
+		}
+	}
+
+	std::vector<std::thread> threads;
+
+	for (int thread(0); thread < THREADS; ++thread) {
+
+		threads.emplace_back([&accounts, thread]() {
+
+			std::mt19937 random(thread);
+
+			std::uniform_int_distribution<int> account(0, ACCOUNTS - 1),
+				fund(Account::MONEY_MARKET, Account::MAX_FUNDS - 1),
+				amount(1, 2 * START);
+
+			DiscardSink discard;
+
+			for (int transfer(0); transfer < TRANSFERS; ++transfer) {
+
+				Account* fromPtr = accounts[account(random)];
+				Account* toPtr = accounts[account(random)];
+
+				fromPtr->Transfer(toPtr, fund(random), fund(random),
+								  amount(random), discard);
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+
+		thread.join();
+	}
+
+	long long total(0);
+
+	for (Account* acctPtr : accounts) {
+
+		for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS;
+																	++fund) {
+
+			assert(acctPtr->GetBalance(fund) >= 0);
+
+			total += acctPtr->GetBalance(fund);
+		}
+
+		delete acctPtr;
+	}
+
+	assert(total == static_cast<long long>(ACCOUNTS) * Account::MAX_FUNDS *
+																	START);
+}
+
+// Test that ProcessBatch gives the same output as processing the same
+// transactions one at a time
+void TestProcessBatch() {
+
+	const char* lines[] = { "O Cash Johnny 1001", "O Jones Sam 1002",
+							"D 10010 500", "D 10020 300", "W 10010 100",
+							"D 10030 10", "W 10021 50", "H 1001",
+							"W 10020 900", "T 10010 50 10021", "D 10011 5",
+							"W 10011 40 1009", "H 10021", "O Cash Johnny 1001",
+							"D 10016 70", "H 1002", "H 1001" };
+
+	std::vector<Transaction> transactions;
+
+	for (const char* line : lines) {
+
+		transactions.push_back(Transaction());
+
+		assert(TransactionParser::Parse(line, transactions.back()));
+	}
+
+	MemorySink batchOut, serialOut;
+
+	BankSimulation batchSim(batchOut), serialSim(serialOut);
+
+	batchSim.ProcessBatch(transactions.data(), transactions.size());
+
+	for (const Transaction& transaction : transactions) {
+
+		serialSim.ProcessBatch(&transaction, 1);
+	}
+
+	assert(batchOut.Str() == serialOut.Str());
+	assert(batchOut.Str().find("ERROR: Account 1003 not found.") !=
+														std::string::npos);
+
+	// Johnny Cash holds 350 + 5 + 70, Sam Jones 250 + 50
+	const BalanceStore& balances(batchSim.Balances());
+
+	assert(balances.Size() == 2);
+	assert(balances.Total(Account::MONEY_MARKET) == 600);
+	assert(balances.Total(Account::PRIME_MONEY_MARKET) == 55);
+
+	// Transfers chained to both Accounts, often failing or between funds
+	// of one Account, among Deposits, Withdraws & histories
+	std::vector<std::string> mixed = { "O Cash Johnny 1001",
+									   "O Jones Sam 1002", "O Lee Ann 1003" };
+
+	std::mt19937 random(2019);
+
+	std::uniform_int_distribution<int> account(1001, 1004), fund(0, 3),
+									   amount(1, 300), type(0, 9);
+
+	for (int count(0); count < 3000; ++count) {
+
+		std::string id(std::to_string(account(random)) +
+					   std::to_string(fund(random)));
+
+		int kind(type(random));
+
+		mixed.push_back((kind < 5) ? "T " + id + ' ' +
+									 std::to_string(amount(random)) + ' ' +
+									 std::to_string(account(random)) +
+									 std::to_string(fund(random)) :
+						(kind < 7) ? "D " + id + ' ' +
+									 std::to_string(amount(random)) :
+						(kind < 9) ? "W " + id + ' ' +
+									 std::to_string(amount(random)) :
+									 "H " + id.substr(0, 4));
+	}
+
+	transactions.clear();
+
+	for (const std::string& line : mixed) {
+
+		transactions.push_back(Transaction());
+
+		assert(TransactionParser::Parse(line, transactions.back()));
+	}
+
+	MemorySink mixedBatchOut, mixedSerialOut;
+
+	BankSimulation mixedBatchSim(mixedBatchOut), mixedSerialSim(mixedSerialOut);
+
+	mixedBatchSim.ProcessBatch(transactions.data(), transactions.size());
+
+	for (const Transaction& transaction : transactions) {
+
+		mixedSerialSim.ProcessBatch(&transaction, 1);
+	}
+
+	assert(mixedBatchOut.Str() == mixedSerialOut.Str());
+}
+
+// Test BalanceStore mirroring Accounts, its reports against plain loops &
+// a snapshot kept while balances change
+void TestBalanceStore() {
+
+	BalanceStore store;
+
+	Account acct("Johnny Cash", 1001);
+
+	acct.Deposit(Account::MONEY_MARKET, 100);
+	store.Attach(&acct);
+	acct.Deposit(Account::PRIME_MONEY_MARKET, 300);
+
+	// Covered from Prime Money Market
+	assert(acct.Withdraw(Account::MONEY_MARKET, 250));
+	assert(store.Balance(0, Account::MONEY_MARKET) == 0);
+	assert(store.Balance(0, Account::PRIME_MONEY_MARKET) == 150);
+
+	std::mt19937 random(2019);
+
+	std::uniform_int_distribution<int> balance(-1000000, 1000000);
+
+	// Odd count over several pages, so vector loops leave a tail
+	const int SLOTS = 2051;
+
+	std::int64_t total(150), min(150), max(150);
+
+	long long below(0);
+
+	for (int count(0); count < SLOTS; ++count) {
+
+		int slot(store.Add());
+
+		store.BalanceChanged(slot, Account::PRIME_MONEY_MARKET,
+							 balance(random));
+
+		std::int64_t value(store.Balance(slot, Account::PRIME_MONEY_MARKET));
+
+		total += value;
+		below += (value < 100) ? 1 : 0;
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+
+	BalanceStore::Summary summary(store.Summarize(Account::PRIME_MONEY_MARKET));
+
+	assert(store.Total(Account::PRIME_MONEY_MARKET) == total);
+	assert(store.CountBelow(Account::PRIME_MONEY_MARKET, 100) == below);
+	assert(summary.min == min && summary.max == max);
+	assert(summary.mean == static_cast<double>(total) / (SLOTS + 1));
+	assert(store.Accounts() == 1 && store.Owner(0) == &acct);
+	assert(store.Owner(SLOTS) == nullptr);
+
+	std::vector<BalanceRanking::Entry> sorted, top, bottom;
+
+	long long holders(0);
+
+	for (int slot(0); slot <= SLOTS; ++slot) {
+
+		std::int64_t value(store.Balance(slot, Account::PRIME_MONEY_MARKET));
+
+		sorted.emplace_back(value, slot);
+		holders += (value > 0) ? 1 : 0;
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+
+	store.Top(Account::PRIME_MONEY_MARKET, 10, top);
+	store.Bottom(Account::PRIME_MONEY_MARKET, 10, bottom);
+
+	assert(store.Holders(Account::PRIME_MONEY_MARKET) == holders);
+	assert(std::equal(top.begin(), top.end(), sorted.rbegin()) &&
+		   top.size() == 10);
+	assert(std::equal(bottom.begin(), bottom.end(), sorted.begin()) &&
+		   bottom.size() == 10);
+
+	std::int64_t last(store.Balance(SLOTS, Account::PRIME_MONEY_MARKET));
+
+	std::shared_ptr<const BalanceSnapshot> snapshot(store.Snapshot(7));
+
+	acct.Deposit(Account::MONEY_MARKET, 42);
+	store.BalanceChanged(SLOTS, Account::PRIME_MONEY_MARKET, 5);
+
+	// Pages written after the snapshot were copied, it still reads the old
+	assert(store.Balance(0, Account::MONEY_MARKET) == 42);
+	assert(snapshot->Balance(0, Account::MONEY_MARKET) == 0);
+	assert(store.Balance(SLOTS, Account::PRIME_MONEY_MARKET) == 5);
+	assert(snapshot->Balance(SLOTS, Account::PRIME_MONEY_MARKET) == last);
+	assert(snapshot->Sequence() == 7 && snapshot->Size() == SLOTS + 1);
+
+	MemorySink accountOut, snapshotOut;
+
+	acct.DisplayBalances(accountOut);
+	store.Snapshot(8)->Display(snapshotOut);
+
+	// Slots not tied to an Account are left out
+	assert(snapshotOut.Str() == accountOut.Str());
+
+	acct.SetListener(nullptr, 0);
+}
+
+// Refills parameter ranking from parameter balances, in pages of 64 slots
+void RefillRanking(BalanceRanking& ranking,
+				   const std::vector<std::int64_t>& balances) {
+
+	ranking.Begin();
+
+	for (std::size_t first(0); first < balances.size(); first += 64) {
+
+		ranking.Gather(balances.data() + first,
+					   std::min<std::size_t>(64, balances.size() - first),
+					   static_cast<int>(first));
+	}
+
+	ranking.End();
+}
+
+// Returns true if parameter ranking lists the highest & lowest slots of
+// parameter balances the same as sorting them, false otherwise
+bool RankingMatches(const BalanceRanking& ranking,
+					const std::vector<std::int64_t>& balances) {
+
+	std::vector<BalanceRanking::Entry> sorted, top, bottom;
+
+	for (std::size_t slot(0); slot < balances.size(); ++slot) {
+
+		sorted.emplace_back(balances[slot], static_cast<int>(slot));
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+
+	std::size_t depth(std::min<std::size_t>(ranking.Depth(), sorted.size()));
+
+	ranking.Top(balances.size(), top);
+	ranking.Bottom(balances.size(), bottom);
+
+	return top.size() == depth && bottom.size() == depth &&
+		   std::equal(top.begin(), top.end(), sorted.rbegin()) &&
+		   std::equal(bottom.begin(), bottom.end(), sorted.begin()) &&
+		   ranking.Lowest() == sorted.front() &&
+		   ranking.Highest() == sorted.back();
+}
+
+// Test BalanceRanking against a sorted list of every slot as slots rise &
+// fall, refilling only when a change marks it stale & checking it whenever
+// it claims to be fresh, then refilled from rising & falling balances
+void TestBalanceRanking() {
+
+	const int SLOTS = 300, CHANGES = 20000;
+
+	BalanceRanking ranking(5);
+
+	std::vector<std::int64_t> balances(SLOTS, 0);
+
+	std::vector<BalanceRanking::Entry> entries;
+
+	assert(ranking.Stale());
+
+	RefillRanking(ranking, balances);
+
+	// Among equal balances the lower slot is lower
+	ranking.Top(3, entries);
+
+	assert(!ranking.Stale() && entries.size() == 3 &&
+		   entries[0] == BalanceRanking::Entry(0, 299) &&
+		   entries[2] == BalanceRanking::Entry(0, 297));
+
+	ranking.Bottom(SLOTS, entries);
+
+	assert(entries.size() == 5 && entries[0] == BalanceRanking::Entry(0, 0));
+
+	std::mt19937 random(2019);
+
+	std::uniform_int_distribution<int> slot(0, SLOTS - 1), balance(-50, 50);
+
+	int refills(0);
+
+	for (int count(0); count < CHANGES; ++count) {
+
+		int changed(slot(random));
+
+		std::int64_t before(balances[changed]);
+
+		balances[changed] = before + balance(random);
+
+		ranking.Change(before, balances[changed]);
+
+		if (ranking.Stale()) {
+
+			RefillRanking(ranking, balances);
+
+			++refills;
+		}
+
+		assert(RankingMatches(ranking, balances));
+	}
+
+	// Most changes stay between the floor & ceiling
+	assert(refills > 0 && refills < CHANGES / 4);
+
+	// A change heard while a refill runs leaves it stale
+	ranking.Begin();
+	ranking.Change(0, 0);
+	ranking.End();
+
+	assert(ranking.Stale());
+
+	// Rising & falling balances over many slots make every slot pass a cut
+	std::vector<std::int64_t> rising(10000), falling(10000);
+
+	for (std::size_t index(0); index < rising.size(); ++index) {
+
+		rising[index]  = static_cast<std::int64_t>(index);
+		falling[index] = -rising[index];
+	}
+
+	RefillRanking(ranking, rising);
+
+	assert(RankingMatches(ranking, rising));
+
+	RefillRanking(ranking, falling);
+
+	assert(RankingMatches(ranking, falling));
+
+	ranking.Clear();
+
+	assert(ranking.Stale() && ranking.Depth() == 5);
+}
+
+// Test a BalanceStore attached to Accounts changed on 8 threads at once,
+// each on Accounts of its own, while another thread reads reports, keeps
+// aggregates matching the Accounts' balances
+void TestBalanceStoreThreads() {
+
+	const int THREADS = 8, ACCOUNTS = 4, CHANGES = 5000;
+
+	BalanceStore store;
+
+	std::vector<std::unique_ptr<Account>> accounts;
+
+	for (int index(0); index < THREADS * ACCOUNTS; ++index) {
+
+		accounts.emplace_back(new Account("Shared Client",
+										  Account::MIN_ID + index));
+
+		store.Attach(accounts.back().get());
+	}
+
+	std::atomic<bool> done(false);
+
+	std::thread reader([&store, &done]() {
+
+		std::vector<BalanceRanking::Entry> top;
+
+		while (!done) {
+
+			store.Top(Account::MONEY_MARKET, 3, top);
+
+			BalanceStore::Summary summary(store.Summarize(
+												Account::SHORT_TERM_BOND));
+
+			assert(top.size() == 3 && top[0] > top[1] && top[1] > top[2]);
+			assert(summary.min <= summary.max &&
+				   store.Total(Account::SHORT_TERM_BOND) >= 0);
+		}
+	});
+
+	std::vector<std::thread> threads;
+
+	for (int thread(0); thread < THREADS; ++thread) {
+
+		threads.emplace_back([&accounts, thread]() {
+
+			std::mt19937 random(thread);
+
+			std::uniform_int_distribution<int> account(0, ACCOUNTS - 1),
+				fund(Account::MONEY_MARKET, Account::MAX_FUNDS - 1),
+				amount(1, 500);
+
+			DiscardSink discard;
+
+			for (int change(0); change < CHANGES; ++change) {
+
+				Account* acctPtr =
+							accounts[thread * ACCOUNTS + account(random)].get();
+
+				if (change % 3 == 0) {
+
+					acctPtr->Withdraw(fund(random), amount(random), discard);
+
+				} else {
+
+					acctPtr->Deposit(fund(random), amount(random), discard);
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads) {
+
+		thread.join();
+	}
+
+	done = true;
+
+	reader.join();
+
+	for (int fund(Account::MONEY_MARKET); fund < Account::MAX_FUNDS; ++fund) {
+
+		std::vector<std::int64_t> balances;
+
+		std::int64_t total(0);
+
+		for (const std::unique_ptr<Account>& acctPtr : accounts) {
+
+			balances.push_back(acctPtr->GetBalance(fund));
+
+			total += balances.back();
+		}
+
+		std::vector<BalanceRanking::Entry> bottom;
+
+		store.Bottom(fund, balances.size(), bottom);
+
+		assert(store.Total(fund) == total);
+		assert(bottom.size() == balances.size() &&
+			   bottom.front().first == *std::min_element(balances.begin(),
+														 balances.end()));
+
+		for (const BalanceRanking::Entry& entry : bottom) {
+
+			assert(entry.first == balances[entry.second]);
+		}
+	}
+
+	for (const std::unique_ptr<Account>& acctPtr : accounts) {
+
+		acctPtr->SetListener(nullptr, 0);
+	}
+}
+
+// Test snapshots taken on another thread during a run of transfers each
+// hold the bank's total, so none saw a transfer half done, & one taken
+// after the run reads the same as the final balances
+void TestSnapshot() {
+
+	const char* fileName = "tests_snapshot.txt";
+
+	const int ACCOUNTS = 50, TRANSFERS = 40000;
+
+	{
+		std::ofstream inFile(fileName);
+
+		for (int id(1000); id < 1000 + ACCOUNTS; ++id) {
+
+			inFile << "O Client Number" << id << ' ' << id << '\n'
+				   << "D " << id << "0 1000\n";
+		}
+
+		std::mt19937 random(2019);
+
+		std::uniform_int_distribution<int> account(1000, 999 + ACCOUNTS),
+										   fund(0, Account::MAX_FUNDS - 1),
+										   amount(1, 400);
+
+		for (int count(0); count < TRANSFERS; ++count) {
+
+			inFile << "T " << account(random) << fund(random) << ' '
+				   << amount(random) << ' ' << account(random)
+				   << fund(random) << '\n';
+		}
+	}
+
+	for (int mode : { BankSimulation::MAPPED, BankSimulation::BATCHED }) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		std::atomic<bool> done(false);
+
+		std::thread runner([&sim, &done, fileName, mode]() {
+
+			sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+			done = true;
+		});
+
+		long long last(0);
+
+		while (!done) {
+
+			std::shared_ptr<const BalanceSnapshot> snapshot(sim.Snapshot());
+
+			assert(snapshot->Sequence() >= last);
+
+			last = snapshot->Sequence();
+
+			if (last < 2 * ACCOUNTS) {
+
+				continue;
+			}
+
+			std::int64_t total(0);
+
+			for (int slot(0); slot < snapshot->Size(); ++slot) {
+
+				for (int fund(0); fund < Account::MAX_FUNDS; ++fund) {
+
+					total += snapshot->Balance(slot, fund);
+				}
+			}
+
+			assert(total == 1000 * ACCOUNTS);
+		}
+
+		runner.join();
+
+		MemorySink finalOut;
+
+		sim.Snapshot()->Display(finalOut);
+
+		assert(sim.Snapshot()->Sequence() == 2 * ACCOUNTS + TRANSFERS);
+		assert(out.Str().find("Final Balances\n" + finalOut.Str()) !=
+			   std::string::npos);
+	}
+
+	std::remove(fileName);
+}
+
+// Test accrual rounding, the vector pass against Account::Accrued & an
+// accrual run the same way in every mode
+void TestAccrual() {
+
+	// Rounded down, for fees too, & kept within range of an int
+	assert(Account::Accrued(10001, 25) == 10026);
+	assert(Account::Accrued(999, -25) == 996);
+	assert(Account::Accrued(10000, -10000) == 0);
+	assert(Account::Accrued(2147483000, 10000) == 2147483647);
+	assert(!Account::ValidRate(-10001));
+
+	BalanceStore store;
+
+	std::mt19937 random(2019);
+
+	std::uniform_int_distribution<int> balance(0, 2147483647),
+									   rate(-10000, 10000);
+
+	// Odd count over several pages, so vector loops leave a tail
+	const int SLOTS = 2051;
+
+	std::vector<int> before;
+
+	for (int count(0); count < SLOTS; ++count) {
+
+		int slot(store.Add());
+
+		before.push_back(balance(random));
+
+		store.BalanceChanged(slot, Account::LONG_TERM_BOND, before.back());
+	}
+
+	int rates[Account::MAX_FUNDS] = {};
+
+	for (int round(0); round < 20; ++round) {
+
+		rates[Account::LONG_TERM_BOND] = rate(random);
+
+		assert(store.Accrue(rates) == 0);
+
+		for (int slot(0); slot < SLOTS; ++slot) {
+
+			before[slot] = Account::Accrued(before[slot],
+											rates[Account::LONG_TERM_BOND]);
+
+			assert(store.Balance(slot, Account::LONG_TERM_BOND) ==
+																before[slot]);
+		}
+
+		// Aggregates were recounted after the pass over the array
+		BalanceStore::Summary summary(store.Summarize(Account::LONG_TERM_BOND));
+
+		assert(store.Total(Account::LONG_TERM_BOND) ==
+			   std::accumulate(before.begin(), before.end(), 0LL));
+		assert(summary.max == *std::max_element(before.begin(), before.end()));
+		assert(summary.min == *std::min_element(before.begin(), before.end()));
+	}
+
+	const char* fileName = "tests_accrual.txt";
+
+	{
+		std::ofstream inFile(fileName);
+
+		inFile << "O Cash Johnny 1001\nO Jones Sam 1002\nD 10010 10001\n"
+			   << "D 10021 999\nA 25 -25\nA 25 20000\nD 10010 1\n"
+			   << "W 10021 996\nA 0 -25\nH 1001\nH 1002\n";
+	}
+
+	std::string expected;
+
+	for (int mode(BankSimulation::BUFFERED); mode <= BankSimulation::PARALLEL;
+																	++mode) {
+
+		MemorySink out;
+
+		BankSimulation sim(out);
+
+		sim.SetThreads(2);
+		sim.Start(fileName, static_cast<BankSimulation::MODE>(mode));
+
+		expected = (mode == BankSimulation::BUFFERED) ? out.Str() : expected;
+
+		assert(out.Str() == expected);
+	}
+
+	std::remove(fileName);
+
+	// Johnny Cash's Money Market got 25 bps, Sam Jones' Prime Money Market
+	// paid a fee of 25 bps, then nothing as it was empty
+	assert(expected.find("ACCRUAL ERROR") != std::string::npos);
+	assert(expected.find("Money Market: $10027") != std::string::npos);
+	assert(expected.find("Prime Money Market: $0") != std::string::npos);
+	assert(expected.find("Accrued 25 in 1 funds") != std::string::npos);
+	assert(expected.find("Accrued -3 in 1 funds") != std::string::npos);
+}
+
+// Test an Account over a two fund catalog: its names, its smaller layout
+// & covering only between the funds its catalog links
+void TestFundCatalog() {
+
+	typedef BasicAccount<CashFunds> CashAccount;
+
+	assert(CashAccount::MAX_FUNDS == 2);
+	assert(CashAccount::FundName(CashAccount::SAVINGS) == "Savings");
+	assert(sizeof(CashAccount) < sizeof(Account));
+	assert(!CashAccount::ValidFund(2));
+
+	CashAccount acct("Johnny Cash", 1001);
+
+	MemorySink out;
+
+	acct.Deposit(CashAccount::SAVINGS, 300, out);
+	acct.Deposit(CashAccount::CHECKING, 100, out);
+
+	// Covered from Savings
+	assert(acct.Withdraw(CashAccount::CHECKING, 250, out));
+	assert(acct.GetBalance(CashAccount::CHECKING) == 0);
+	assert(acct.GetBalance(CashAccount::SAVINGS) == 150);
+	assert(!acct.Withdraw(CashAccount::SAVINGS, 200, out));
+
+	acct.DisplayBalances(out);
+
+	assert(out.Str() == "Johnny Cash Account ID: 1001\n"
+						"    Checking: $0\n    Savings: $150\n\n");
+
+	// Standard catalog still links only the money market & bond funds
+	Account standard("Sam Jones", 1002);
+
+	standard.Deposit(Account::VALUE_FUND, 500, out);
+
+	assert(!standard.Withdraw(Account::INDEX_FUND_500, 1, out));
+	assert(standard.Withdraw(Account::VALUE_FUND, 500, out));
+}
+
+// Test SpscRing keeping order with a producer far ahead of its consumer,
+// then PIPELINED & PARALLEL runs over several blocks & chunks against a
+// MAPPED run
+void TestPipeline() {
+
+	const int ITEMS = 100000;
+
+	SpscRing<int> ring(4);
+
+	std::thread producer([&ring]() {
+
+		for (int item(0); item < ITEMS; ++item) {
+
+			ring.Push(std::move(item));
+		}
+
+		ring.Close();
+	});
+
+	int item, expected(0);
+
+	while (ring.Pop(item)) {
+
+		assert(item == expected++);
+	}
+
+	producer.join();
+
+	assert(expected == ITEMS);
+	assert(ring.MeanOccupancy() <= 4);
+
+	const char* fileName = "tests_pipeline.txt";
+
+	{
+		std::ofstream inFile(fileName);
+
+		for (int id(1000); id < 1100; ++id) {
+
+			inFile << "O Client Number" << id << ' ' << id << '\n';
+		}
+
+		// Lines cross block & chunk boundaries & the last has no line break
+		for (int count(0); count < 60000; ++count) {
+
+			inFile << "D " << (1000 + count % 101) << count % 10 << ' '
+				   << count << '\n';
+		}
+
+		inFile << "W 10000 1";
+	}
+
+	MemorySink mappedOut, pipelinedOut, parallelOut;
+
+	BankSimulation mappedSim(mappedOut), pipelinedSim(pipelinedOut),
+				   parallelSim(parallelOut);
+
+	mappedSim.Start(fileName, BankSimulation::MAPPED);
+	pipelinedSim.Start(fileName, BankSimulation::PIPELINED);
+
+	// Four decoding threads finish chunks out of order
+	parallelSim.SetThreads(5);
+	parallelSim.Start(fileName, BankSimulation::PARALLEL);
+
+	assert(std::ifstream(fileName, std::ios::ate).tellg() >
+		   static_cast<std::streamoff>(3 * ParallelParser::CHUNK_SIZE));
+
+	std::remove(fileName);
+
+	assert(pipelinedOut.Str() == mappedOut.Str());
+	assert(parallelOut.Str() == mappedOut.Str());
+
+	const Pipeline::Counters& counters(pipelinedSim.PipelineCounters());
+
+	assert(counters.reader.blocks > 1);
+	assert(counters.parser.blocks == counters.reader.blocks);
+	assert(counters.executor.blocks == counters.reader.blocks);
+}
+
+// Run all tests for each class
+void RunAllTests() {
+
+	std::cout <<"-------------------Running Account Tests------------------\n";
+	RunAccountTests();
+	std::cout << std::endl << std::endl <<
+		"------------------Running BSTree Tests-------------------\n";
+	RunRegistryTests<BSTree>();
+	TestArena<BSTree>();
+	std::cout << std::endl << std::endl <<
+		"----------------Running AccountTable Tests----------------\n";
+	RunRegistryTests<AccountTable>();
+	TestAccountTableBounds();
+	TestArena<AccountTable>();
+	std::cout << std::endl << std::endl <<
+		"--------------Running ConcurrentTable Tests---------------\n";
+	RunRegistryTests<ConcurrentTable>();
+	TestConcurrentTable();
+	TestArena<ConcurrentTable>();
+	std::cout << std::endl << std::endl <<
+		"-----------------Running BPlusTree Tests------------------\n";
+	RunRegistryTests<BPlusTree>();
+	TestBPlusTree();
+	TestArena<BPlusTree>();
+	TestLongIds();
+	TestStreaming();
+	TestShardedTransfers();
+	TestAccountConservation();
+	TestProcessBatch();
+	TestBalanceStore();
+	TestBalanceRanking();
+	TestBalanceStoreThreads();
+	TestSnapshot();
+	TestAccrual();
+	TestFundCatalog();
+	TestPipeline();
+	TestDedup();
+	TestParse();
+	TestJournal();
+	TestOutputSinks();
+	TestHistoryPages();
+	TestHistorySpill();
+	TestWriteAheadLog();
+	TestLogRecovery();
+	TestBankStats();
 }
 
 // Tests classes
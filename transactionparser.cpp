@@ -0,0 +1,345 @@
+// transactionparser.cpp
+// Implementations for TransactionParser class
+// Author: Juan Arias
+//
+// The TransactionParser class decodes Transactions from a view of the text
+// of a whole transaction file, such as a MappedFile, one line at a time.
+// Blank lines are skipped.
+
+#include <cctype>
+#include <climits>
+#include "account.h"
+#include "transactionparser.h"
+
+// Constructs TransactionParser over parameter input
+TransactionParser::TransactionParser(std::string_view input) :input(input),
+																 pos(0) {}
+
+// Decodes next line of input into parameter transaction,
+// returns true if successful, false if input is exhausted
+bool TransactionParser::Next(Transaction& transaction) {
+
+	while (pos < input.size()) {
+
+		std::size_t end(input.find('\n', pos));
+
+		if (end == std::string_view::npos) {
+
+			end = input.size();
+		}
+
+		std::string_view line(input.substr(pos, end - pos));
+
+		pos = end + 1;
+
+		if (Parse(line, transaction)) {
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Decodes parameter line into parameter transaction,
+// returns true if successful, false if line is blank
+bool TransactionParser::Parse(std::string_view line, Transaction& transaction) {
+
+	Cursor cursor(line);
+
+	transaction = Transaction();
+
+	transaction.text    = line;
+	transaction.txid    = Transaction::NONE;
+	transaction.fund1   = Transaction::NONE;
+	transaction.amount  = Transaction::NONE;
+	transaction.id2     = Transaction::NONE;
+	transaction.fund2   = Transaction::NONE;
+
+	cursor.Read(transaction.type);
+
+	if (transaction.type == '#') {
+
+		cursor.Read(transaction.txid);
+
+		transaction.type = '\0';
+
+		cursor.Read(transaction.type);
+	}
+
+	if (transaction.type == '\0') {
+
+		return false;
+	}
+
+	if (transaction.type == Transaction::OPEN) {
+
+		cursor.Read(transaction.lastName);
+		cursor.Read(transaction.firstName);
+		cursor.Read(transaction.id1);
+
+		return true;
+	}
+
+	if (transaction.type == Transaction::ACCRUAL) {
+
+		transaction.id1    = Transaction::NONE;
+		transaction.amount = 0;
+
+		while (transaction.amount < Transaction::MAX_RATES && !cursor.eof()) {
+
+			cursor.Read(transaction.rates[transaction.amount++]);
+		}
+
+		return true;
+	}
+
+	cursor.Read(transaction.id1);
+
+	if (cursor.Skip(Transaction::SEPARATOR)) {
+
+		cursor.ReadDigit(transaction.fund1);
+
+	} else if (transaction.id1 >= Account::MIN_ID * Account::MAX_FUNDS) {
+
+		fillIdFund(transaction.id1, transaction.fund1);
+	}
+
+	if (transaction.type == Transaction::HISTORY && readPage(cursor,
+															 transaction)) {
+
+		return true;
+	}
+
+	if (!cursor.eof()) {
+
+		cursor.Read(transaction.amount);
+
+		if (!cursor.eof()) {
+
+			cursor.Read(transaction.id2);
+
+			if (cursor.Skip(Transaction::SEPARATOR)) {
+
+				cursor.ReadDigit(transaction.fund2);
+
+			} else {
+
+				fillIdFund(transaction.id2, transaction.fund2);
+			}
+
+			transaction.twoAccounts = true;
+		}
+	}
+
+	return true;
+}
+
+// Reads page of parameter transaction from parameter cursor, returns true
+// if the line names a page, false otherwise
+// Parameter cursor is a copy, so a line with no page can be read again
+// A missing number reads as NONE, so the page shows nothing
+// Numbers of a page are read as ints, as they are stored in a journal
+bool TransactionParser::readPage(Cursor cursor, Transaction& transaction) {
+
+	char page('\0');
+
+	cursor.Read(page);
+
+	if (page != Transaction::LATEST && page != Transaction::SLICE &&
+		page != Transaction::RANGE) {
+
+		return false;
+	}
+
+	transaction.page = page;
+
+	cursor.Read(transaction.amount);
+
+	if (page != Transaction::LATEST) {
+
+		int second(Transaction::NONE);
+
+		cursor.Read(second);
+
+		transaction.id2 = second;
+	}
+
+	return true;
+}
+
+// Splits parameter id into ID number & fund
+void TransactionParser::fillIdFund(long long& id, int& fund) {
+
+	fund = static_cast<int>(id % Account::MAX_FUNDS);
+	id   = id / Account::MAX_FUNDS;
+}
+
+// Constructs Cursor at start of parameter line
+TransactionParser::Cursor::Cursor(std::string_view line) :line(line), pos(0),
+											  failed(false), atEnd(false) {}
+
+// Reads one character into parameter c
+void TransactionParser::Cursor::Read(char& c) {
+
+	if (sentry()) {
+
+		c = line[pos++];
+	}
+}
+
+// Reads one whitespace delimited word into parameter word
+void TransactionParser::Cursor::Read(std::string_view& word) {
+
+	if (!sentry()) {
+
+		return;
+	}
+
+	std::size_t start(pos);
+
+	while (pos < line.size() && !std::isspace(static_cast<unsigned char>(
+																line[pos]))) {
+		++pos;
+	}
+
+	atEnd = (pos == line.size());
+
+	word = line.substr(start, pos - start);
+}
+
+// Reads one integer into parameter value
+// Like stream extraction, a value that is not a number reads as 0 and
+// a value out of range reads as the closest limit, both failing the Cursor
+void TransactionParser::Cursor::Read(int& value) {
+
+	long long wide(value);
+
+	readInteger(wide, INT_MIN, INT_MAX);
+
+	value = static_cast<int>(wide);
+}
+
+// Reads one long integer into parameter value
+// Fails the same way as reading an int
+void TransactionParser::Cursor::Read(long long& value) {
+
+	readInteger(value, LLONG_MIN, LLONG_MAX);
+}
+
+// Skips parameter expected if it is the next character, with no
+// whitespace before it, returns true if it was skipped
+bool TransactionParser::Cursor::Skip(char expected) {
+
+	if (failed || pos == line.size() || line[pos] != expected) {
+
+		return false;
+	}
+
+	atEnd = (++pos == line.size());
+
+	return true;
+}
+
+// Reads one digit into parameter digit if it is the next character,
+// with no whitespace before it, otherwise sets parameter digit to NONE
+void TransactionParser::Cursor::ReadDigit(int& digit) {
+
+	if (failed || pos == line.size() || line[pos] < '0' || '9' < line[pos]) {
+
+		digit = Transaction::NONE;
+
+		return;
+	}
+
+	digit = line[pos] - '0';
+
+	atEnd = (++pos == line.size());
+}
+
+// Returns true if reading reached end of line
+bool TransactionParser::Cursor::eof() const {
+
+	return atEnd;
+}
+
+// Skips whitespace, returns false if read can not proceed
+bool TransactionParser::Cursor::sentry() {
+
+	if (failed) {
+
+		return false;
+	}
+
+	while (pos < line.size() && std::isspace(static_cast<unsigned char>(
+																line[pos]))) {
+		++pos;
+	}
+
+	if (pos == line.size()) {
+
+		atEnd  = true;
+		failed = true;
+
+		return false;
+	}
+
+	return true;
+}
+
+// Reads one integer between parameters min & max into parameter value
+// Leaves parameter value untouched if the Cursor has failed
+void TransactionParser::Cursor::readInteger(long long& value, long long min,
+											long long max) {
+
+	if (!sentry()) {
+
+		return;
+	}
+
+	bool negative(line[pos] == '-');
+
+	if (negative || line[pos] == '+') {
+
+		++pos;
+	}
+
+	unsigned long long limit(negative ?
+						0ULL - static_cast<unsigned long long>(min) : max),
+					   result(0);
+
+	bool digits(false), overflow(false);
+
+	while (pos < line.size() && '0' <= line[pos] && line[pos] <= '9') {
+
+		unsigned long long digit(line[pos] - '0');
+
+		if (!overflow) {
+
+			overflow = result > (limit - digit) / 10;
+			result   = result * 10 + digit;
+		}
+
+		++pos;
+
+		digits = true;
+	}
+
+	atEnd = (pos == line.size());
+
+	if (!digits) {
+
+		value  = 0;
+		failed = true;
+
+	} else if (overflow) {
+
+		value  = negative ? min : max;
+		failed = true;
+
+	} else {
+
+		value = negative ? static_cast<long long>(0ULL - result)
+						 : static_cast<long long>(result);
+	}
+}
@@ -0,0 +1,199 @@
+// transactionparser.h
+// Specifications for Transaction struct & TransactionParser class
+// Author: Juan Arias
+//
+// A Transaction is one decoded line of a transaction file. It holds plain
+// values and views into the parsed text, so decoding never copies or
+// allocates. Its fields hold exactly what BankSimulation used to extract
+// with std::stringstream, including for malformed lines:
+//	 O <last name> <first name> <id>
+//	 D <account> <amount>
+//	 W <account> <amount>
+//	 T <account> <amount> <account>
+//	 H <account>
+//	 H <account> L <count>
+//	 H <account> P <offset> <limit>
+//	 H <account> S <first> <last>
+//	 A <rate> ... <rate>
+// An 'A' line accrues interest, or charges fees, on every fund of every
+// Account, with one rate in basis points per fund, in fund order. Funds
+// with no rate given get 0.
+//
+// An 'H' line with a page shows only part of the history: the latest count
+// transactions (L), limit transactions after skipping offset (P), or those
+// with sequence numbers first through last (S), see account.h.
+//
+// ID numbers are 64 bit. An <account> is written <id>:<fund> or <id>:
+// for no fund, or as the original <id><fund>. In the original form the
+// last digit of five digits or more is always the fund, so an Account
+// with an ID of five digits or more can only be named with no fund, such
+// as by an 'H' line for its whole history, as <id>:. The second Account
+// of a line always has a fund in the original form.
+//
+// Any line may start with "#<transaction id> ", an ID given by the feed the
+// line came from, so a line sent twice can be recognized (see dedupindex.h).
+//
+// The TransactionParser class decodes Transactions from a view of the text
+// of a whole transaction file, such as a MappedFile, one line at a time.
+// Blank lines are skipped.
+
+#ifndef TRANSACTIONPARSER_H
+#define TRANSACTIONPARSER_H
+
+#include <string_view>
+
+struct Transaction {
+
+	// Constant for no number
+	static const int NONE = -1;
+
+	// Most rates an ACCRUAL can give, one per fund
+	static const int MAX_RATES = 10;
+
+	// Constants for transaction types
+	enum TRANSACTIONTYPE {
+
+		OPEN      = 'O',
+		HISTORY   = 'H',
+		DEPOSIT   = 'D',
+		WITHDRAW  = 'W',
+		TRANSFER  = 'T',
+		ACCRUAL   = 'A'
+	};
+
+	// Constant between ID number & fund of an Account
+	static const char SEPARATOR = ':';
+
+	// Constants for pages of history
+	enum HISTORYPAGE {
+
+		LATEST    = 'L',
+		SLICE     = 'P',
+		RANGE     = 'S'
+	};
+
+	// Type of transaction, first character of line after any ID
+	char type;
+
+	// ID of transaction given by its feed, NONE if not given
+	long long txid;
+
+	// ID number & fund of first Account, fund is NONE if not given
+	long long id1;
+	int fund1;
+
+	// Amount of transaction, NONE if not given,
+	// or number of rates given for ACCRUAL transactions,
+	// or first number of page for HISTORY transactions
+	int amount;
+
+	// ID number & fund of second Account, only read if twoAccounts,
+	// or second number of page for HISTORY transactions
+	long long id2;
+	int fund2;
+
+	// True if line named a second Account
+	bool twoAccounts;
+
+	// Page of history for HISTORY transactions, '\0' for whole history
+	char page;
+
+	// Rates of each fund in basis points for ACCRUAL transactions
+	int rates[MAX_RATES];
+
+	// Names of client for OPEN transactions
+	std::string_view lastName;
+	std::string_view firstName;
+
+	// Whole line of transaction
+	std::string_view text;
+
+};
+
+class TransactionParser {
+
+public:
+
+	// Constructs TransactionParser over parameter input
+	explicit TransactionParser(std::string_view input);
+
+	// Decodes next line of input into parameter transaction,
+	// returns true if successful, false if input is exhausted
+	bool Next(Transaction& transaction);
+
+	// Decodes parameter line into parameter transaction,
+	// returns true if successful, false if line is blank
+	static bool Parse(std::string_view line, Transaction& transaction);
+
+private:
+
+	// Reads fields from a line the way std::stringstream extraction would,
+	// so malformed lines decode to the same values
+	class Cursor {
+
+	public:
+
+		// Constructs Cursor at start of parameter line
+		explicit Cursor(std::string_view line);
+
+		// Reads one character into parameter c
+		void Read(char& c);
+
+		// Reads one whitespace delimited word into parameter word
+		void Read(std::string_view& word);
+
+		// Reads one integer into parameter value
+		void Read(int& value);
+
+		// Reads one long integer into parameter value
+		void Read(long long& value);
+
+		// Skips parameter expected if it is the next character, with no
+		// whitespace before it, returns true if it was skipped
+		bool Skip(char expected);
+
+		// Reads one digit into parameter digit if it is the next character,
+		// with no whitespace before it, otherwise sets parameter digit to NONE
+		void ReadDigit(int& digit);
+
+		// Returns true if reading reached end of line
+		bool eof() const;
+
+	private:
+
+		// Line being read
+		std::string_view line;
+
+		// Position of next character to read
+		std::size_t pos;
+
+		// True if a read failed, later reads are ignored
+		bool failed;
+
+		// True if reading reached end of line
+		bool atEnd;
+
+		// Skips whitespace, returns false if read can not proceed
+		bool sentry();
+
+		// Reads one integer between parameters min & max into
+		// parameter value
+		void readInteger(long long& value, long long min, long long max);
+
+	};
+
+	// Input being decoded
+	std::string_view input;
+
+	// Position of next line to decode
+	std::size_t pos;
+
+	// Reads page of parameter transaction from parameter cursor, returns
+	// true if the line names a page, false otherwise
+	static bool readPage(Cursor cursor, Transaction& transaction);
+
+	// Splits parameter id into ID number & fund
+	static void fillIdFund(long long& id, int& fund);
+
+};
+#endif
@@ -0,0 +1,371 @@
+// writeaheadlog.cpp
+// Implementations for WriteAheadLog class
+// Author: Juan Arias
+//
+// The WriteAheadLog class keeps the transactions that changed Accounts in
+// an append-only file, so Accounts can be rebuilt after a crash without
+// reading the input again. It can:
+//	-open or create a log file
+//	-recover the transactions already in the log
+//	-append transactions, syncing them to disk in groups, on time even when
+//	 no more are appended
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "journal.h"
+#include "mappedfile.h"
+#include "writeaheadlog.h"
+
+// Magic bytes at start of header
+const char WriteAheadLog::MAGIC[8] = { 'B', 'A', 'N', 'K', 'W', 'A', 'L', '\0' };
+
+// Default group, defined here as they are bound to references
+const int WriteAheadLog::GROUP_SIZE;
+const int WriteAheadLog::GROUP_MILLISECONDS;
+
+// Constructs WriteAheadLog with no file open
+WriteAheadLog::WriteAheadLog() :fd(-1), waitingCount(0),
+								groupSize(GROUP_SIZE),
+								groupWait(GROUP_MILLISECONDS), commits(0),
+								stopping(false) {}
+
+// Destroys WriteAheadLog, committing waiting transactions
+WriteAheadLog::~WriteAheadLog() {
+
+	Close();
+}
+
+// Opens log file with parameter fileName, creating it if needed,
+// returns true if successful, false otherwise
+// A file that is not a log is left untouched
+bool WriteAheadLog::Open(const std::string& fileName) {
+
+	Close();
+
+	fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+
+	if (fd < 0) {
+
+		return false;
+	}
+
+	this->fileName = fileName;
+
+	struct stat info;
+
+	bool opened(fstat(fd, &info) == 0);
+
+	if (opened && info.st_size == 0) {
+
+		char header[HEADER_SIZE] = {};
+
+		std::memcpy(header, MAGIC, sizeof(MAGIC));
+		std::memcpy(header + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+
+		opened = writeAll(std::string_view(header, HEADER_SIZE)) &&
+				 fdatasync(fd) == 0;
+
+	} else if (opened) {
+
+		char header[HEADER_SIZE];
+
+		std::uint32_t version(0);
+
+		opened = pread(fd, header, HEADER_SIZE, 0) ==
+										static_cast<ssize_t>(HEADER_SIZE) &&
+				 std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0;
+
+		if (opened) {
+
+			std::memcpy(&version, header + sizeof(MAGIC), sizeof(version));
+		}
+
+		opened = opened && version == VERSION;
+	}
+
+	if (!opened) {
+
+		close(fd);
+
+		fd = -1;
+
+		return false;
+	}
+
+	stopping  = false;
+	committer = std::thread(&WriteAheadLog::commitDue, this);
+
+	return true;
+}
+
+// Returns true if a log file is open, false otherwise
+bool WriteAheadLog::IsOpen() const {
+
+	return fd >= 0;
+}
+
+// Sets number of transactions committed together to parameter size &
+// longest wait before a commit to parameter milliseconds
+void WriteAheadLog::SetGroup(int size, int milliseconds) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	groupSize = (size > 0) ? size : 1;
+	groupWait = std::chrono::milliseconds((milliseconds > 0) ? milliseconds
+																	: 0);
+}
+
+// Passes each transaction in log to parameter apply in order, cutting
+// off any damaged end of log, returns sequence number of last one,
+// 0 if log is empty
+long long WriteAheadLog::Recover(
+		const std::function<void(const Transaction&)>& apply) {
+
+	if (!IsOpen()) {
+
+		return 0;
+	}
+
+	Commit();
+
+	MappedFile logFile;
+
+	logFile.Open(fileName);
+
+	std::string_view data(logFile.Data());
+
+	std::size_t pos(HEADER_SIZE);
+
+	long long last(0);
+
+	Transaction transaction;
+
+	while (pos + FRAME_SIZE <= data.size()) {
+
+		Frame frame;
+
+		std::memcpy(&frame, data.data() + pos, FRAME_SIZE);
+
+		if (frame.length > data.size() - pos - FRAME_SIZE) {
+
+			break;
+		}
+
+		std::string_view record(data.substr(pos + FRAME_SIZE, frame.length));
+
+		JournalReader reader(record, 0);
+
+		if (frame.checksum != checksum(frame.sequence, record) ||
+			!reader.Next(transaction)) {
+
+			break;
+		}
+
+		apply(transaction);
+
+		last = frame.sequence;
+		pos += FRAME_SIZE + frame.length;
+	}
+
+	if (pos < data.size()) {
+
+		ftruncate(fd, pos);
+		fdatasync(fd);
+	}
+
+	logFile.Close();
+
+	return last;
+}
+
+// Appends parameter transaction with sequence number parameter sequence,
+// committing it with any waiting ones if group is full or has waited
+// too long
+void WriteAheadLog::Append(long long sequence,
+						   const Transaction& transaction) {
+
+	if (!IsOpen()) {
+
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	std::size_t start(waiting.size());
+
+	waiting.append(FRAME_SIZE, '\0');
+
+	Journal::Encode(transaction, waiting);
+
+	Frame frame;
+
+	frame.sequence = sequence;
+	frame.length   = static_cast<std::uint32_t>(waiting.size() - start -
+																FRAME_SIZE);
+	frame.checksum = checksum(sequence, std::string_view(waiting).substr(
+														start + FRAME_SIZE));
+
+	std::memcpy(&waiting[start], &frame, FRAME_SIZE);
+
+	std::chrono::steady_clock::time_point now(
+										std::chrono::steady_clock::now());
+
+	if (waitingCount++ == 0) {
+
+		waitingSince = now;
+
+		wake.notify_one();
+	}
+
+	if (waitingCount >= groupSize || now - waitingSince >= groupWait) {
+
+		commit();
+	}
+}
+
+// Writes & syncs to disk all waiting transactions,
+// returns true if successful, false otherwise
+bool WriteAheadLog::Commit() {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return commit();
+}
+
+// Returns number of commits that synced the log file
+long long WriteAheadLog::Commits() const {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	return commits;
+}
+
+// Commits waiting transactions & closes log file
+// Committer is stopped first, so nothing else touches the file
+void WriteAheadLog::Close() {
+
+	if (committer.joinable()) {
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			stopping = true;
+		}
+
+		wake.notify_one();
+
+		committer.join();
+	}
+
+	if (IsOpen()) {
+
+		Commit();
+
+		close(fd);
+	}
+
+	fd = -1;
+}
+
+// Commit without locking, for callers already holding lock
+// Waiting transactions are dropped even if the commit fails, writing them
+// again could repeat part of a group
+bool WriteAheadLog::commit() {
+
+	if (!IsOpen() || waitingCount == 0) {
+
+		return true;
+	}
+
+	bool committed(writeAll(waiting) && fdatasync(fd) == 0);
+
+	commits += committed ? 1 : 0;
+
+	waiting.clear();
+
+	waitingCount = 0;
+
+	return committed;
+}
+
+// Commits waiting transactions once the oldest is due, run by committer
+// until it must stop
+// Sleeps while nothing waits, then until the oldest entry is due. A group
+// committed by Append meanwhile leaves nothing waiting or a newer oldest.
+void WriteAheadLog::commitDue() {
+
+	std::unique_lock<std::mutex> guard(lock);
+
+	while (!stopping) {
+
+		if (waitingCount == 0) {
+
+			wake.wait(guard);
+
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point due(waitingSince + groupWait);
+
+		if (std::chrono::steady_clock::now() < due) {
+
+			wake.wait_until(guard, due);
+
+			continue;
+		}
+
+		commit();
+	}
+}
+
+// Static function
+// Returns checksum of parameter sequence & parameter record
+// Uses 32 bit FNV-1a, enough to catch an entry torn by a crash
+std::uint32_t WriteAheadLog::checksum(std::int64_t sequence,
+									  std::string_view record) {
+
+	std::uint32_t hash(2166136261u);
+
+	char bytes[sizeof(sequence)];
+
+	std::memcpy(bytes, &sequence, sizeof(sequence));
+
+	for (char byte : std::string_view(bytes, sizeof(bytes))) {
+
+		hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+	}
+
+	for (char byte : record) {
+
+		hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+	}
+
+	return hash;
+}
+
+// Writes all of parameter bytes to log file,
+// returns true if successful, false otherwise
+bool WriteAheadLog::writeAll(std::string_view bytes) {
+
+	while (!bytes.empty()) {
+
+		ssize_t written(write(fd, bytes.data(), bytes.size()));
+
+		if (written < 0 && errno == EINTR) {
+
+			continue;
+		}
+
+		if (written <= 0) {
+
+			return false;
+		}
+
+		bytes.remove_prefix(written);
+	}
+
+	return true;
+}
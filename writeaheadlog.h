@@ -0,0 +1,169 @@
+// writeaheadlog.h
+// Specifications for WriteAheadLog class
+// Author: Juan Arias
+//
+// The WriteAheadLog class keeps the transactions that changed Accounts in
+// an append-only file, so Accounts can be rebuilt after a crash without
+// reading the input again. It can:
+//	-open or create a log file
+//	-recover the transactions already in the log
+//	-append transactions, syncing them to disk in groups
+//
+// Syncing a file to disk takes far longer than running a transaction, so
+// appended transactions are kept in memory and written & synced together
+// once GROUP_SIZE of them are waiting or the oldest has waited longer than
+// GROUP_MILLISECONDS (group commit). A thread of the log's own, started
+// when it is opened, sleeps until the oldest waiting transaction is due, so
+// the wait is bounded even when no more transactions are appended. A
+// transaction is durable only after the commit holding it, a crash loses at
+// most the last group.
+//
+// A log starts with a 16 byte header:
+//	 bytes 0-7:   magic "BANKWAL" followed by a zero byte
+//	 bytes 8-11:  format version
+//	 bytes 12-15: reserved, zero
+// followed by one entry per transaction, each a 16 byte frame:
+//	 bytes 0-7:   sequence number of transaction in its input
+//	 bytes 8-11:  length of record in bytes
+//	 bytes 12-15: checksum of sequence number & record
+// then the transaction as a journal record (see journal.h). An entry that
+// is cut short or fails its checksum ends the log, it is cut off when the
+// log is recovered.
+
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "transactionparser.h"
+
+class WriteAheadLog {
+
+public:
+
+	// Size of header & of each entry frame in bytes
+	static const std::size_t HEADER_SIZE = 16;
+	static const std::size_t FRAME_SIZE = 16;
+
+	// Version of log format
+	static const std::uint32_t VERSION = 1;
+
+	// Default number of transactions committed together
+	static const int GROUP_SIZE = 256;
+
+	// Default longest wait in milliseconds before a transaction is committed
+	static const int GROUP_MILLISECONDS = 10;
+
+	// Constructs WriteAheadLog with no file open
+	WriteAheadLog();
+
+	// Destroys WriteAheadLog, committing waiting transactions
+	virtual ~WriteAheadLog();
+
+	// Opens log file with parameter fileName, creating it if needed,
+	// returns true if successful, false otherwise
+	bool Open(const std::string& fileName);
+
+	// Returns true if a log file is open, false otherwise
+	bool IsOpen() const;
+
+	// Sets number of transactions committed together to parameter size &
+	// longest wait before a commit to parameter milliseconds
+	void SetGroup(int size, int milliseconds);
+
+	// Passes each transaction in log to parameter apply in order, cutting
+	// off any damaged end of log, returns sequence number of last one,
+	// 0 if log is empty
+	long long Recover(const std::function<void(const Transaction&)>& apply);
+
+	// Appends parameter transaction with sequence number parameter sequence,
+	// committing it with any waiting ones if group is full or has waited
+	// too long
+	void Append(long long sequence, const Transaction& transaction);
+
+	// Writes & syncs to disk all waiting transactions,
+	// returns true if successful, false otherwise
+	bool Commit();
+
+	// Returns number of commits that synced the log file
+	long long Commits() const;
+
+	// Commits waiting transactions & closes log file
+	void Close();
+
+private:
+
+	// Magic bytes at start of header
+	static const char MAGIC[8];
+
+	// Frame before each record
+	struct Frame {
+
+		std::int64_t  sequence;
+		std::uint32_t length;
+		std::uint32_t checksum;
+
+	};
+
+	// Descriptor of log file, negative if none is open
+	int fd;
+
+	// Name of log file
+	std::string fileName;
+
+	// Entries appended but not yet committed
+	std::string waiting;
+
+	// Number of entries in waiting
+	int waitingCount;
+
+	// Time first entry in waiting was appended
+	std::chrono::steady_clock::time_point waitingSince;
+
+	// Number of transactions committed together
+	int groupSize;
+
+	// Longest wait before a commit
+	std::chrono::milliseconds groupWait;
+
+	// Number of commits that synced the log file
+	long long commits;
+
+	// Thread committing waiting transactions once they are due & whether
+	// it was asked to stop
+	std::thread committer;
+	bool stopping;
+
+	// Guards waiting entries, group & commits
+	mutable std::mutex lock;
+
+	// Signaled when a first entry starts waiting & when committer must stop
+	std::condition_variable wake;
+
+	// Commit without locking, for callers already holding lock
+	bool commit();
+
+	// Commits waiting transactions once the oldest is due, run by committer
+	// until it must stop
+	void commitDue();
+
+	// Returns checksum of parameter sequence & parameter record
+	static std::uint32_t checksum(std::int64_t sequence,
+								  std::string_view record);
+
+	// Writes all of parameter bytes to log file,
+	// returns true if successful, false otherwise
+	bool writeAll(std::string_view bytes);
+
+	// Disallow copying, a log file has a single writer
+	WriteAheadLog(const WriteAheadLog&) = delete;
+	WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+};
+#endif